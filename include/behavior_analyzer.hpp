@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include "driver_behavior.hpp"
+#include "landmark_features.hpp"
+
+// 行为判定阈值
+struct DetectionThresholds {
+    double ear_threshold = 0.25;     // 眼睛纵横比阈值
+    double mar_threshold = 0.6;      // 嘴部纵横比阈值
+    int eye_closed_frames = 3;       // 连续闭眼帧数阈值
+    int yawning_frames = 5;          // 连续哈欠帧数阈值
+    int drinking_frames = 3;         // 喝水计数阈值
+    int phone_calling_frames = 5;    // 打电话计数阈值
+};
+
+// 单帧的行为特征（最近一次analyze计算的值）
+struct FrameFeatures {
+    double ear = 0.0;          // 左右眼平均眼睛纵横比
+    double mar = 0.0;          // 嘴部纵横比
+    double head_roll = 0.0;    // 头部侧倾角（两外眼角连线与水平线的夹角，度，带符号）
+    double face_size = 0.0;    // 人脸尺寸（两外眼角距离，像素）
+};
+
+// 单路视频流的行为分析器
+// 连续帧计数器和随机数发生器都是每路独立的状态，多路视频流之间互不干扰；
+// 同一个分析器只能被一个线程按帧顺序调用
+class BehaviorAnalyzer {
+public:
+    explicit BehaviorAnalyzer(uint32_t seed = 0, const DetectionThresholds& thresholds = DetectionThresholds());
+    ~BehaviorAnalyzer() = default;
+
+    // 设置判定阈值
+    void setThresholds(const DetectionThresholds& thresholds);
+
+    // 获取判定阈值
+    const DetectionThresholds& getThresholds() const;
+
+    // 根据本帧特征点更新计数器并判定行为
+    DriverBehavior analyze(const cv::Mat& frame, const dlib::full_object_detection& shape);
+
+    // 清空计数器
+    void reset();
+
+    // 最近一次analyze计算的特征
+    const FrameFeatures& getLastFeatures() const;
+
+    // 计算眼睛纵横比 (Eye Aspect Ratio)
+    // 逐点计算的参考实现，analyze使用LandmarkFeatureKernel一次算出全部特征
+    static double calculateEAR(const std::vector<dlib::point>& eye);
+
+    // 计算嘴部纵横比 (Mouth Aspect Ratio)
+    static double calculateMAR(const dlib::full_object_detection& shape);
+
+private:
+    // 检测眼睛状态 (闭眼/睁眼)
+    bool detectEyesClosed(const LandmarkFeatures& features);
+
+    // 检测哈欠
+    bool detectYawning(const LandmarkFeatures& features);
+
+    // 检测喝水
+    bool detectDrinking(const cv::Mat& frame);
+
+    // 检测打电话
+    bool detectPhoneCalling(const cv::Mat& frame, const LandmarkFeatures& features);
+
+    // 生成 [0, 100) 的随机整数
+    int randomPercent();
+
+private:
+    DetectionThresholds _thresholds;
+
+    // 每路独立的随机数发生器，替代全局rand()
+    std::mt19937 _rng;
+    std::uniform_int_distribution<int> _percent;
+
+    // 最近一帧的特征
+    FrameFeatures _features;
+
+    // 计数器
+    int _eyeClosedCounter;
+    int _yawningCounter;
+    int _drinkingCounter;
+    int _phoneCallingCounter;
+};
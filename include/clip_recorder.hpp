@@ -0,0 +1,140 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "driver_behavior.hpp"
+#include "frame_pool.hpp"
+#include "monitor_event.hpp"
+#include "spsc_queue.hpp"
+
+// 事件视频片段配置
+struct ClipConfig {
+    bool enabled = false;                    // 是否录制事件片段
+    std::string dir = "clips";               // 片段目录
+    double pre_seconds = 5.0;                // 事件前的时长(秒)
+    double post_seconds = 5.0;               // 事件后的时长(秒)
+    double scale = 0.5;                      // 缓存帧的缩放比例
+    int jpeg_quality = 70;                   // 缓存帧的JPEG质量
+    uint64_t max_memory_bytes = 64ull << 20; // 环形缓存占用内存上限
+    std::set<DriverBehavior> behaviors = {DriverBehavior::EYES_CLOSED, DriverBehavior::PHONE_CALLING}; // 需要录制片段的行为
+};
+
+// 事件视频片段统计
+struct ClipStats {
+    uint64_t frames_buffered = 0;    // 压缩进环形缓存的帧数
+    uint64_t frames_dropped = 0;     // 压缩线程跟不上而丢弃的帧数
+    uint64_t clips_written = 0;      // 已写出的片段数
+    uint64_t clips_failed = 0;       // 写出失败的片段数
+    uint64_t buffer_bytes = 0;       // 环形缓存当前占用的字节数
+    size_t buffer_frames = 0;        // 环形缓存当前帧数
+};
+
+// 事件前后视频片段录制
+// 监测线程把每一帧的句柄交给录制器（只增加引用计数，队列满时丢帧，从不阻塞）；
+// 压缩线程把帧缩小并JPEG压缩后放入按时长和内存限制的环形缓存；
+// 发生指定行为时，等事件后的帧也进入缓存后，由写出线程将前后片段写成MJPG编码的AVI文件
+class ClipRecorder {
+public:
+    explicit ClipRecorder(const ClipConfig& config = ClipConfig());
+    ~ClipRecorder();
+
+    ClipRecorder(const ClipRecorder&) = delete;
+    ClipRecorder& operator=(const ClipRecorder&) = delete;
+
+    // 启动压缩和写出线程
+    bool start();
+
+    // 停止：未完成的片段用已缓存的帧写出
+    void stop();
+
+    // 监测线程每帧调用（不阻塞）
+    void onFrame(const FrameHandle& frame);
+
+    // 请求录制事件片段，返回片段文件路径；该行为不需要录制或未启用时返回空字符串
+    std::string requestClip(const MonitorEvent& event);
+
+    // 获取统计
+    ClipStats getStats() const;
+
+    // 行为与配置字符串互相转换 (eyes_closed / yawning / drinking / phone_calling)
+    static bool stringToBehavior(const std::string& behavior_str, DriverBehavior& behavior);
+    static std::string behaviorToKey(DriverBehavior behavior);
+
+private:
+    // 等待压缩的帧
+    struct PendingFrame {
+        FrameHandle frame;
+        std::chrono::system_clock::time_point time;
+    };
+
+    // 环形缓存中的压缩帧
+    struct CompressedFrame {
+        std::chrono::system_clock::time_point time;
+        std::vector<uchar> jpeg;
+    };
+
+    // 等待事件后帧的片段
+    struct PendingClip {
+        std::string path;
+        std::chrono::system_clock::time_point begin;
+        std::chrono::system_clock::time_point end;
+    };
+
+    // 待写出的片段
+    struct ClipJob {
+        std::string path;
+        std::vector<std::shared_ptr<const CompressedFrame>> frames;
+    };
+
+    // 压缩线程
+    void compressLoop();
+
+    // 写出线程
+    void writeLoop();
+
+    // 压缩一帧放入环形缓存
+    void compress(const PendingFrame& pending);
+
+    // 把缓存中已经齐全的片段交给写出线程（force为true时不等事件后的帧）
+    void collectClips(std::chrono::system_clock::time_point now, bool force);
+
+    // 写出一个片段
+    bool writeClip(const ClipJob& job);
+
+private:
+    ClipConfig _config;
+    std::atomic<bool> _running;
+
+    // 监测线程 -> 压缩线程
+    std::unique_ptr<SpscQueue<PendingFrame>> _input;
+    std::thread _compressThread;
+
+    // 环形缓存
+    mutable std::mutex _bufferMutex;
+    std::deque<std::shared_ptr<const CompressedFrame>> _buffer;
+    uint64_t _bufferBytes;
+    std::vector<PendingClip> _pendingClips;
+
+    // 写出队列
+    std::mutex _jobMutex;
+    std::condition_variable _jobAvailable;
+    std::deque<ClipJob> _jobs;
+    bool _writerStopping;
+    std::thread _writeThread;
+
+    // 统计
+    std::atomic<uint64_t> _framesBuffered;
+    std::atomic<uint64_t> _framesDropped;
+    std::atomic<uint64_t> _clipsWritten;
+    std::atomic<uint64_t> _clipsFailed;
+};
@@ -2,11 +2,15 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "frame_source.hpp"
 
 // 使用nlohmann/json库
 using json = nlohmann::json;
 
+struct DmsConfig;
+
 class ConfigReader {
 public:
     ConfigReader(const std::string& config_file = "config/config.json");
@@ -24,6 +28,39 @@ public:
     // 获取摄像头帧率
     int getCameraFps() const;
     
+    // 获取帧源类型 (camera / video / images / synthetic)
+    std::string getSourceType() const;
+    
+    // 获取回放帧源路径（视频文件或图像目录）
+    std::string getSourcePath() const;
+    
+    // 回放结束后是否循环
+    bool isSourceLoop() const;
+    
+    // 回放时是否尽可能快地处理（不做帧率控制）
+    bool isSourceAsFastAsPossible() const;
+    
+    // 获取合成帧数量
+    int getSyntheticFrames() const;
+    
+    // 获取流水线队列容量
+    int getPipelineQueueCapacity() const;
+    
+    // 获取流水线丢帧策略 (block / drop_oldest)
+    std::string getPipelineDropPolicy() const;
+    
+    // 获取多路监测引擎的工作线程数 (0表示使用硬件并发数)
+    int getEngineWorkerThreads() const;
+    
+    // 获取多路监测的视频流列表（为空时运行单路监测）
+    std::vector<FrameSourceConfig> getEngineStreams() const;
+    
+    // 获取每个事件订阅者的队列容量
+    int getDispatchQueueCapacity() const;
+    
+    // 获取事件队列已满时的策略 (drop_oldest / drop_newest / block)
+    std::string getDispatchOverflowPolicy() const;
+    
     // 获取眼睛纵横比阈值
     double getEARThreshold() const;
     
@@ -42,6 +79,21 @@ public:
     // 获取打电话帧数阈值
     int getPhoneCallingFrames() const;
     
+    // 获取人脸检测缩放比例
+    double getDetectionScale() const;
+    
+    // 获取人脸跟踪模式 (off / landmarks / correlation)
+    std::string getTrackingMode() const;
+    
+    // 获取强制完整检测的帧间隔
+    int getTrackingRedetectInterval() const;
+    
+    // 获取特征点跟踪的最小IoU
+    double getTrackingMinIoU() const;
+    
+    // 获取相关滤波跟踪的最小峰值旁瓣比
+    double getTrackingMinPSR() const;
+    
     // 是否启用声音警报
     bool isEnableSound() const;
     
@@ -69,9 +121,87 @@ public:
     // 获取图像目录
     std::string getImagesDir() const;
     
+    // 获取内存中事件缓存的容量
+    int getEventRingCapacity() const;
+    
+    // 获取事件存储单个段文件的大小上限(MB)
+    int getEventStoreSegmentMB() const;
+    
+    // 获取事件存储单个段文件的时间跨度上限(秒)
+    int getEventStoreSegmentSeconds() const;
+    
+    // 获取事件存储稀疏索引的间隔（记录数）
+    int getEventStoreIndexInterval() const;
+    
+    // 事件存储是否批量fsync
+    bool isEventStoreGroupCommit() const;
+    
+    // 获取批量fsync的最长间隔(毫秒)
+    int getEventStoreSyncIntervalMs() const;
+    
+    // 获取触发fsync的累计记录数
+    int getEventStoreSyncBatch() const;
+    
+    // 获取证据图像保存方式 (full / face_roi / thumbnail)
+    std::string getEvidenceMode() const;
+    
+    // 获取证据图像JPEG质量
+    int getEvidenceJpegQuality() const;
+    
+    // 获取证据缩略图宽度
+    int getEvidenceThumbnailWidth() const;
+    
+    // 获取人脸区域向外扩展的比例
+    double getEvidenceRoiMargin() const;
+    
+    // 获取证据图像磁盘配额(MB)，0表示不限
+    int getEvidenceMaxDiskMB() const;
+    
+    // 获取证据图像编码线程数
+    int getEvidenceEncoderThreads() const;
+    
+    // 获取最多排队等待编码的证据图像数
+    int getEvidenceMaxPending() const;
+    
+    // 是否录制事件前后视频片段
+    bool isClipEnabled() const;
+    
+    // 获取事件片段目录
+    std::string getClipDir() const;
+    
+    // 获取事件前的片段时长(秒)
+    double getClipPreSeconds() const;
+    
+    // 获取事件后的片段时长(秒)
+    double getClipPostSeconds() const;
+    
+    // 获取片段缓存帧的缩放比例
+    double getClipScale() const;
+    
+    // 获取片段缓存帧的JPEG质量
+    int getClipJpegQuality() const;
+    
+    // 获取片段环形缓存的内存上限(MB)
+    int getClipMaxMemoryMB() const;
+    
+    // 获取需要录制片段的行为列表 (eyes_closed / yawning / drinking / phone_calling)
+    std::vector<std::string> getClipBehaviors() const;
+    
+    // 是否记录每帧特征
+    bool isFeatureRecordingEnabled() const;
+    
+    // 获取特征文件目录
+    std::string getFeatureDir() const;
+    
+    // 获取特征文件每个数据块的行数
+    int getFeatureBlockRows() const;
+    
     // 重新加载配置文件
     bool reload();
     
+    // 把配置解析并校验为类型化的快照，有错误时返回nullptr，errors中为 "字段路径: 原因"
+    std::shared_ptr<const DmsConfig> compile(std::vector<std::string>& errors) const;
+    
     // 获取配置文件路径
     std::string getConfigFilePath() const;
 
@@ -84,4 +214,7 @@ private:
     
     // 配置数据
     json _config;
+    
+    // 最近一次加载的错误（成功时为空）
+    std::string _loadError;
 };
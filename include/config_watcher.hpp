@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <filesystem>
+#include "config_reader.hpp"
+#include "dms_config.hpp"
+
+// 配置热加载统计
+struct ConfigReloadStats {
+    uint64_t applied = 0;                    // 校验通过并已发布的次数
+    uint64_t rejected = 0;                   // 解析或校验失败、保留原配置的次数
+    std::vector<std::string> last_errors;    // 最近一次被拒绝的原因（字段路径: 原因）
+};
+
+// 配置文件监视
+// 后台线程用inotify监视配置文件所在目录（编辑器通常先写临时文件再改名替换），文件稳定debounce_ms后
+// 重新加载并编译为新的快照；校验通过才交给回调发布，失败时保留当前快照并计入rejected。
+// 非Linux平台按文件修改时间轮询
+class ConfigWatcher {
+public:
+    // 新快照的发布回调，在监视线程上调用
+    using ReloadCallback = std::function<void(std::shared_ptr<const DmsConfig> config)>;
+
+    ConfigWatcher(std::shared_ptr<ConfigReader> reader, std::shared_ptr<const DmsConfig> current);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    // 启动监视线程
+    bool start(ReloadCallback callback);
+
+    // 停止监视线程
+    void stop();
+
+    // 立即重新加载一次，成功发布返回true
+    bool reloadNow();
+
+    // 当前生效的快照
+    std::shared_ptr<const DmsConfig> current() const;
+
+    // 获取统计
+    ConfigReloadStats getStats() const;
+
+private:
+    // 监视线程
+    void watchLoop();
+
+    // 等待配置文件变化（最多timeout_ms），有变化返回true
+    bool waitForChange(int timeout_ms);
+
+private:
+    std::shared_ptr<ConfigReader> _reader;
+    std::shared_ptr<const DmsConfig> _current;
+    ReloadCallback _callback;
+    std::string _dir;               // 配置文件所在目录
+    std::string _filename;          // 配置文件名
+
+    std::thread _thread;
+    std::atomic<bool> _running;
+    int _inotifyFd;
+    int _watchFd;
+    std::filesystem::file_time_type _lastWrite;   // 轮询方式下上次看到的修改时间
+
+    mutable std::mutex _mutex;      // 保护_current和统计
+    ConfigReloadStats _stats;
+};
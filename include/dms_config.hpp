@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include "frame_source.hpp"
+#include "face_tracker.hpp"
+#include "behavior_analyzer.hpp"
+#include "driver_monitor.hpp"
+#include "monitor_engine.hpp"
+#include "event_dispatcher.hpp"
+#include "event_store.hpp"
+#include "evidence_encoder.hpp"
+#include "clip_recorder.hpp"
+#include "feature_recorder.hpp"
+
+// 输出配置
+struct OutputSettings {
+    bool save_events = true;                     // 是否保存事件
+    std::string events_dir = "events";           // 事件目录
+    bool save_images = true;                     // 是否保存证据图像
+    std::string images_dir = "images";           // 图像目录
+    size_t event_ring_capacity = 4096;           // 内存中保留的最近事件数
+};
+
+// 警报配置
+struct AlertSettings {
+    bool enable_sound = true;                    // 是否启用声音警报
+    int sound_volume = 80;                       // 声音音量 (0-100)
+    bool display_warning = true;                 // 是否显示警告
+    bool log_events = true;                      // 是否记录事件
+};
+
+// 配置热加载
+struct ReloadSettings {
+    bool enabled = true;                         // 是否监视配置文件并在修改后重新加载
+    int debounce_ms = 200;                       // 文件最后一次修改后等待的时间(毫秒)，避免读到写了一半的文件
+};
+
+// 类型化的配置快照
+// 配置文件在启动时解析并校验一次，之后各模块只读取这里的普通字段，不再做JSON查找；
+// 快照创建后不再修改，以 std::shared_ptr<const DmsConfig> 在线程之间共享
+struct DmsConfig {
+    FrameSourceConfig source;                    // 单路监测的帧源（camera + source）
+    double target_fps = 30.0;                    // 采集目标帧率（camera.fps）
+    PipelineConfig pipeline;                     // 流水线队列和丢帧策略
+    double detection_scale = 1.0;                // 人脸检测缩放比例
+    FaceDetectorConfig detector;                 // 人脸检测后端
+    TrackingConfig tracking;                     // 人脸跟踪
+    MotionGateConfig motion_gate;                // 运动门控
+    DriverRoiConfig driver_roi;                  // 驾驶员区域
+    DetectionThresholds thresholds;              // 行为判定阈值
+    ShapeModelConfig model;                      // 面部特征点模型及其展开缓存
+
+    int worker_threads = 0;                      // 多路监测工作线程数
+    std::vector<FrameSourceConfig> streams;      // 多路监测的视频流（为空时运行单路监测）
+
+    SubscriberConfig dispatch;                   // 事件订阅者队列
+    AlertSettings alert;                         // 警报
+    OutputSettings output;                       // 事件和图像输出
+    EventStoreConfig event_store;                // 事件存储（目录为output.events_dir）
+    EvidenceConfig evidence;                     // 证据图像
+    ClipConfig clip;                             // 事件视频片段
+    FeatureRecorderConfig features;              // 每帧特征记录
+    ReloadSettings reload;                       // 配置热加载
+
+    // 多路监测引擎配置
+    EngineConfig engineConfig() const;
+
+    // 从JSON解析并校验。缺省的字段取默认值；类型错误、取值超出范围或未知的枚举值
+    // 记录为 "字段路径: 原因" 形式的错误，有错误时返回false
+    static bool fromJson(const nlohmann::json& root, DmsConfig& config, std::vector<std::string>& errors);
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// 驾驶行为类型
+enum class DriverBehavior {
+    NORMAL,          // 正常驾驶
+    EYES_CLOSED,     // 闭眼
+    YAWNING,         // 打哈欠
+    DRINKING,        // 喝水
+    PHONE_CALLING,   // 打电话
+    UNKNOWN          // 未知行为
+};
+
+// 行为种类数量（用于按行为计数和按行为索引的表）
+constexpr size_t kBehaviorCount = static_cast<size_t>(DriverBehavior::UNKNOWN) + 1;
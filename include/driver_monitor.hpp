@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <opencv2/opencv.hpp>
@@ -11,19 +12,105 @@
 #include <atomic>
 #include <mutex>
 #include <functional>
+#include <cstdint>
+#include <chrono>
+#include "driver_behavior.hpp"
+#include "behavior_analyzer.hpp"
+#include "frame_source.hpp"
+#include "spsc_queue.hpp"
+#include "latest_slot.hpp"
+#include "frame_scheduler.hpp"
+#include "face_detection.hpp"
+#include "face_tracker.hpp"
+#include "prepared_frame.hpp"
+#include "motion_gate.hpp"
+#include "frame_pool.hpp"
+#include "monitor_event.hpp"
+#include "feature_recorder.hpp"
+#include "live_config.hpp"
+#include "frame_annotator.hpp"
+#include "shape_model.hpp"
+#include "landmark_predictor.hpp"
 
-// 驾驶行为类型
-enum class DriverBehavior {
-    NORMAL,          // 正常驾驶
-    EYES_CLOSED,     // 闭眼
-    YAWNING,         // 打哈欠
-    DRINKING,        // 喝水
-    PHONE_CALLING,   // 打电话
-    UNKNOWN          // 未知行为
-};
+struct DmsConfig;
 
 // 行为检测结果回调函数类型
-using BehaviorCallback = std::function<void(DriverBehavior, const std::string&, const cv::Mat&)>;
+// 在监测线程上调用，应尽快返回（耗时处理交给EventDispatcher）；图像已标注完毕，可以保留句柄异步使用
+using BehaviorCallback = std::function<void(const MonitorEvent&)>;
+
+// 每帧观察者类型：在分发阶段线程上对每一帧调用（标注完成后），不得阻塞
+using FrameObserver = std::function<void(const FrameHandle&)>;
+
+// 推理跟不上采集时的丢帧策略
+enum class FrameDropPolicy {
+    BLOCK,           // 采集阶段等待，不丢帧（适用于逐帧回归测试）
+    DROP_OLDEST      // 推理跟不上时新帧替换尚未处理的旧帧，推理阶段总是处理最新采集的帧，保证延迟有界
+};
+
+// 流水线配置
+struct PipelineConfig {
+    size_t queue_capacity = 4;                              // 各阶段之间队列容量
+    FrameDropPolicy drop_policy = FrameDropPolicy::DROP_OLDEST; // 丢帧策略
+};
+
+// 随帧传递的面部特征点
+// 移动赋值时把特征点复制到自己已有的缓冲中（68个点约1KB），而不是接管对方的缓冲：
+// 队列槽位和各阶段持有的FramePacket预热后各自保留一份特征点缓冲，帧在阶段之间传递时不再分配和释放
+class PacketShape : public dlib::full_object_detection {
+public:
+    PacketShape() = default;
+    PacketShape(const PacketShape&) = default;
+    PacketShape(PacketShape&&) = default;
+    PacketShape& operator=(const PacketShape&) = default;
+
+    PacketShape& operator=(PacketShape&& other) {
+        dlib::full_object_detection::operator=(other);
+        return *this;
+    }
+
+    PacketShape& operator=(const dlib::full_object_detection& shape) {
+        dlib::full_object_detection::operator=(shape);
+        return *this;
+    }
+};
+
+// 流水线中在各阶段之间传递的帧数据
+struct FramePacket {
+    uint64_t sequence = 0;                                  // 帧序号（采集顺序，从1开始）
+    std::chrono::steady_clock::time_point capture_time;     // 采集时间
+    FrameHandle frame;                                      // 图像（帧缓冲池中缓冲的引用，传递时不复制像素）
+    bool has_face = false;                                  // 是否检测到人脸
+    dlib::rectangle face;                                   // 人脸框
+    PacketShape shape;                                      // 面部特征点
+    DriverBehavior behavior = DriverBehavior::NORMAL;       // 分类结果
+};
+
+// 启动耗时（模型加载和帧源打开并行进行）
+struct StartupStats {
+    double model_load_ms = 0.0;          // 面部特征点模型加载耗时
+    bool model_from_cache = false;       // 模型是否从展开缓存加载
+    double source_open_ms = 0.0;         // 帧源打开耗时
+    double init_ms = 0.0;                // 初始化总耗时
+    double first_detection_ms = -1.0;    // 从开始初始化到第一帧检测结果分发的耗时（尚未完成时为-1）
+};
+
+// 监测运行统计
+struct MonitorStats {
+    uint64_t frames_captured = 0;    // 已采集帧数
+    uint64_t frames_processed = 0;   // 已处理帧数
+    uint64_t frames_dropped = 0;     // 因推理落后而丢弃的帧数
+    double elapsed_seconds = 0.0;    // 运行时长(秒)
+    double fps = 0.0;                // 平均处理帧率
+    double avg_latency_ms = 0.0;     // 采集到分发的平均延迟(毫秒)
+    uint64_t detector_invocations = 0;   // 完整人脸检测次数
+    double detector_calls_per_second = 0.0; // 每秒完整人脸检测次数
+    uint64_t frames_reused = 0;          // 运动门控判定画面未变化、复用上一次特征点的帧数
+    double motion_skip_ratio = 0.0;      // 复用帧数占已处理帧数的比例
+    SchedulerStats scheduler;        // 采集调度统计（实际帧率、跳帧数、抖动）
+    FramePoolStats frame_pool;       // 帧缓冲池统计
+    double bytes_copied_per_frame = 0.0; // 平均每帧复制的像素字节数（稳定运行时应为0）
+    StartupStats startup;            // 启动耗时
+};
 
 class DriverMonitor {
 public:
@@ -33,58 +120,149 @@ public:
     // 初始化摄像头和模型
     bool initialize(int camera_id = 0);
     
+    // 使用指定帧源（摄像头、视频文件、图像目录或合成帧）初始化，打开帧源的同时在后台加载模型
+    bool initialize(std::unique_ptr<FrameSource> source);
+    
+    // 按配置快照初始化：应用帧率、检测缩放、跟踪、流水线和行为阈值，再打开帧源并加载模型
+    bool initialize(const DmsConfig& config);
+    
     // 启动监测
     bool start(BehaviorCallback callback);
     
     // 停止监测
     void stop();
     
-    // 获取当前帧
-    cv::Mat getCurrentFrame() const;
+    // 获取当前帧（已标注的帧，与分发阶段共享同一块缓冲，只读）
+    FrameHandle getCurrentFrame() const;
     
     // 获取当前检测到的行为
     DriverBehavior getCurrentBehavior() const;
     
+    // 回放帧源是否已经处理完毕
+    bool isFinished() const;
+    
+    // 获取运行统计
+    MonitorStats getStats() const;
+    
+    // 设置采集目标帧率（需在start之前调用，<=0 表示不做帧率控制）
+    void setTargetFps(double target_fps);
+    
+    // 设置人脸检测缩放比例（需在start之前调用，1表示在原始分辨率上检测）
+    void setDetectionScale(double scale);
+    
+    // 设置人脸检测后端（需在start之前调用，保留当前的检测缩放比例）
+    void setFaceDetectorConfig(const FaceDetectorConfig& config);
+    
+    // 设置人脸跟踪配置（需在start之前调用）
+    void setTrackingConfig(const TrackingConfig& config);
+    
+    // 设置运动门控配置（需在start之前调用）
+    void setMotionGateConfig(const MotionGateConfig& config);
+    
+    // 设置驾驶员区域配置（需在start之前调用）
+    void setDriverRoiConfig(const DriverRoiConfig& config);
+    
+    // 设置流水线配置（需在start之前调用）
+    void setPipelineConfig(const PipelineConfig& config);
+    
+    // 设置行为判定阈值（需在start之前调用）
+    void setThresholds(const DetectionThresholds& thresholds);
+    
+    // 设置面部特征点模型路径和展开缓存（需在initialize之前调用）
+    void setModelConfig(const ShapeModelConfig& config);
+    
+    // 运行中发布新的配置快照：各阶段线程在处理下一帧前取用，不暂停流水线、不丢帧
+    // 热加载目标帧率、人脸检测缩放比例和行为阈值；帧源、模型、流水线和跟踪配置需要重启
+    void applyConfig(std::shared_ptr<const DmsConfig> config);
+    
+    // 设置每帧观察者（需在start之前调用，例如事件片段录制）
+    void setFrameObserver(FrameObserver observer);
+    
+    // 设置每帧特征记录器（需在start之前调用，由分类阶段线程逐帧记录）
+    void setFeatureRecorder(std::shared_ptr<FeatureRecorder> recorder);
+    
+    // 丢帧策略与字符串互相转换
+    static FrameDropPolicy stringToDropPolicy(const std::string& policy_str);
+    static std::string dropPolicyToString(FrameDropPolicy policy);
+    
+    // 行为名称和提示信息（指向静态字符串，不分配内存）
+    static std::string_view behaviorName(DriverBehavior behavior);
+    static std::string_view behaviorMessage(DriverBehavior behavior);
+    
     // 行为类型转字符串
     static std::string behaviorToString(DriverBehavior behavior);
     
     // 获取行为提示信息
     static std::string getBehaviorMessage(DriverBehavior behavior);
+    
+    // 由流水线中的帧生成行为事件
+    static MonitorEvent makeEvent(int stream_id, const FramePacket& packet);
 
 private:
-    // 监测线程函数
-    void monitorThread();
+    // 采集阶段：从帧源读取图像并编号
+    void captureStage();
     
-    // 检测眼睛状态 (闭眼/睁眼)
-    bool detectEyesClosed(const dlib::full_object_detection& shape);
+    // 推理阶段：人脸检测和特征点定位
+    void inferenceStage();
     
-    // 检测哈欠
-    bool detectYawning(const dlib::full_object_detection& shape);
+    // 分类阶段：根据特征点判断驾驶行为
+    void classificationStage();
     
-    // 检测喝水
-    bool detectDrinking(const cv::Mat& frame);
+    // 标注与分发阶段：绘制结果、更新当前帧并调用回调
+    void dispatchStage();
     
-    // 检测打电话
-    bool detectPhoneCalling(const cv::Mat& frame, const dlib::full_object_detection& shape);
-    
-    // 计算眼睛纵横比 (Eye Aspect Ratio)
-    double calculateEAR(const std::vector<dlib::point>& eye);
-    
-    // 计算嘴部纵横比 (Mouth Aspect Ratio)
-    double calculateMAR(const dlib::full_object_detection& shape);
+    // 阶段线程等待上游数据时的退避
+    static void backoff(int& idle_rounds);
 
 private:
-    // OpenCV相关
-    cv::VideoCapture _camera;
-    cv::Mat _currentFrame;
+    // 帧源
+    std::unique_ptr<FrameSource> _frameSource;
+    
+    // 帧缓冲池和当前帧
+    std::unique_ptr<FramePool> _framePool;
+    FrameHandle _currentFrame;
     
     // dlib相关
-    dlib::frontal_face_detector _faceDetector;
-    dlib::shape_predictor _shapePredictor;
+    std::unique_ptr<FaceDetector> _faceDetector;
+    FaceTracker _faceTracker;
+    LandmarkPredictor _landmarkPredictor;
+    PreparedFrame _preparedFrame;       // 推理阶段当前帧的预处理缓存（只由推理线程使用）
+    MotionGate _motionGate;             // 运动门控及其复用的上一次推理结果（只由推理线程使用）
+    dlib::rectangle _lastFace;
+    dlib::full_object_detection _lastShape;
+    ShapeModelConfig _modelConfig;
     
     // 线程相关
-    std::thread _monitorThread;
+    std::vector<std::thread> _stageThreads;
     std::atomic<bool> _running;
+    std::atomic<bool> _finished;
+    
+    // 采集调度
+    double _targetFps;
+    FrameScheduler _scheduler;
+    
+    // 流水线相关
+    PipelineConfig _pipelineConfig;
+    std::unique_ptr<SpscQueue<FramePacket>> _captureQueue;    // 采集 -> 推理（block）
+    std::unique_ptr<LatestSlot<FramePacket>> _latestFrame;    // 采集 -> 推理（drop_oldest）
+    std::unique_ptr<SpscQueue<FramePacket>> _inferenceQueue;  // 推理 -> 分类
+    std::unique_ptr<SpscQueue<FramePacket>> _classifyQueue;   // 分类 -> 分发
+    std::atomic<bool> _captureDone;
+    std::atomic<bool> _inferenceDone;
+    std::atomic<bool> _classifyDone;
+    
+    // 统计相关
+    std::atomic<uint64_t> _framesCaptured;
+    std::atomic<uint64_t> _framesProcessed;
+    std::atomic<uint64_t> _framesDropped;
+    std::atomic<uint64_t> _detectorInvocations;
+    std::atomic<uint64_t> _framesReused;
+    std::atomic<int64_t> _elapsedNanos;
+    std::atomic<int64_t> _totalLatencyNanos;
+    std::chrono::steady_clock::time_point _startTime;
+    std::chrono::steady_clock::time_point _initStartTime;
+    StartupStats _startup;
+    std::atomic<int64_t> _firstDetectionNanos;
     
     // 当前检测到的行为
     DriverBehavior _currentBehavior;
@@ -93,16 +271,15 @@ private:
     
     // 回调函数
     BehaviorCallback _callback;
+    FrameObserver _frameObserver;
+    std::shared_ptr<FeatureRecorder> _featureRecorder;
+    
+    // 行为分析（计数器和随机数状态）
+    BehaviorAnalyzer _analyzer;
+    
+    // 分发阶段的标注（缓存各行为的文字叠加图像）
+    FrameAnnotator _annotator;
     
-    // 检测阈值
-    double _EAR_THRESHOLD;      // 眼睛纵横比阈值
-    double _MAR_THRESHOLD;      // 嘴部纵横比阈值
-    int _EYE_CLOSED_FRAMES;     // 连续闭眼帧数阈值
-    int _YAWNING_FRAMES;        // 连续哈欠帧数阈值
-    
-    // 计数器
-    int _eyeClosedCounter;
-    int _yawningCounter;
-    int _drinkingCounter;
-    int _phoneCallingCounter;
+    // 运行中发布的配置快照
+    LiveConfig<DmsConfig> _liveConfig;
 };
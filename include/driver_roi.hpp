@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include "prepared_frame.hpp"
+
+// 驾驶员区域模式
+enum class DriverRoiMode {
+    OFF,             // 在整幅画面上检测
+    FIXED,           // 只在配置的区域内检测
+    AUTO             // 先在配置的区域内检测，积累足够的驾驶员人脸后自动收缩到驾驶员所在区域
+};
+
+// 多个人脸时驾驶员人脸的选择规则
+enum class DriverSelection {
+    LARGEST,         // 面积最大的人脸（距离摄像头最近），面积相同时取更靠近区域中心的
+    CENTRAL          // 中心离区域中心最近的人脸，距离相同时取面积更大的
+};
+
+// 驾驶员区域配置
+struct DriverRoiConfig {
+    DriverRoiMode mode = DriverRoiMode::OFF;
+    double x = 0.0;                  // 区域左上角与宽高，取值为画面宽高的比例
+    double y = 0.0;
+    double width = 1.0;
+    double height = 1.0;
+    DriverSelection selection = DriverSelection::LARGEST;
+    int learn_frames = 30;           // 自动模式：学习区域所需的完整检测次数
+    double margin = 0.5;             // 自动模式：学习到的人脸范围向外扩展的距离（人脸边长的倍数）
+};
+
+// 驾驶员区域：人脸检测只在该区域内进行，并从检测结果中确定地选出驾驶员人脸
+// 区域以子帧的形式交给检测器（不复制像素），检测器只处理区域内的像素；
+// 自动模式下按完整检测选出的驾驶员人脸学习区域，学习完成后区域固定不变
+class DriverRoi {
+public:
+    explicit DriverRoi(const DriverRoiConfig& config = DriverRoiConfig());
+
+    // 设置配置（会丢弃已学习的区域）
+    void setConfig(const DriverRoiConfig& config);
+
+    // 获取配置
+    const DriverRoiConfig& getConfig() const;
+
+    // 指定画面尺寸下当前的检测区域（画面坐标）
+    cv::Rect region(const cv::Size& frame_size) const;
+
+    // 本帧用于人脸检测的子帧；区域为整幅画面时直接返回frame
+    PreparedFrame& crop(PreparedFrame& frame);
+
+    // 从最近一次crop得到的子帧上的检测结果中选出驾驶员人脸（结果为画面坐标），
+    // 自动模式下同时记录学习样本。没有人脸时返回false
+    bool select(const std::vector<dlib::rectangle>& faces, dlib::rectangle& face);
+
+    // 自动模式是否已学习完成
+    bool isLearned() const;
+
+    // 模式、选择规则与字符串互相转换
+    static DriverRoiMode stringToMode(const std::string& mode_str);
+    static std::string modeToString(DriverRoiMode mode);
+    static DriverSelection stringToSelection(const std::string& selection_str);
+    static std::string selectionToString(DriverSelection selection);
+
+private:
+    // 配置的区域（画面坐标），为空时取整幅画面
+    cv::Rect configuredRegion(const cv::Size& frame_size) const;
+
+    // 记录一个驾驶员人脸样本，样本足够时计算学习到的区域
+    void learn(const dlib::rectangle& face);
+
+    DriverRoiConfig _config;
+    cv::Size _frameSize;             // 最近一次crop的画面尺寸
+    cv::Rect _region;                // 最近一次crop使用的区域
+    bool _learned;
+    cv::Rect _learnedRegion;
+    std::vector<dlib::rectangle> _samples;
+    PreparedFrame _cropped;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "monitor_event.hpp"
+
+// 订阅者队列已满时的处理策略
+enum class OverflowPolicy {
+    DROP_OLDEST,     // 丢弃最早未处理的事件，保留最新事件
+    DROP_NEWEST,     // 丢弃新到的事件
+    BLOCK            // 发布者等待（只适用于离线回放，会拖慢检测）
+};
+
+// 订阅者配置
+struct SubscriberConfig {
+    size_t queue_capacity = 64;                         // 事件队列容量
+    OverflowPolicy overflow = OverflowPolicy::DROP_OLDEST; // 队列已满时的策略
+};
+
+// 订阅者统计
+struct SubscriberStats {
+    std::string name;                // 订阅者名称
+    uint64_t published = 0;          // 投递到该订阅者的事件数
+    uint64_t delivered = 0;          // 已处理的事件数
+    uint64_t dropped = 0;            // 因队列已满而丢弃的事件数
+    size_t max_depth = 0;            // 队列最大积压
+};
+
+// 行为事件分发器
+// 检测线程只把事件放入各订阅者的有界队列就返回，每个订阅者在自己的线程上处理事件，
+// 写日志、编码图像等耗时操作不会拖慢检测，慢的订阅者也不会影响其他订阅者
+class EventDispatcher {
+public:
+    using Handler = std::function<void(const MonitorEvent&)>;
+
+    EventDispatcher();
+    ~EventDispatcher();
+
+    EventDispatcher(const EventDispatcher&) = delete;
+    EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+    // 添加订阅者并启动其处理线程，返回订阅者编号
+    int subscribe(const std::string& name, Handler handler, const SubscriberConfig& config = SubscriberConfig());
+
+    // 发布事件（可由多个线程同时调用）
+    void publish(const MonitorEvent& event);
+
+    // 处理完所有已发布的事件后停止各订阅者线程
+    void stop();
+
+    // 获取各订阅者的统计
+    std::vector<SubscriberStats> getStats() const;
+
+    // 溢出策略与字符串互相转换
+    static OverflowPolicy stringToOverflowPolicy(const std::string& policy_str);
+    static std::string overflowPolicyToString(OverflowPolicy policy);
+
+private:
+    // 订阅者：有界环形队列（多生产者/单消费者）和处理线程
+    struct Subscriber {
+        std::string name;
+        Handler handler;
+        SubscriberConfig config;
+
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::vector<MonitorEvent> slots;
+        size_t head = 0;             // 下一个待处理事件的位置
+        size_t count = 0;            // 队列中的事件数
+        bool stopping = false;
+
+        std::thread worker;
+
+        uint64_t published = 0;
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        size_t maxDepth = 0;
+    };
+
+    // 订阅者处理线程
+    void workerLoop(Subscriber& subscriber);
+
+    // 将事件放入订阅者队列
+    static void enqueue(Subscriber& subscriber, const MonitorEvent& event);
+
+private:
+    mutable std::mutex _subscribersMutex;
+    std::vector<std::unique_ptr<Subscriber>> _subscribers;
+};
@@ -4,29 +4,39 @@
 #include <vector>
 #include <memory>
 #include <mutex>
-#include <fstream>
+#include <chrono>
 #include <opencv2/opencv.hpp>
 #include "driver_monitor.hpp"
+#include "evidence_encoder.hpp"
+#include "event_ring.hpp"
+#include "event_store.hpp"
+#include "live_config.hpp"
 
-// 事件记录结构体
-struct BehaviorEvent {
-    DriverBehavior behavior;    // 行为类型
-    std::string message;        // 提示信息
-    std::string timestamp;      // 时间戳
-    std::string image_path;     // 图像路径（如果有）
-};
+struct DmsConfig;
 
 class EventLogger {
 public:
     EventLogger(const std::string& events_dir = "events", const std::string& images_dir = "images");
+    
+    // 按配置快照创建（目录、是否保存图像、事件缓存容量、证据图像和事件存储配置）
+    explicit EventLogger(const DmsConfig& config);
     ~EventLogger();
 
     // 记录事件
     bool logEvent(DriverBehavior behavior, const std::string& message, const cv::Mat& image);
     
-    // 获取所有记录的事件
+    // 记录监测线程产生的事件（图像共享帧缓冲，在后台编码），clip_path为事件片段路径
+    bool logEvent(const MonitorEvent& event, const std::string& clip_path = "");
+    
+    // 获取缓存中的事件（复制，较多事件时应使用getEventRing()的游标或visit查询）
     std::vector<BehaviorEvent> getEvents() const;
     
+    // 获取事件环形缓存，用于按时间范围和行为查询
+    const EventRing& getEventRing() const;
+    
+    // 设置事件缓存容量（会清空已缓存的事件）
+    void setEventRingCapacity(size_t capacity);
+    
     // 清除所有事件记录
     void clearEvents();
     
@@ -47,24 +57,65 @@ public:
     
     // 是否保存图像
     bool isSaveImages() const;
+    
+    // 设置证据图像配置（保存方式、JPEG质量、磁盘配额等）
+    void setEvidenceConfig(const EvidenceConfig& config);
+    
+    // 等待所有证据图像写入完毕，并把事件存储同步到磁盘
+    void flush();
+    
+    // 获取证据图像统计
+    EvidenceStats getEvidenceStats() const;
+    
+    // 设置事件存储配置（段大小、索引间隔、批量fsync等，存储目录始终为事件目录）
+    void setEventStoreConfig(const EventStoreConfig& config);
+    
+    // 获取事件存储统计
+    EventStoreStats getEventStoreStats() const;
+    
+    // 运行中发布新的配置快照：事件和图像目录、是否保存图像在记录下一条事件时（记录线程上）生效
+    void applyConfig(std::shared_ptr<const DmsConfig> config);
 
 private:
     // 获取当前时间戳
     std::string getCurrentTimestamp() const;
     
+    // 格式化时间戳
+    std::string formatTimestamp(std::chrono::system_clock::time_point time) const;
+    
+    // 写入事件存储和事件缓存
+    void appendEvent(DriverBehavior behavior, const std::string& message,
+                     std::chrono::system_clock::time_point time, const std::string& timestamp,
+                     const std::string& image_path, const std::string& clip_path = "");
+    
+    // 生成证据图像文件名
+    std::string makeImageFilename(const std::string& prefix, const std::string& timestamp) const;
+    
+    // 按当前事件目录重新打开事件存储
+    void openEventStore();
+    
+    // 应用运行中发布的配置快照（只在记录事件的线程上调用）
+    void refreshConfig();
+    
     // 确保目录存在
     bool ensureDirectoryExists(const std::string& dir) const;
     
-    // 保存图像
-    std::string saveImage(const cv::Mat& image, const std::string& prefix) const;
+    // 保存图像（提交给后台编码器，返回文件路径）
+    std::string saveImage(const cv::Mat& image, const std::string& prefix);
 
 private:
     std::string _eventsDir;         // 事件目录
     std::string _imagesDir;         // 图像目录
     bool _saveImages;               // 是否保存图像
     
-    std::vector<BehaviorEvent> _events;  // 事件记录
-    mutable std::mutex _eventsMutex;     // 事件记录互斥锁
+    EvidenceConfig _evidenceConfig;                 // 证据图像配置
+    std::unique_ptr<EvidenceEncoder> _encoder;      // 证据图像后台编码器
+    
+    std::unique_ptr<EventRing> _events;  // 最近事件的环形缓存（内部加锁）
+    
+    EventStoreConfig _storeConfig;                  // 事件存储配置
+    std::unique_ptr<EventStore> _store;             // 分段二进制事件存储（内部加锁）
     
-    std::ofstream _logFile;         // 日志文件
+    LiveConfig<DmsConfig> _liveConfig;              // 运行中发布的配置快照
+    uint64_t _configVersion = 0;                    // 已应用的快照版本
 };
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <limits>
+#include <shared_mutex>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "driver_behavior.hpp"
+
+// 事件记录结构体
+struct BehaviorEvent {
+    uint64_t id = 0;            // 事件编号（从1开始递增）
+    DriverBehavior behavior = DriverBehavior::NORMAL; // 行为类型
+    std::string message;        // 提示信息
+    std::string timestamp;      // 时间戳
+    int64_t timestamp_ns = 0;   // 时间戳（自1970年起的纳秒数，用于查询）
+    std::string image_path;     // 图像路径（如果有）
+    std::string clip_path;      // 事件前后视频片段路径（如果有）
+};
+
+// 事件查询条件
+struct EventQuery {
+    int64_t from_ns = std::numeric_limits<int64_t>::min();  // 起始时间（含）
+    int64_t to_ns = std::numeric_limits<int64_t>::max();    // 结束时间（含）
+    uint32_t behavior_mask = 0;                             // 行为过滤（按位，0表示全部）
+
+    // 只查询某种行为
+    static uint32_t maskOf(DriverBehavior behavior) {
+        return 1u << static_cast<uint32_t>(behavior);
+    }
+
+    // 事件是否满足条件
+    bool matches(const BehaviorEvent& event) const {
+        return event.timestamp_ns >= from_ns && event.timestamp_ns <= to_ns &&
+               (behavior_mask == 0 || (behavior_mask & maskOf(event.behavior)) != 0);
+    }
+};
+
+class EventRing;
+
+// 事件游标：按事件编号向前遍历，每次只复制一个事件，遍历期间写入不受影响。
+// 遍历过程中被覆盖的事件会被跳过并计入missed；缓存编号跳变后从缓存中最早的事件继续，跳过的编号不计入missed
+class EventCursor {
+public:
+    // 取下一个满足条件的事件，没有更多事件时返回false
+    bool next(BehaviorEvent& event);
+
+    // 遍历过程中因被覆盖而跳过的事件数
+    uint64_t missed() const { return _missed; }
+
+private:
+    friend class EventRing;
+    EventCursor(const EventRing* ring, const EventQuery& query, uint64_t next_id, uint64_t generation);
+
+    const EventRing* _ring;
+    EventQuery _query;
+    uint64_t _nextId;
+    uint64_t _generation;    // 创建游标时缓存的编号代数
+    uint64_t _missed = 0;
+    bool _done = false;
+};
+
+// 固定容量的事件环形缓存
+// 超出容量时覆盖最早的事件，内存占用不随运行时长增长；按行为的计数器在覆盖后仍然累计。
+// 事件按记录顺序存放，时间戳早于上一个事件时沿用上一个事件的时间戳（多路视频流的事件可能乱序到达），
+// 保证时间戳单调不减，时间范围查询用二分查找定位起点
+class EventRing {
+public:
+    explicit EventRing(size_t capacity = 4096);
+
+    // 追加事件，返回事件编号。event.id为0时由缓存分配编号；非0时沿用该编号（由事件存储分配），
+    // 与缓存中上一个编号不连续时（首次追加、切换事件目录）清空缓存中的事件，从该编号重新开始
+    uint64_t append(BehaviorEvent event);
+
+    // 清空缓存中的事件（计数器保留）
+    void clear();
+
+    // 创建游标
+    EventCursor query(const EventQuery& query = EventQuery()) const;
+
+    // 在读锁下依次访问满足条件的事件（不复制），visitor返回false时停止，返回访问的事件数。
+    // visitor中不能调用本对象的写操作
+    size_t visit(const EventQuery& query, const std::function<bool(const BehaviorEvent&)>& visitor) const;
+
+    // 复制满足条件的事件（最多max_events个，从旧到新）
+    std::vector<BehaviorEvent> snapshot(const EventQuery& query = EventQuery(),
+                                        size_t max_events = std::numeric_limits<size_t>::max()) const;
+
+    // 统计满足条件的缓存中事件数
+    size_t count(const EventQuery& query) const;
+
+    // 运行以来各行为的累计次数（包括已被覆盖的事件）
+    std::array<uint64_t, kBehaviorCount> getTotals() const;
+
+    // 缓存中的事件数
+    size_t size() const;
+
+    // 容量
+    size_t capacity() const;
+
+    // 运行以来追加的事件总数
+    uint64_t totalAppended() const;
+
+private:
+    friend class EventCursor;
+
+    // 缓存中最早事件的编号（调用方持有锁）
+    uint64_t firstIdLocked() const;
+
+    // 按编号取事件（调用方持有锁，编号必须在缓存范围内）
+    const BehaviorEvent& atLocked(uint64_t id) const;
+
+    // 第一个时间戳不早于from_ns的事件编号（调用方持有锁）
+    uint64_t lowerBoundLocked(int64_t from_ns) const;
+
+private:
+    mutable std::shared_mutex _mutex;
+    std::vector<BehaviorEvent> _slots;
+    uint64_t _nextId;        // 下一个事件编号
+    uint64_t _generation;    // 编号代数，编号不连续时加1（游标据此重新定位）
+    size_t _count;           // 缓存中的事件数
+    int64_t _lastTimestampNs; // 上一个事件的时间戳
+    uint64_t _appended;      // 运行以来追加的事件总数
+    std::array<uint64_t, kBehaviorCount> _totals;
+};
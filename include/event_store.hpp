@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdio>
+#include <cstdint>
+#include "event_ring.hpp"
+
+// 事件存储配置
+struct EventStoreConfig {
+    std::string dir = "events";                  // 存储目录
+    uint64_t max_segment_bytes = 4ull << 20;     // 单个段文件大小上限，超出后切换新段
+    int64_t max_segment_seconds = 3600;          // 单个段文件的时间跨度上限(秒)
+    uint32_t index_interval = 64;                // 每隔多少条记录写一个稀疏索引项
+    bool group_commit = true;                    // 批量fsync（false时每条记录都fsync）
+    int sync_interval_ms = 1000;                 // 批量fsync的最长间隔(毫秒)
+    uint32_t sync_batch = 32;                    // 累计多少条记录立即fsync
+};
+
+// 事件存储统计
+struct EventStoreStats {
+    uint64_t records = 0;            // 本次运行写入的记录数
+    uint64_t bytes = 0;              // 本次运行写入的字节数
+    uint64_t syncs = 0;              // fsync次数
+    uint64_t segments = 0;           // 本次运行创建的段文件数
+    uint64_t last_id = 0;            // 最后一条记录的事件编号
+};
+
+// 只追加的分段二进制事件存储
+//
+// 目录中每个段由两个文件组成：
+//   events-<首条事件编号>.seg  段头 + 连续的记录（长度 + CRC32 + 负载）
+//   events-<首条事件编号>.idx  稀疏索引，每 index_interval 条记录一项（时间戳, 事件编号, 文件偏移）
+// 时间戳为单调不减的纳秒时间（系统时间回拨时沿用上一条记录的时间），
+// 读取"某时刻之后的事件"时先按段首时间选段，再用稀疏索引定位偏移，无需扫描全部历史。
+// 打开时会丢弃上次异常退出留下的不完整记录，并从最后一条有效记录继续编号
+class EventStore {
+public:
+    explicit EventStore(const EventStoreConfig& config = EventStoreConfig());
+    ~EventStore();
+
+    EventStore(const EventStore&) = delete;
+    EventStore& operator=(const EventStore&) = delete;
+
+    // 打开存储并创建新段
+    bool open();
+
+    // 同步并关闭
+    void close();
+
+    // 追加一条事件记录（事件编号和时间戳由存储分配，返回后写入event）
+    bool append(BehaviorEvent& event);
+
+    // 立即fsync
+    void sync();
+
+    // 是否已打开
+    bool isOpen() const;
+
+    // 获取统计
+    EventStoreStats getStats() const;
+
+    // 获取配置
+    const EventStoreConfig& getConfig() const;
+
+private:
+    // 新建段文件
+    bool openSegment(int64_t timestamp_ns);
+
+    // 关闭当前段
+    void closeSegment();
+
+    // 写入缓冲并在需要时fsync（调用方持有锁）
+    void flushLocked(bool force_sync);
+
+    // 批量fsync线程
+    void syncLoop();
+
+    // 从已有段文件中恢复最后的事件编号和时间戳
+    void recover();
+
+private:
+    EventStoreConfig _config;
+
+    mutable std::mutex _mutex;
+    std::FILE* _segment;
+    std::FILE* _index;
+    uint64_t _segmentBytes;
+    uint64_t _segmentRecords;
+    int64_t _segmentStartNs;
+
+    uint64_t _nextId;
+    int64_t _lastTimestampNs;
+    uint32_t _unsynced;
+    std::vector<uint8_t> _record;     // 复用的编码缓冲
+    bool _open;
+
+    std::thread _syncThread;
+    std::condition_variable _syncWake;
+    bool _stopping;
+
+    EventStoreStats _stats;
+};
+
+// 事件存储读取器（可与写入进程同时运行，读取到最后一条完整记录为止）
+class EventStoreReader {
+public:
+    explicit EventStoreReader(const std::string& dir);
+
+    // 按首条事件编号排序的段文件列表
+    std::vector<std::string> listSegments() const;
+
+    // 按顺序读取时间戳不早于since_ns的事件，callback返回false时停止
+    bool readSince(int64_t since_ns, const std::function<bool(const BehaviorEvent&)>& callback) const;
+
+    // 读取单个段文件（从start_offset开始，0表示从第一条记录开始）
+    static bool readSegment(const std::string& path, uint64_t start_offset,
+                            const std::function<bool(const BehaviorEvent&)>& callback);
+
+    // 用稀疏索引查找段中时间戳不早于since_ns的记录附近的偏移，返回0表示从头读
+    static uint64_t seekOffset(const std::string& segment_path, int64_t since_ns);
+
+    // 读取段的首条记录时间，失败返回false
+    static bool segmentStartTime(const std::string& segment_path, int64_t& start_ns);
+
+private:
+    std::string _dir;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "frame_pool.hpp"
+#include "work_stealing_pool.hpp"
+
+// 证据图像保存方式
+enum class EvidenceMode {
+    FULL,            // 完整标注帧
+    FACE_ROI,        // 只保存人脸区域（没有人脸时保存缩略图）
+    THUMBNAIL        // 缩小的完整帧
+};
+
+// 证据图像配置
+struct EvidenceConfig {
+    EvidenceMode mode = EvidenceMode::FULL;  // 保存方式
+    int jpeg_quality = 95;                   // JPEG质量 (1-100)
+    int thumbnail_width = 320;               // 缩略图宽度(像素)
+    double roi_margin = 0.3;                 // 人脸区域向外扩展的比例
+    uint64_t max_disk_bytes = 0;             // 证据图像占用磁盘的上限（0表示不限）
+    int encoder_threads = 2;                 // 编码线程数
+    size_t max_pending = 16;                 // 最多排队等待编码的图像数，超出时丢弃
+};
+
+// 证据图像统计
+struct EvidenceStats {
+    uint64_t encoded = 0;            // 已保存的图像数
+    uint64_t dropped = 0;            // 排队已满而丢弃的图像数
+    uint64_t failed = 0;             // 编码或写入失败的图像数
+    uint64_t evicted = 0;            // 因超出磁盘配额删除的旧图像数
+    uint64_t bytes_on_disk = 0;      // 当前证据图像占用的字节数
+    double avg_encode_ms = 0.0;      // 平均编码+写入耗时(毫秒)
+};
+
+// 证据图像后台编码器
+// 在线程池上裁剪/缩放、JPEG编码并写入磁盘，调用方立即得到文件路径；
+// 目录中的证据图像总大小超过配额时按时间从旧到新删除
+class EvidenceEncoder {
+public:
+    EvidenceEncoder(const std::string& dir, const EvidenceConfig& config = EvidenceConfig());
+    ~EvidenceEncoder();
+
+    EvidenceEncoder(const EvidenceEncoder&) = delete;
+    EvidenceEncoder& operator=(const EvidenceEncoder&) = delete;
+
+    // 提交共享帧（不复制像素），返回将要写入的文件路径，被丢弃时返回空字符串
+    std::string submit(const FrameHandle& frame, const cv::Rect& face, const std::string& filename);
+
+    // 提交普通图像（会复制一份，调用方可以立即修改原图）
+    std::string submit(const cv::Mat& image, const cv::Rect& face, const std::string& filename);
+
+    // 等待所有已提交的图像写入完毕
+    void flush();
+
+    // 获取统计
+    EvidenceStats getStats() const;
+
+    // 获取配置
+    const EvidenceConfig& getConfig() const;
+
+    // 保存方式与字符串互相转换
+    static EvidenceMode stringToMode(const std::string& mode_str);
+    static std::string modeToString(EvidenceMode mode);
+
+private:
+    // 编码任务
+    struct Job {
+        FrameHandle frame;           // 共享帧
+        cv::Mat image;               // 或者独立的图像副本
+        cv::Rect face;               // 人脸框（可为空）
+        std::string path;            // 输出路径
+    };
+
+    // 提交编码任务
+    std::string enqueue(Job job, const std::string& filename);
+
+    // 在工作线程上编码并写入
+    void encode(const Job& job);
+
+    // 按保存方式选择要编码的区域
+    cv::Mat selectRegion(const cv::Mat& image, const cv::Rect& face, cv::Mat& scratch) const;
+
+    // 记录新文件并执行磁盘配额
+    void account(const std::string& path, uint64_t bytes);
+
+    // 启动时统计目录中已有的证据图像
+    void scanExisting();
+
+private:
+    std::string _dir;
+    EvidenceConfig _config;
+    std::unique_ptr<WorkStealingPool> _pool;
+    std::atomic<size_t> _pending;
+
+    // 磁盘上的证据图像（从旧到新）
+    mutable std::mutex _filesMutex;
+    std::deque<std::pair<std::string, uint64_t>> _files;
+    uint64_t _bytesOnDisk;
+
+    std::atomic<uint64_t> _encoded;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<uint64_t> _failed;
+    std::atomic<uint64_t> _evicted;
+    std::atomic<int64_t> _encodeNanos;
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include <dlib/image_processing/frontal_face_detector.h>
+#include <dlib/opencv.h>
+#include "work_stealing_pool.hpp"
+#include "prepared_frame.hpp"
+
+// OpenCV 4.5.4 起提供 cv::FaceDetectorYN（YuNet，基于DNN模块）
+#if defined(HAVE_OPENCV_OBJDETECT) && defined(HAVE_OPENCV_DNN) && \
+    (CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || \
+                                                        (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 4))))
+#define DMS_HAVE_YUNET 1
+#else
+#define DMS_HAVE_YUNET 0
+#endif
+
+// 人脸检测后端
+enum class FaceDetectorBackend {
+    HOG,             // dlib HOG + 线性SVM（get_frontal_face_detector）
+    DNN              // OpenCV cv::FaceDetectorYN，在CPU上运行
+};
+
+// 人脸检测配置
+struct FaceDetectorConfig {
+    FaceDetectorBackend backend = FaceDetectorBackend::HOG;
+    std::string dnn_model = "face_detection_yunet_2023mar.onnx"; // YuNet模型文件
+    int hog_threads = 1;             // HOG并行扫描线程数（1为串行检测，<=0 使用硬件并发数）
+    int dnn_threads = 1;             // DNN推理线程数（OpenCV的线程数是进程级设置）
+    double score_threshold = 0.6;    // DNN检测的最低置信度
+    double nms_threshold = 0.3;      // DNN检测的非极大值抑制IoU阈值
+    double box_scale = 0.9;          // DNN人脸框换算为dlib风格正方形框时的边长比例
+};
+
+// 人脸检测器接口：DriverMonitor 和 FaceTracker 只通过该接口做完整检测，不关心检测算法
+// 检测器实例不支持并发调用，每个线程持有一份
+class FaceDetector {
+public:
+    virtual ~FaceDetector() = default;
+
+    // 在预处理好的帧上检测人脸，结果写入调用方复用的faces（原始分辨率，按置信度从高到低）
+    // 灰度图、缩小图从frame的缓存中取得，同一帧的其他使用者可以复用
+    virtual void detect(PreparedFrame& frame, std::vector<dlib::rectangle>& faces) = 0;
+
+    // 检测一帧独立的图像（使用检测器自带的预处理缓存）
+    void detect(const cv::Mat& frame, std::vector<dlib::rectangle>& faces);
+
+    // 检测人脸，返回原始分辨率下的人脸框
+    std::vector<dlib::rectangle> detect(const cv::Mat& frame);
+
+    // 设置检测缩放比例，取值范围 (0, 1]，1表示在原始分辨率上检测
+    void setScale(double scale);
+
+    // 获取检测缩放比例
+    double getScale() const;
+
+    // 检测器描述信息
+    virtual std::string describe() const = 0;
+
+    // 根据配置创建检测器；DNN后端不可用或模型加载失败时退回HOG检测器
+    static std::unique_ptr<FaceDetector> create(const FaceDetectorConfig& config, double scale = 1.0);
+
+    // 检测后端与字符串互相转换
+    static FaceDetectorBackend stringToBackend(const std::string& backend_str);
+    static std::string backendToString(FaceDetectorBackend backend);
+
+    // 把缩放图像上的人脸框映射回原始分辨率
+    static dlib::rectangle scaleRectangle(const dlib::rectangle& rect, double factor);
+
+protected:
+    double _scale = 1.0;
+
+private:
+    PreparedFrame _prepared;    // detect(cv::Mat) 使用的预处理缓存
+};
+
+// 在缩小的灰度图上运行HOG人脸检测，并把人脸框映射回原始分辨率
+// 特征点定位仍然在原始分辨率上进行，以保证EAR/MAR的精度
+// 注意：HOG检测窗口约为80x80像素，缩放后小于该尺寸的人脸将无法检出
+class ScaledFaceDetector : public FaceDetector {
+public:
+    explicit ScaledFaceDetector(double scale = 1.0);
+    ~ScaledFaceDetector() override = default;
+
+    using FaceDetector::detect;
+    void detect(PreparedFrame& frame, std::vector<dlib::rectangle>& faces) override;
+
+    std::string describe() const override;
+
+protected:
+    // 在准备好的图像（原图或缩小的灰度图）上运行检测，结果按置信度从高到低
+    virtual void scan(const dlib::cv_image<dlib::bgr_pixel>& image, std::vector<dlib::rect_detection>& detections);
+    virtual void scan(const dlib::cv_image<unsigned char>& image, std::vector<dlib::rect_detection>& detections);
+
+    dlib::frontal_face_detector _detector;
+
+private:
+    std::vector<dlib::rect_detection> _detections;
+};
+
+// 并行多尺度HOG人脸检测器
+// dlib的检测器在一个线程上依次扫描金字塔的每一层和5个方向的滤波器。这里按同样的规则构建金字塔
+// （层数、缩小方式与dlib一致），每层的HOG特征提取作为一个任务，特征提取完成后该层的每个滤波器
+// 再作为一个任务，分散到线程池上；所有候选框汇总后按置信度排序，用检测器自带的重叠判定做非极大值抑制，
+// 结果与串行检测一致。只有一路摄像头时可以用上其他空闲的核心
+class ParallelHogDetector : public ScaledFaceDetector {
+public:
+    // thread_count <= 0 时使用硬件并发数
+    ParallelHogDetector(double scale, int thread_count);
+    ~ParallelHogDetector() override = default;
+
+    std::string describe() const override;
+
+protected:
+    void scan(const dlib::cv_image<dlib::bgr_pixel>& image, std::vector<dlib::rect_detection>& detections) override;
+    void scan(const dlib::cv_image<unsigned char>& image, std::vector<dlib::rect_detection>& detections) override;
+
+private:
+    using Scanner = dlib::frontal_face_detector::image_scanner_type;
+
+    // 构建金字塔并在线程池上扫描各层和各滤波器
+    template <typename Pixel, typename Image>
+    void scanPyramid(const Image& image, std::vector<std::unique_ptr<dlib::array2d<Pixel>>>& levels,
+                     std::vector<dlib::rect_detection>& detections);
+
+    std::unique_ptr<WorkStealingPool> _pool;
+
+    // 各滤波器（预先分解的滤波器组）及其阈值
+    std::vector<Scanner::fhog_filterbank> _filters;
+    std::vector<double> _thresholds;
+
+    // 每层一个只扫描单层的扫描器，以及金字塔各层图像（第0层为输入图像本身，不复制）
+    std::vector<Scanner> _scanners;
+    std::vector<std::unique_ptr<dlib::array2d<dlib::bgr_pixel>>> _colorLevels;
+    std::vector<std::unique_ptr<dlib::array2d<unsigned char>>> _grayLevels;
+
+    // 各任务的候选框 [层][滤波器]，以及汇总结果
+    std::vector<std::vector<std::pair<double, dlib::rectangle>>> _candidates;
+    std::vector<dlib::rect_detection> _merged;
+};
+
+// OpenCV YuNet DNN人脸检测器
+// 对侧脸和仪表台仰视角度比HOG更稳定。YuNet的框包含额头，比dlib的HOG框更高，换算为以框中心为中心、
+// 边长为宽高均值乘box_scale的正方形，使特征点模型得到与训练时相近的输入框
+class DnnFaceDetector : public FaceDetector {
+public:
+    explicit DnnFaceDetector(const FaceDetectorConfig& config, double scale = 1.0);
+    ~DnnFaceDetector() override = default;
+
+    // 模型是否加载成功
+    bool isLoaded() const;
+
+    using FaceDetector::detect;
+    void detect(PreparedFrame& frame, std::vector<dlib::rectangle>& faces) override;
+
+    std::string describe() const override;
+
+private:
+    FaceDetectorConfig _config;
+#if DMS_HAVE_YUNET
+    cv::Ptr<cv::FaceDetectorYN> _detector;
+#endif
+    cv::Size _inputSize;
+
+    // 复用的中间结果（灰度输入时转换的3通道图像不属于帧缓存，由检测器自己保存）
+    cv::Mat _color;
+    cv::Mat _output;
+    std::vector<std::pair<float, dlib::rectangle>> _scored;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include <dlib/opencv.h>
+#include "face_detection.hpp"
+#include "prepared_frame.hpp"
+#include "driver_roi.hpp"
+
+// 人脸跟踪模式
+enum class TrackingMode {
+    OFF,             // 每帧都完整检测
+    LANDMARKS,       // 用上一帧特征点推算本帧人脸框
+    CORRELATION      // 用dlib相关滤波跟踪器跟踪人脸框
+};
+
+// 人脸跟踪配置
+struct TrackingConfig {
+    TrackingMode mode = TrackingMode::OFF;
+    int redetect_interval = 10;   // 每隔多少帧强制完整检测一次
+    double min_iou = 0.5;         // 特征点模式：输入框与特征点推算框的最小IoU
+    double min_psr = 7.0;         // 相关滤波模式：最小峰值旁瓣比
+};
+
+// 检测一次、其间跟踪的人脸定位
+// 完整检测之间用跟踪结果直接作为特征点定位的输入框，跟踪置信度下降或到达
+// 检测间隔时要求重新完整检测
+class FaceTracker {
+public:
+    explicit FaceTracker(const TrackingConfig& config = TrackingConfig());
+    ~FaceTracker() = default;
+
+    // 设置跟踪配置（会丢弃当前跟踪状态）
+    void setConfig(const TrackingConfig& config);
+
+    // 获取跟踪配置
+    const TrackingConfig& getConfig() const;
+
+    // 设置驾驶员区域配置（会丢弃当前跟踪状态和已学习的区域）
+    void setDriverRoiConfig(const DriverRoiConfig& config);
+
+    // 驾驶员区域
+    const DriverRoi& getDriverRoi() const;
+
+    // 定位本帧人脸：跟踪可用时直接使用跟踪结果，跟踪失败或到达检测间隔时调用检测器完整检测
+    // 完整检测只在驾驶员区域内进行，多个人脸时按区域的选择规则确定驾驶员
+    // detector_invoked 返回本帧是否运行了完整检测；检测器和相关滤波器共用frame的灰度图等缓存
+    bool locate(PreparedFrame& frame, FaceDetector& detector, dlib::rectangle& face, bool& detector_invoked);
+
+    // 本帧是否需要完整人脸检测
+    bool needsDetection() const;
+
+    // 完整检测得到人脸后，以检测框重新开始跟踪
+    void reset(PreparedFrame& frame, const dlib::rectangle& face);
+
+    // 在本帧上跟踪人脸，成功时返回本帧的人脸框
+    bool track(PreparedFrame& frame, dlib::rectangle& face);
+
+    // 用本帧特征点定位结果更新跟踪状态
+    void update(const dlib::full_object_detection& shape);
+
+    // 丢失人脸，下一帧重新检测
+    void lost();
+
+    // 最近一次的跟踪置信度（IoU或峰值旁瓣比，取决于跟踪模式）
+    double getConfidence() const;
+
+    // 跟踪模式与字符串互相转换
+    static TrackingMode stringToMode(const std::string& mode_str);
+    static std::string modeToString(TrackingMode mode);
+
+private:
+    // 特征点的外接矩形
+    static dlib::rectangle landmarkBounds(const dlib::full_object_detection& shape);
+
+    // 根据特征点外接矩形和检测时记录的相对关系推算人脸框
+    dlib::rectangle boxFromLandmarks(const dlib::full_object_detection& shape) const;
+
+    // 两个矩形的交并比
+    static double intersectionOverUnion(const dlib::rectangle& a, const dlib::rectangle& b);
+
+private:
+    TrackingConfig _config;
+    bool _tracking;
+    bool _calibrated;
+    int _framesSinceDetection;
+    double _confidence;
+
+    // 本帧输入特征点定位的人脸框，以及下一帧的预测框
+    dlib::rectangle _currentBox;
+    dlib::rectangle _nextBox;
+
+    // 检测框相对特征点外接矩形的偏移和尺寸比例（在完整检测的帧上标定）
+    double _offsetX;
+    double _offsetY;
+    double _scaleX;
+    double _scaleY;
+
+    dlib::correlation_tracker _correlationTracker;
+    DriverRoi _driverRoi;
+    std::vector<dlib::rectangle> _faces;    // 完整检测结果（复用）
+};
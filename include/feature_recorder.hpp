@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <dlib/image_processing.h>
+#include "behavior_analyzer.hpp"
+#include "spsc_queue.hpp"
+
+// 单帧特征记录
+struct FeatureSample {
+    int64_t timestamp_ms = 0;      // 时间（自1970年起的毫秒数）
+    uint64_t sequence = 0;         // 帧序号
+    bool has_face = false;         // 是否检测到人脸（未检测到人脸时特征均为0）
+    float ear = 0.0f;              // 眼睛纵横比
+    float mar = 0.0f;              // 嘴部纵横比
+    float head_roll = 0.0f;        // 头部侧倾角(度)
+    int32_t face_x = 0;            // 人脸框
+    int32_t face_y = 0;
+    int32_t face_w = 0;
+    int32_t face_h = 0;
+    DriverBehavior behavior = DriverBehavior::NORMAL; // 本帧判定的行为
+};
+
+// 按列存放的特征（读取特征文件的结果，也是写入时的块缓冲）
+struct FeatureColumns {
+    std::vector<int64_t> timestamp_ms;
+    std::vector<uint64_t> sequence;
+    std::vector<uint8_t> has_face;
+    std::vector<float> ear;
+    std::vector<float> mar;
+    std::vector<float> head_roll;
+    std::vector<int32_t> face_x;
+    std::vector<int32_t> face_y;
+    std::vector<int32_t> face_w;
+    std::vector<int32_t> face_h;
+    std::vector<uint8_t> behavior;
+
+    size_t size() const { return timestamp_ms.size(); }
+    void append(const FeatureSample& sample);
+    void clear();
+};
+
+// 特征记录配置
+struct FeatureRecorderConfig {
+    bool enabled = false;            // 是否记录每帧特征
+    std::string dir = "features";    // 特征文件目录
+    size_t block_rows = 1024;        // 每个数据块的行数
+    size_t queue_capacity = 256;     // 监测线程到写入线程的队列容量（满时丢弃）
+};
+
+// 特征记录统计
+struct FeatureRecorderStats {
+    uint64_t rows_recorded = 0;      // 已写入的行数
+    uint64_t rows_dropped = 0;       // 因队列满而丢弃的行数
+    uint64_t blocks_written = 0;     // 已写入的数据块数
+    uint64_t bytes_written = 0;      // 已写入的字节数
+};
+
+// 每帧特征记录器
+//
+// 监测线程每帧只把一条定长记录放入无锁队列（不分配内存、不加锁、不做IO），
+// 后台线程攒够block_rows行后按列编码写入文件：每列先与上一行做差，再做zigzag变换和变长整数编码。
+// EAR/MAR按1e-4、侧倾角按0.01度量化；30帧/秒时相邻帧的差值通常只占1~2字节，每行约十几字节。
+// 每个数据块独立解码，异常退出时只丢失最后一个未写完的块
+class FeatureRecorder {
+public:
+    FeatureRecorder(const FeatureRecorderConfig& config, const std::string& name);
+    ~FeatureRecorder();
+
+    FeatureRecorder(const FeatureRecorder&) = delete;
+    FeatureRecorder& operator=(const FeatureRecorder&) = delete;
+
+    // 创建特征文件并启动写入线程
+    bool start();
+
+    // 写出剩余的行并停止
+    void stop();
+
+    // 记录一帧（只能由一个线程按帧顺序调用）
+    void record(const FeatureSample& sample);
+
+    // 由一帧的检测结果生成记录（features只在has_face时有效）
+    static FeatureSample makeSample(uint64_t sequence, bool has_face, const dlib::rectangle& face,
+                                    const FrameFeatures& features, DriverBehavior behavior);
+
+    // 获取统计
+    FeatureRecorderStats getStats() const;
+
+    // 特征文件路径
+    std::string getPath() const;
+
+private:
+    // 写入线程
+    void writeLoop();
+
+    // 编码并写出当前块
+    bool writeBlock();
+
+private:
+    FeatureRecorderConfig _config;
+    std::string _name;
+    std::string _path;
+
+    std::unique_ptr<SpscQueue<FeatureSample>> _queue;
+    std::atomic<bool> _running;
+    std::thread _writeThread;
+
+    // 以下只由写入线程访问
+    std::FILE* _file;
+    FeatureColumns _block;
+    std::vector<uint8_t> _encoded;
+
+    std::atomic<uint64_t> _rowsRecorded;
+    std::atomic<uint64_t> _rowsDropped;
+    std::atomic<uint64_t> _blocksWritten;
+    std::atomic<uint64_t> _bytesWritten;
+};
+
+// 特征文件读取
+class FeatureLogReader {
+public:
+    // 读取整个特征文件（追加到columns），name返回记录时的视频流名称。
+    // 文件末尾不完整的块会被忽略
+    static bool read(const std::string& path, FeatureColumns& columns, std::string* name = nullptr);
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include "driver_behavior.hpp"
+
+// 在帧上标注特征点、人脸框以及当前行为和提示信息
+// 每种行为的文字只在第一次出现（或帧宽度变化）时渲染成叠加图像和掩码，之后每帧只做一次
+// 带掩码的复制，不再每帧拼接字符串和调用putText；叠加图像是标注线程的私有缓存
+class FrameAnnotator {
+public:
+    FrameAnnotator() = default;
+    ~FrameAnnotator() = default;
+
+    // 标注一帧（has_face为false时只绘制行为文字）
+    void annotate(cv::Mat& frame, bool has_face, const dlib::rectangle& face,
+                  const dlib::full_object_detection& shape, DriverBehavior behavior);
+
+private:
+    // 一种行为的文字叠加图像
+    struct LabelOverlay {
+        cv::Mat image;      // 文字图像（帧宽度 x kLabelHeight）
+        cv::Mat mask;       // 文字像素的掩码
+    };
+
+    // 获取（必要时渲染）行为文字的叠加图像
+    const LabelOverlay& overlay(DriverBehavior behavior, const cv::Mat& frame);
+
+    // 文字区域高度
+    static constexpr int kLabelHeight = 70;
+
+private:
+    std::array<LabelOverlay, kBehaviorCount> _overlays;
+};
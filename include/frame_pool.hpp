@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <opencv2/opencv.hpp>
+
+class FramePool;
+struct FrameBuffer;
+
+// 缓冲池的共享状态：缓冲池和每块缓冲各持有一份引用，
+// 缓冲池先于句柄销毁时，最后一个句柄仍能在同一把锁下判断是回收还是释放缓冲
+struct FramePoolCore {
+    std::mutex mutex;
+    std::vector<FrameBuffer*> buffers;   // 全部缓冲
+    std::vector<FrameBuffer*> free;      // 空闲缓冲
+    bool closed = false;                 // 缓冲池已销毁，之后归还的缓冲直接释放
+};
+
+// 帧缓冲池中的一块缓冲，由FrameHandle引用计数
+struct FrameBuffer {
+    cv::Mat image;                           // 预分配的图像内存
+    std::atomic<int> refs{0};                // 引用计数
+    std::shared_ptr<FramePoolCore> core;     // 所属缓冲池的共享状态（创建后不再修改）
+};
+
+// 帧缓冲句柄
+// 复制句柄只增加引用计数，不复制像素；最后一个句柄释放时缓冲回到缓冲池。
+// 约定：帧只在发布前（采集写入、分发阶段标注）由唯一持有者修改，之后各消费者只读共享
+class FrameHandle {
+public:
+    FrameHandle() = default;
+    FrameHandle(const FrameHandle& other);
+    FrameHandle(FrameHandle&& other) noexcept;
+    FrameHandle& operator=(const FrameHandle& other);
+    FrameHandle& operator=(FrameHandle&& other) noexcept;
+    ~FrameHandle();
+
+    // 是否引用了有效图像
+    bool empty() const;
+
+    // 只读访问图像
+    const cv::Mat& image() const;
+
+    // 可写访问图像（仅限帧发布前的唯一持有者）
+    cv::Mat& mutableImage();
+
+    // 当前引用计数
+    int useCount() const;
+
+    // 释放引用
+    void reset();
+
+private:
+    friend class FramePool;
+    explicit FrameHandle(FrameBuffer* buffer);
+
+    FrameBuffer* _buffer = nullptr;
+};
+
+// 帧缓冲池统计
+struct FramePoolStats {
+    size_t capacity = 0;             // 缓冲总数
+    size_t in_use = 0;               // 正在使用的缓冲数
+    uint64_t acquisitions = 0;       // 获取缓冲次数
+    uint64_t pool_misses = 0;        // 缓冲用尽时新分配的次数
+    uint64_t bytes_copied = 0;       // 复制或重新分配的像素字节数（稳定运行时应为0）
+};
+
+// 预分配的帧缓冲池
+// 采集阶段直接把图像读入池中的缓冲，之后各阶段传递句柄，整条流水线不再为每帧分配内存或复制像素
+class FramePool {
+public:
+    // width/height为0时在读入第一帧后按其尺寸分配其余缓冲
+    FramePool(size_t capacity = 8, int width = 0, int height = 0, int type = CV_8UC3);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // 获取一块空闲缓冲；缓冲用尽时新分配一块并计入未命中
+    FrameHandle acquire();
+
+    // 通过read_fn把一帧直接读入缓冲（read_fn签名为 bool(cv::Mat&)）。
+    // 缓冲尺寸与帧一致时不发生分配；不一致时记录重新分配的字节数，并按新尺寸调整空闲缓冲
+    template <typename ReadFn>
+    bool read(FrameHandle& handle, ReadFn&& read_fn) {
+        cv::Mat& image = handle.mutableImage();
+        const uchar* data = image.data;
+        const bool sized = !image.empty();
+        if (!read_fn(image) || image.empty()) {
+            return false;
+        }
+        if (image.data != data) {
+            if (sized) {
+                recordCopy(image.total() * image.elemSize());
+            }
+            adoptFormat(image);
+        }
+        return true;
+    }
+
+    // 复制一幅图像到池中（计入复制字节数，只用于帧源无法直接写入缓冲的情况）
+    FrameHandle copyOf(const cv::Mat& image);
+
+    // 记录写入缓冲时发生的复制或重新分配（例如帧源输出尺寸与预分配尺寸不一致）
+    void recordCopy(size_t bytes);
+
+    // 获取统计
+    FramePoolStats getStats() const;
+
+private:
+    friend class FrameHandle;
+
+    // 缓冲引用计数归零时回收；缓冲池已销毁时释放缓冲
+    static void recycle(FrameBuffer* buffer);
+
+    // 新建一块缓冲
+    FrameBuffer* allocate();
+
+    // 帧尺寸或类型变化时，按新格式重新分配空闲缓冲
+    void adoptFormat(const cv::Mat& image);
+
+private:
+    std::shared_ptr<FramePoolCore> _core;   // 与各缓冲共享，生命周期覆盖所有句柄
+    int _width;
+    int _height;
+    int _type;
+
+
+    std::atomic<uint64_t> _acquisitions;
+    std::atomic<uint64_t> _poolMisses;
+    std::atomic<uint64_t> _bytesCopied;
+};
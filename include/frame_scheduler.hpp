@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// 帧调度统计
+struct SchedulerStats {
+    uint64_t frames_scheduled = 0;   // 已调度的帧数
+    uint64_t frames_skipped = 0;     // 因超出预算而跳过的帧周期数
+    uint64_t frames_captured = 0;    // 成功采集的帧数
+    double target_fps = 0.0;         // 目标帧率
+    double achieved_fps = 0.0;       // 实际达到的帧率（按成功采集的帧计算，读取失败的周期不计入）
+    double jitter_ms = 0.0;          // 唤醒时间相对截止时间偏差的标准差(毫秒)
+    double max_lateness_ms = 0.0;    // 最大唤醒延迟(毫秒)
+};
+
+// 基于steady_clock截止时间的帧调度器
+// 每一帧的截止时间都在上一帧截止时间的基础上累加固定周期，处理耗时不会累积成漂移；
+// 超出预算时直接跳过错过的周期，而不是排队补帧，保证下游总是处理最新的帧
+class FrameScheduler {
+public:
+    explicit FrameScheduler(double target_fps = 30.0);
+    ~FrameScheduler() = default;
+
+    // 设置目标帧率，<=0 表示不做帧率控制
+    void setTargetFps(double target_fps);
+
+    // 获取目标帧率
+    double getTargetFps() const;
+
+    // 以当前时间为起点重新开始调度并清空统计
+    void reset();
+
+    // 等待到下一帧的截止时间，返回被跳过的帧周期数
+    int waitNextFrame();
+
+    // 本周期成功采集到一帧（由采集线程在读取成功后调用）
+    void frameCaptured();
+
+    // 获取调度统计
+    SchedulerStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double _targetFps;
+    Clock::duration _period;
+    Clock::time_point _nextDeadline;
+    Clock::time_point _startTime;
+    bool _started;
+
+    // 统计数据（延迟偏差使用Welford算法在线计算方差）
+    mutable std::mutex _statsMutex;
+    uint64_t _framesScheduled;
+    uint64_t _framesSkipped;
+    double _latenessMean;
+    double _latenessM2;
+    double _maxLateness;
+    uint64_t _framesCaptured;
+    Clock::time_point _firstCapture;
+    Clock::time_point _lastCapture;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+// 帧源类型
+enum class FrameSourceType {
+    CAMERA,          // 实时摄像头
+    VIDEO_FILE,      // 录制的视频文件
+    IMAGE_SEQUENCE,  // 图像目录
+    SYNTHETIC        // 合成帧（用于吞吐量测试）
+};
+
+// 帧源配置
+struct FrameSourceConfig {
+    std::string name;                // 名称（多路监测时用于区分视频流）
+    FrameSourceType type = FrameSourceType::CAMERA;
+    int device_id = 0;               // 摄像头设备ID
+    std::string path;                // 视频文件路径或图像目录
+    int width = 640;                 // 图像宽度
+    int height = 480;                // 图像高度
+    int fps = 30;                    // 帧率
+    bool loop = false;               // 回放结束后是否从头循环
+    bool as_fast_as_possible = false; // 回放时不做帧率控制，尽可能快地处理
+    int synthetic_frames = 0;        // 合成帧数量 (0表示不限)
+};
+
+// 帧源接口：监测线程只通过该接口获取图像，不关心图像来自摄像头还是回放
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // 打开帧源
+    virtual bool open() = 0;
+
+    // 读取下一帧，失败或数据读完时返回false
+    // frame的尺寸和类型与帧一致时，实现应直接写入其已有内存而不重新分配（帧缓冲池依赖这一点）
+    virtual bool read(cv::Mat& frame) = 0;
+
+    // 跳过若干帧（调度器超出预算时调用，保证下一次读取到的是最新的帧）
+    virtual void skip(int frames);
+
+    // 释放帧源
+    virtual void release() = 0;
+
+    // 帧源是否已打开
+    virtual bool isOpened() const = 0;
+
+    // 是否为实时帧源（摄像头）
+    virtual bool isLive() const = 0;
+
+    // 回放数据是否已经读完（实时帧源永远返回false）
+    virtual bool isExhausted() const { return false; }
+
+    // 是否以"尽可能快"模式运行，此时监测线程不做帧率控制
+    virtual bool isFreeRunning() const { return false; }
+
+    // 帧源描述信息
+    virtual std::string describe() const = 0;
+
+    // 根据配置创建帧源
+    static std::unique_ptr<FrameSource> create(const FrameSourceConfig& config);
+
+    // 帧源类型与字符串互相转换
+    static FrameSourceType stringToType(const std::string& type_str);
+    static std::string typeToString(FrameSourceType type);
+};
+
+// 实时摄像头帧源
+class CameraFrameSource : public FrameSource {
+public:
+    explicit CameraFrameSource(const FrameSourceConfig& config);
+    ~CameraFrameSource() override;
+
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    void skip(int frames) override;
+    void release() override;
+    bool isOpened() const override;
+    bool isLive() const override { return true; }
+    std::string describe() const override;
+
+private:
+    FrameSourceConfig _config;
+    cv::VideoCapture _camera;
+};
+
+// 视频文件回放帧源
+class VideoFileFrameSource : public FrameSource {
+public:
+    explicit VideoFileFrameSource(const FrameSourceConfig& config);
+    ~VideoFileFrameSource() override;
+
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    void skip(int frames) override;
+    void release() override;
+    bool isOpened() const override;
+    bool isLive() const override { return false; }
+    bool isExhausted() const override { return _exhausted; }
+    bool isFreeRunning() const override { return _config.as_fast_as_possible; }
+    std::string describe() const override;
+
+private:
+    FrameSourceConfig _config;
+    cv::VideoCapture _video;
+    bool _exhausted;
+};
+
+// 图像目录回放帧源（按文件名排序）
+class ImageSequenceFrameSource : public FrameSource {
+public:
+    explicit ImageSequenceFrameSource(const FrameSourceConfig& config);
+    ~ImageSequenceFrameSource() override = default;
+
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    void release() override;
+    bool isOpened() const override;
+    bool isLive() const override { return false; }
+    bool isExhausted() const override { return _exhausted; }
+    bool isFreeRunning() const override { return _config.as_fast_as_possible; }
+    std::string describe() const override;
+
+private:
+    // 把图像文件读入复用的文件缓冲
+    bool readFile(const std::string& path);
+
+    FrameSourceConfig _config;
+    std::vector<std::string> _files;
+    std::vector<uchar> _fileBuffer;
+    size_t _index;
+    bool _opened;
+    bool _exhausted;
+};
+
+// 合成帧源：生成确定性的运动图像，不依赖任何硬件和数据文件
+class SyntheticFrameSource : public FrameSource {
+public:
+    explicit SyntheticFrameSource(const FrameSourceConfig& config);
+    ~SyntheticFrameSource() override = default;
+
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    void release() override;
+    bool isOpened() const override;
+    bool isLive() const override { return false; }
+    bool isExhausted() const override { return _exhausted; }
+    bool isFreeRunning() const override { return _config.as_fast_as_possible; }
+    std::string describe() const override;
+
+private:
+    FrameSourceConfig _config;
+    cv::Mat _background;
+    long _frameIndex;
+    bool _opened;
+    bool _exhausted;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <dlib/image_processing.h>
+
+// 68点模型的特征点索引表
+namespace landmark_index {
+
+constexpr int kNumLandmarks = 68;
+
+// 每个距离由一对特征点决定，EAR/MAR/侧倾角/人脸尺寸用到的全部距离排成一张表，
+// 补齐到kPairCount个（补齐项为同一个点，距离为0），一次循环算完
+constexpr int kPairCount = 16;
+
+enum Pair : int {
+    LEFT_EYE_V1 = 0,     // 37-41 左眼上下眼睑
+    LEFT_EYE_V2,         // 38-40
+    LEFT_EYE_H,          // 36-39 左眼内外眼角
+    RIGHT_EYE_V1,        // 43-47 右眼上下眼睑
+    RIGHT_EYE_V2,        // 44-46
+    RIGHT_EYE_H,         // 42-45 右眼内外眼角
+    MOUTH_V_OUTER,       // 51-57 外唇上下
+    MOUTH_V_INNER,       // 62-66 内唇上下
+    MOUTH_H,             // 48-54 左右嘴角
+    EYE_CORNERS,         // 36-45 两外眼角（侧倾角和人脸尺寸）
+    PAIR_USED            // 实际使用的距离个数
+};
+
+constexpr std::array<uint8_t, kPairCount> kPairFrom = {
+    37, 38, 36, 43, 44, 42, 51, 62, 48, 36, 0, 0, 0, 0, 0, 0
+};
+constexpr std::array<uint8_t, kPairCount> kPairTo = {
+    41, 40, 39, 47, 46, 45, 57, 66, 54, 45, 0, 0, 0, 0, 0, 0
+};
+
+static_assert(PAIR_USED <= kPairCount, "特征点距离表容量不足");
+
+} // namespace landmark_index
+
+// 68个特征点的结构数组（x、y分别连续存放），每帧从dlib的结果复制一次，不分配内存
+struct LandmarkBuffer {
+    alignas(32) float x[landmark_index::kNumLandmarks];
+    alignas(32) float y[landmark_index::kNumLandmarks];
+};
+
+// 一帧特征点的几何特征
+struct LandmarkFeatures {
+    float ear_left = 0.0f;       // 左眼纵横比
+    float ear_right = 0.0f;      // 右眼纵横比
+    float ear = 0.0f;            // 左右眼平均纵横比
+    float mar = 0.0f;            // 嘴部纵横比
+    float head_roll = 0.0f;      // 头部侧倾角（两外眼角连线与水平线的夹角，度，带符号）
+    float face_size = 0.0f;      // 人脸尺寸（两外眼角距离，像素），用于按人脸大小归一化
+};
+
+// 特征点几何特征计算
+// 特征点先复制到定长的float结构数组中，再按编译期的索引表一次取出所有点对的坐标差，
+// 在固定长度的循环中同时求出全部距离（编译器可向量化），最后组合成EAR/MAR等特征；
+// 计算结果与BehaviorAnalyzer::calculateEAR/calculateMAR一致（float精度）
+class LandmarkFeatureKernel {
+public:
+    // 复制特征点（不足68个的部分填0）
+    static void load(const dlib::full_object_detection& shape, LandmarkBuffer& buffer);
+
+    // 由特征点计算几何特征
+    static LandmarkFeatures compute(const LandmarkBuffer& buffer);
+
+    // 复制并计算
+    static LandmarkFeatures compute(const dlib::full_object_detection& shape);
+};
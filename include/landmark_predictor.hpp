@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include "shape_model.hpp"
+
+// 级联回归树特征点推理引擎
+//
+// 与dlib::shape_predictor使用同一个训练好的模型，但直接运行在映射的展开缓存上：
+// - 分裂节点按 [级联层][回归树][节点] 存为连续的结构数组（采样像素编号为uint16，阈值为int16），
+//   叶子上的形状增量不复制，直接读取映射内存
+// - 每层级联先按当前形状一次算出全部采样像素的灰度，再逐棵树无分支地走到叶子
+// - 各棵树的形状增量按树的顺序用SIMD累加到当前形状上，与dlib的逐棵累加结果一致
+//
+// 采样像素是0~255的整数，两像素之差 d 满足 d > t 当且仅当 d > floor(t)，
+// 因此float阈值可以无损地换成int16阈值
+class FlatShapePredictor {
+public:
+    explicit FlatShapePredictor(std::shared_ptr<const FlatShapeModel> model);
+
+    // 在BGR或灰度图像上定位人脸框内的特征点，结果写入调用方复用的shape（特征点数不变时不分配内存）
+    // 临时缓冲是线程局部的，多个线程可以并发调用同一个预测器
+    void predict(const cv::Mat& image, const dlib::rectangle& face, dlib::full_object_detection& shape) const;
+
+    // 同上，返回新的结果
+    dlib::full_object_detection operator()(const cv::Mat& image, const dlib::rectangle& face) const;
+
+    // 特征点数
+    uint32_t numLandmarks() const { return _landmarks; }
+
+private:
+    // 按当前形状计算一层级联全部采样像素的灰度
+    void samplePixels(const cv::Mat& image, const dlib::rectangle& face, uint32_t cascade,
+                      const float* shape, int16_t* pixels) const;
+
+    std::shared_ptr<const FlatShapeModel> _model;
+    uint32_t _landmarks;
+    uint32_t _cascades;
+    uint32_t _trees;
+    uint32_t _pixels;
+    uint32_t _depth;
+    uint32_t _splitsPerTree;
+
+    // 平均形状及其去中心化的坐标（用于求当前形状相对平均形状的相似变换）
+    std::vector<float> _initialShape;            // [2L]
+    std::vector<double> _centeredShape;          // [2L]
+    double _centeredNorm;                        // 去中心化坐标的平方和
+
+    // 采样点（结构数组）
+    std::vector<uint16_t> _anchors;              // [C][P] 锚点特征点
+    std::vector<float> _deltaX;                  // [C][P] 相对锚点的偏移
+    std::vector<float> _deltaY;
+
+    // 分裂节点（结构数组）
+    std::vector<uint16_t> _splitIdx1;            // [C][T][S]
+    std::vector<uint16_t> _splitIdx2;
+    std::vector<int16_t> _splitThresh;
+};
+
+// 特征点预测器：按配置使用dlib实现或展开模型上的推理引擎
+class LandmarkPredictor {
+public:
+    LandmarkPredictor() = default;
+
+    LandmarkPredictor(const LandmarkPredictor&) = delete;
+    LandmarkPredictor& operator=(const LandmarkPredictor&) = delete;
+
+    // 按配置加载模型；flat 引擎无法使用展开缓存时退回dlib实现
+    bool load(const ShapeModelConfig& config, ShapeModelLoadInfo& info);
+
+    // 定位人脸框内的特征点，结果写入shape
+    void predict(const cv::Mat& image, const dlib::rectangle& face, dlib::full_object_detection& shape) const;
+
+    // 实际使用的推理引擎
+    LandmarkEngine engine() const { return _engine; }
+
+private:
+    LandmarkEngine _engine = LandmarkEngine::DLIB;
+    dlib::shape_predictor _dlib;
+    std::unique_ptr<FlatShapePredictor> _flat;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// 单生产者/单消费者的"最新值"交换槽（三缓冲，无锁，不分配内存）
+// 生产者每次发布都会替换尚未被取走的旧值，消费者总是取到最新发布的值；
+// 只允许一个线程调用publish、一个线程调用take
+template <typename T>
+class LatestSlot {
+public:
+    LatestSlot()
+        : _middle(1),
+          _back(2),
+          _front(0) {
+    }
+
+    LatestSlot(const LatestSlot&) = delete;
+    LatestSlot& operator=(const LatestSlot&) = delete;
+
+    // 发布新值（生产者线程），返回true表示替换了一个尚未被取走的旧值（旧值被丢弃）
+    bool publish(T&& item) {
+        _slots[_back] = std::move(item);
+        const uint8_t previous = _middle.exchange(static_cast<uint8_t>(_back | kFresh), std::memory_order_acq_rel);
+        _back = previous & kIndexMask;
+        // 换回来的槽位要么是被替换的旧值，要么是消费者已取走的空值；立即释放其持有的资源
+        _slots[_back] = T();
+        return (previous & kFresh) != 0;
+    }
+
+    // 取出最新的值（消费者线程），没有新值时返回false
+    bool take(T& item) {
+        if ((_middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        // 只有消费者会清除新值标记，交换得到的一定是最新发布的值
+        const uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & kIndexMask;
+        item = std::move(_slots[_front]);
+        return true;
+    }
+
+    // 是否没有尚未取走的值
+    bool empty() const {
+        return (_middle.load(std::memory_order_acquire) & kFresh) == 0;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    T _slots[3];
+
+    // 中间槽位的下标和新值标记；生产者和消费者各自持有的槽位下标放在独立的缓存行，避免伪共享
+    alignas(64) std::atomic<uint8_t> _middle;
+    alignas(64) uint8_t _back;       // 生产者正在写入的槽位（只由生产者访问）
+    alignas(64) uint8_t _front;      // 消费者最近取走的槽位（只由消费者访问）
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// 运行中可替换的只读配置（RCU方式）
+// 发布方原子地替换快照指针后递增版本号；各阶段线程每帧只读一次版本号（一次原子加载），
+// 版本变化时才取出新快照并应用到本线程持有的对象上。旧快照由仍在使用它的线程持有，
+// 最后一个引用释放时自动回收，读取方不加锁、不等待，不影响帧的处理
+template <typename T>
+class LiveConfig {
+public:
+    // 发布新的快照
+    void publish(std::shared_ptr<const T> config) {
+        std::atomic_store(&_config, std::move(config));
+        _version.fetch_add(1, std::memory_order_release);
+    }
+
+    // seen为调用方已应用的版本号；有新版本时更新seen并返回最新快照，否则返回空指针
+    std::shared_ptr<const T> poll(uint64_t& seen) const {
+        uint64_t version = _version.load(std::memory_order_acquire);
+        if (version == seen) {
+            return nullptr;
+        }
+        seen = version;
+        return std::atomic_load(&_config);
+    }
+
+    // 当前版本号（0表示尚未发布过）
+    uint64_t version() const {
+        return _version.load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<const T> _config;
+    std::atomic<uint64_t> _version{0};
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include <future>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include "driver_monitor.hpp"
+#include "work_stealing_pool.hpp"
+#include "live_config.hpp"
+
+// 多路监测引擎配置
+struct EngineConfig {
+    int worker_threads = 0;                          // 工作线程数 (<=0 表示使用硬件并发数)
+    double target_fps = 30.0;                        // 每路采集目标帧率
+    double detection_scale = 1.0;                    // 人脸检测缩放比例
+    FaceDetectorConfig detector;                     // 人脸检测后端
+    TrackingConfig tracking;                         // 人脸跟踪配置
+    MotionGateConfig motion_gate;                    // 运动门控配置
+    DriverRoiConfig driver_roi;                      // 驾驶员区域配置（自动模式下每路各自学习）
+    PipelineConfig pipeline;                         // 每路队列容量和丢帧策略
+    DetectionThresholds thresholds;                  // 行为判定阈值
+    FeatureRecorderConfig features;                  // 每路每帧特征记录
+};
+
+// 单路视频流统计
+struct StreamStats {
+    int stream_id = -1;                              // 视频流编号
+    std::string name;                                // 视频流名称
+    uint64_t frames_captured = 0;                    // 已采集帧数
+    uint64_t frames_processed = 0;                   // 已处理帧数
+    uint64_t frames_dropped = 0;                     // 丢弃帧数
+    uint64_t detector_invocations = 0;               // 完整人脸检测次数
+    uint64_t frames_reused = 0;                      // 运动门控复用上一次特征点的帧数
+    uint64_t bytes_copied = 0;                       // 复制或重新分配的像素字节数
+    uint64_t features_dropped = 0;                   // 特征记录队列满而丢弃的行数
+    double fps = 0.0;                                // 平均处理帧率
+    DriverBehavior behavior = DriverBehavior::NORMAL; // 当前行为
+    bool finished = false;                           // 回放是否已处理完毕
+};
+
+// 多路监测引擎
+// 所有视频流共享同一份只读的面部特征点模型（约100MB），在一个工作窃取线程池上并行处理；
+// 每路视频流的计数器、随机数、跟踪状态都保存在各自的上下文中。人脸检测器（HOG或DNN）不支持
+// 并发调用，每个工作线程持有一份检测器（只有几百KB的参数）
+class MonitorEngine {
+public:
+    MonitorEngine();
+    ~MonitorEngine();
+
+    // 在后台开始加载共享模型并创建线程池；模型加载与之后打开各路视频流同时进行，start时等待加载完成
+    bool initialize(const ShapeModelConfig& model, const EngineConfig& config);
+
+    // 添加一路视频流（需在start之前调用），返回视频流编号，失败返回-1
+    int addStream(const std::string& name, std::unique_ptr<FrameSource> source);
+
+    // 启动所有视频流（事件的stream_id为视频流编号；不同视频流的回调可能在不同工作线程上并发调用）
+    bool start(BehaviorCallback callback);
+
+    // 停止所有视频流
+    void stop();
+
+    // 所有回放视频流是否都已处理完毕
+    bool isFinished() const;
+
+    // 视频流数量
+    size_t getStreamCount() const;
+
+    // 获取某路视频流当前行为
+    DriverBehavior getCurrentBehavior(int stream_id) const;
+
+    // 获取各路视频流的统计
+    std::vector<StreamStats> getStats() const;
+
+    // 获取运行时长(秒)
+    double getElapsedSeconds() const;
+
+    // 获取启动耗时（帧源打开耗时为添加全部视频流所用的时间）
+    StartupStats getStartupStats() const;
+
+    // 运行中发布新的配置：目标帧率、人脸检测缩放比例和行为阈值在各路视频流处理下一帧前生效
+    void applyConfig(std::shared_ptr<const EngineConfig> config);
+
+private:
+    // 单路视频流上下文
+    struct StreamContext {
+        int id = -1;
+        std::string name;
+        std::unique_ptr<FrameSource> source;
+        FrameScheduler scheduler;
+        std::unique_ptr<SpscQueue<FramePacket>> queue;          // 采集 -> 处理（block）
+        std::unique_ptr<LatestSlot<FramePacket>> latest;        // 采集 -> 处理（drop_oldest）
+        std::unique_ptr<FramePool> framePool;
+        FaceTracker tracker;
+        PreparedFrame prepared;     // 当前帧的预处理缓存
+        MotionGate motion;          // 运动门控及其复用的上一次推理结果
+        dlib::rectangle lastFace;
+        dlib::full_object_detection lastShape;
+        BehaviorAnalyzer analyzer;
+        std::unique_ptr<FeatureRecorder> features;
+        std::thread captureThread;
+
+        // 保证同一路视频流同一时刻最多只有一个处理任务，帧按顺序处理
+        std::atomic<bool> scheduled{false};
+        std::atomic<bool> captureDone{false};
+        std::atomic<bool> finished{false};
+
+        // 当前行为
+        mutable std::mutex behaviorMutex;
+        DriverBehavior behavior = DriverBehavior::NORMAL;
+
+        // 统计
+        std::atomic<uint64_t> framesCaptured{0};
+        std::atomic<uint64_t> framesProcessed{0};
+        std::atomic<uint64_t> framesDropped{0};
+        std::atomic<uint64_t> detectorInvocations{0};
+        std::atomic<uint64_t> framesReused{0};
+
+        // 已应用的配置版本（采集线程、处理任务各自一份）
+        uint64_t captureConfigVersion = 0;
+        uint64_t processConfigVersion = 0;
+    };
+
+    // 采集线程：按帧率读取图像放入该路视频流的队列
+    void captureLoop(StreamContext& stream);
+
+    // 该路视频流是否还有未处理的帧
+    static bool hasPendingFrame(const StreamContext& stream);
+
+    // 如果该路视频流没有正在排队或执行的处理任务，则提交一个
+    void scheduleStream(StreamContext& stream);
+
+    // 处理任务：在工作线程上处理该路视频流的一帧
+    void processStream(StreamContext& stream);
+
+    // 当前工作线程的人脸检测器
+    FaceDetector& workerDetector();
+
+    // 等待后台模型加载完成
+    bool waitForModel();
+
+private:
+    EngineConfig _config;
+
+    // 所有视频流共享的只读特征点模型
+    std::shared_ptr<const LandmarkPredictor> _landmarkPredictor;
+    std::future<std::shared_ptr<const LandmarkPredictor>> _modelLoading;
+    ShapeModelLoadInfo _modelInfo;
+
+    // 每个工作线程一份人脸检测器
+    std::vector<std::unique_ptr<FaceDetector>> _workerDetectors;
+    std::vector<uint64_t> _workerConfigVersions;
+
+    // 运行中发布的配置
+    LiveConfig<EngineConfig> _liveConfig;
+
+    std::unique_ptr<WorkStealingPool> _pool;
+    std::vector<std::unique_ptr<StreamContext>> _streams;
+
+    std::atomic<bool> _running;
+    BehaviorCallback _callback;
+    std::chrono::steady_clock::time_point _startTime;
+    std::atomic<int64_t> _elapsedNanos;
+
+    // 启动耗时
+    std::chrono::steady_clock::time_point _initStartTime;
+    std::atomic<int64_t> _sourcesOpenedNanos;
+    std::atomic<int64_t> _firstDetectionNanos;
+};
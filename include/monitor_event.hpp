@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "driver_behavior.hpp"
+#include "frame_pool.hpp"
+
+// 行为事件：检测到行为变化时由监测线程产生，交给回调和事件订阅者
+struct MonitorEvent {
+    int stream_id = 0;                                  // 视频流编号（单路监测为0）
+    uint64_t sequence = 0;                              // 帧序号
+    DriverBehavior behavior = DriverBehavior::NORMAL;   // 行为类型
+    std::string message;                                // 提示信息
+    FrameHandle frame;                                  // 事件发生时的标注图像（共享缓冲，只读）
+    bool has_face = false;                              // 是否检测到人脸
+    cv::Rect face;                                      // 人脸框（原始分辨率）
+    std::chrono::system_clock::time_point timestamp;    // 检测到行为的时间
+};
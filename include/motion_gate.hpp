@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <opencv2/opencv.hpp>
+#include <dlib/image_processing.h>
+#include "prepared_frame.hpp"
+
+// 运动门控配置
+struct MotionGateConfig {
+    bool enabled = false;           // 是否在画面几乎不变时复用上一次的特征点
+    double face_threshold = 3.0;    // 人脸区域缩略图的平均每像素灰度差低于该值视为未变化
+    double eye_threshold = 2.0;     // 眼部区域缩略图的平均每像素灰度差低于该值视为未变化
+    int max_skip_frames = 3;        // 最多连续复用的帧数，之后强制完整推理
+};
+
+// 运动门控：判断本帧人脸区域相对上一次完整推理的帧是否几乎没有变化
+//
+// 完整推理后记录人脸框和眼部区域（由特征点求出）的16x16灰度缩略图；之后每帧只把这两块区域
+// 缩小成同样的缩略图，用SIMD求绝对差之和。两块区域都低于阈值时本帧可以复用上一次的人脸框和特征点，
+// 跳过人脸检测和特征点回归，分类阶段照常逐帧推进连续帧计数器。
+//
+// 闭眼计时的安全性：
+// - 眼睑动作在整张人脸的缩略图上变化很小，因此眼部区域单独比较，阈值更低
+// - 参考缩略图只在完整推理时更新，缓慢的变化会累积到超过阈值，不会一直被复用
+// - 连续复用不超过 max_skip_frames 帧，闭眼开始到被检出最多延迟这么多帧；
+//   闭眼后保持不动时复用的特征点仍是闭眼状态，计数器照常累加，报警时刻不变
+//
+// 不支持并发调用，每个推理线程（或每路视频流）持有一份
+class MotionGate {
+public:
+    static constexpr int kThumbnailSize = 16;
+    static constexpr size_t kThumbnailPixels = kThumbnailSize * kThumbnailSize;
+
+    explicit MotionGate(const MotionGateConfig& config = MotionGateConfig());
+
+    // 设置配置（会丢弃参考缩略图）
+    void setConfig(const MotionGateConfig& config);
+
+    // 获取配置
+    const MotionGateConfig& getConfig() const;
+
+    // 本帧是否可以复用上一次完整推理的结果
+    bool unchanged(PreparedFrame& frame);
+
+    // 完整推理得到人脸和特征点后，以本帧为新的参考
+    void update(PreparedFrame& frame, const dlib::rectangle& face, const dlib::full_object_detection& shape);
+
+    // 丢失人脸或重新开始，下一帧必须完整推理
+    void reset();
+
+    // 最近一次比较的人脸区域平均每像素灰度差
+    double getLastDifference() const;
+
+    // 两段字节的绝对差之和
+    static uint32_t sumAbsDiff(const uint8_t* a, const uint8_t* b, size_t length);
+
+private:
+    // 把帧中的区域缩小为灰度缩略图，区域与图像不相交时返回false。
+    // 本帧已有灰度图时直接从灰度图上缩小，否则只转换区域内的像素（不为此生成整帧灰度图）
+    bool thumbnail(PreparedFrame& frame, const dlib::rectangle& roi, uint8_t* out);
+
+    // 由特征点求眼部区域（68点模型的36~47号点），特征点不足时取人脸框的上半部分
+    static dlib::rectangle eyeRegion(const dlib::rectangle& face, const dlib::full_object_detection& shape);
+
+    MotionGateConfig _config;
+    bool _valid;
+    int _skipped;
+    double _lastDifference;
+
+    dlib::rectangle _faceRoi;
+    dlib::rectangle _eyeRoi;
+
+    alignas(16) uint8_t _faceRef[kThumbnailPixels];
+    alignas(16) uint8_t _eyeRef[kThumbnailPixels];
+    alignas(16) uint8_t _current[kThumbnailPixels];
+    cv::Mat _small;                 // 彩色图像的缩略图（转灰度前）
+};
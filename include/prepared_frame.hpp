@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// 一帧图像的预处理缓存
+//
+// 同一帧的各个使用者（人脸检测、相关滤波跟踪、驾驶员区域、运动门控）需要的灰度图和
+// 缩小图在第一次使用时生成，本帧内后续使用直接复用，不再重复转换。
+// - 灰度转换和缩小使用OpenCV的实现（cvtColor/resize 内部按平台使用SSE/AVX/NEON向量化）
+// - 缩小图按请求的缩放比例缓存，组成本帧的缩小金字塔；灰度缩小图都由全分辨率灰度图直接缩小，
+//   与单独转换的结果完全一致
+// - 换帧时只把缓存标记为失效，缓冲保留，分辨率不变时稳定运行不分配内存；
+//   缩放比例改变（配置热加载）后不再使用的缩小图在请求新比例时释放
+//
+// 只引用输入图像，不复制像素；调用方保证本帧处理期间图像不变。
+// 不支持并发访问，每个推理线程（或每路视频流）持有一份
+class PreparedFrame {
+public:
+    PreparedFrame() = default;
+
+    PreparedFrame(const PreparedFrame&) = delete;
+    PreparedFrame& operator=(const PreparedFrame&) = delete;
+
+    // 开始新的一帧（BGR或灰度图像），之前的缓存全部失效
+    void reset(const cv::Mat& image);
+
+    // 以另一帧中的一块区域作为本帧（不复制像素）。灰度图优先截取parent已经生成的整帧灰度图，
+    // 否则只转换区域内的像素；parent在本帧处理期间必须保持有效
+    void reset(PreparedFrame& parent, const cv::Rect& roi);
+
+    // 原始图像
+    const cv::Mat& image() const { return _image; }
+    bool empty() const { return _image.empty(); }
+    int channels() const { return _image.channels(); }
+    cv::Size size() const { return _image.size(); }
+
+    // 全分辨率灰度图（输入本身是灰度图时直接返回输入）
+    const cv::Mat& gray();
+
+    // 本帧的全分辨率灰度图是否已经可用（不会触发转换）
+    bool hasGray() const { return _image.channels() != 3 || _grayValid; }
+
+    // 按比例缩小的灰度图，scale >= 1 时返回全分辨率灰度图
+    const cv::Mat& downscaledGray(double scale);
+
+    // 按比例缩小的原图（保持通道数），scale >= 1 时返回原图
+    const cv::Mat& downscaledImage(double scale);
+
+    // 本帧实际进行的转换次数（灰度、缩小各计一次）
+    int conversions() const { return _conversions; }
+
+private:
+    // 缓存的一层缩小图
+    struct Level {
+        double scale = 1.0;
+        bool color = false;
+        bool valid = false;
+        cv::Mat image;
+    };
+
+    // 查找或创建指定比例和类型的缩小图缓存，创建时丢弃本帧未使用的其他比例的缓存
+    Level& level(double scale, bool color);
+
+    cv::Mat _image;
+    cv::Mat _gray;                  // 返回的灰度图（自己的缓冲或parent灰度图的一块区域）
+    cv::Mat _grayBuffer;
+    PreparedFrame* _parent = nullptr;
+    cv::Rect _roi;
+    bool _grayValid = false;
+    std::vector<Level> _levels;
+    int _conversions = 0;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <dlib/image_processing.h>
+
+// 特征点推理引擎
+enum class LandmarkEngine {
+    DLIB,            // dlib::shape_predictor
+    FLAT             // 直接在映射的展开缓存上推理（FlatShapePredictor）
+};
+
+// 面部特征点模型配置
+struct ShapeModelConfig {
+    std::string path = "shape_predictor_68_face_landmarks.dat"; // dlib训练得到的模型
+    std::string cache_path;          // 展开的模型缓存（为空时为 path + ".flat"）
+    bool build_cache = true;         // 缓存不存在或已过期时，加载dlib模型后写出缓存供下次启动使用
+    LandmarkEngine engine = LandmarkEngine::DLIB; // 特征点推理引擎
+
+    // 实际使用的缓存路径
+    std::string cachePath() const;
+};
+
+// 模型加载结果
+struct ShapeModelLoadInfo {
+    bool from_cache = false;         // 是否从展开缓存加载
+    bool cache_written = false;      // 本次是否新写出了缓存
+    double load_ms = 0.0;            // 加载耗时(毫秒)
+    std::string source;              // 实际读取的文件
+    LandmarkEngine engine = LandmarkEngine::DLIB; // 实际使用的推理引擎
+};
+
+// 展开缓存的文件头（小端，按实际内存布局写出，映射后直接使用）
+struct FlatShapeModelHeader {
+    char magic[8];                   // "DMSERT01"
+    uint32_t version;                // 格式版本
+    uint32_t header_bytes;           // 文件头大小
+    uint32_t num_landmarks;          // 特征点数
+    uint32_t num_cascades;           // 级联层数
+    uint32_t trees_per_cascade;      // 每层回归树数
+    uint32_t tree_depth;             // 树深度（每棵树 2^depth-1 个分裂节点、2^depth 个叶子）
+    uint32_t pixels_per_cascade;     // 每层采样的像素数
+    uint32_t reserved;
+    uint64_t source_bytes;           // 生成缓存的dlib模型文件大小
+    int64_t source_mtime;            // 生成缓存的dlib模型文件修改时间（用于判断缓存是否过期）
+    uint64_t initial_shape_offset;   // float[2*L]           平均形状
+    uint64_t anchors_offset;         // uint32[C][P]         采样点的锚点特征点
+    uint64_t deltas_offset;          // float[C][P][2]       采样点相对锚点的偏移
+    uint64_t splits_offset;          // FlatSplit[C][T][2^d-1] 分裂节点
+    uint64_t leaves_offset;          // float[C][T][2^d][2*L] 叶子上的形状增量
+    uint64_t file_bytes;             // 文件总大小
+    uint64_t checksum;               // 文件头之后全部内容的校验和（映射时校验）
+};
+
+// 分裂节点：比较两个采样像素的灰度差
+struct FlatSplit {
+    uint32_t idx1;
+    uint32_t idx2;
+    float thresh;
+};
+
+// 展开的面部特征点模型（级联回归树）
+//
+// dlib的 .dat 模型是逐个元素的变长编码，68点模型约100MB，每次启动解析需要数秒。
+// 这里把同一个模型一次性转换为定长数组连续存放的二进制文件，启动时只读映射（mmap）后校验文件头和内容校验和即可使用，
+// 同一台机器上的多个进程共享页缓存中的同一份只读数据
+class FlatShapeModel {
+public:
+    ~FlatShapeModel();
+
+    FlatShapeModel(const FlatShapeModel&) = delete;
+    FlatShapeModel& operator=(const FlatShapeModel&) = delete;
+
+    // 只读映射展开缓存并校验，失败时返回空指针并给出原因
+    static std::shared_ptr<const FlatShapeModel> map(const std::string& path, std::string& error);
+
+    // 把dlib模型转换为展开缓存（先写临时文件再改名，不会留下写了一半的缓存）
+    static bool convert(const std::string& dat_path, const std::string& flat_path, std::string& error);
+
+    // 按配置加载dlib预测器：缓存有效时从缓存构建，否则解析dlib模型（并按配置写出缓存）
+    static bool loadPredictor(const ShapeModelConfig& config, dlib::shape_predictor& predictor,
+                              ShapeModelLoadInfo& info);
+
+    // 按配置映射展开缓存：缓存无效或已过期时先由dlib模型生成（需要开启build_cache），失败时返回空指针
+    static std::shared_ptr<const FlatShapeModel> load(const ShapeModelConfig& config, ShapeModelLoadInfo& info);
+
+    // 推理引擎与字符串互相转换
+    static LandmarkEngine stringToEngine(const std::string& engine_str);
+    static std::string engineToString(LandmarkEngine engine);
+
+    // 由展开的数据构建dlib预测器
+    void toPredictor(dlib::shape_predictor& predictor) const;
+
+    // 模型结构
+    const FlatShapeModelHeader& header() const { return *_header; }
+    uint32_t numLandmarks() const { return _header->num_landmarks; }
+    uint32_t numCascades() const { return _header->num_cascades; }
+    uint32_t treesPerCascade() const { return _header->trees_per_cascade; }
+    uint32_t treeDepth() const { return _header->tree_depth; }
+    uint32_t splitsPerTree() const { return (1u << _header->tree_depth) - 1; }
+    uint32_t leavesPerTree() const { return 1u << _header->tree_depth; }
+    uint32_t pixelsPerCascade() const { return _header->pixels_per_cascade; }
+
+    // 映射内存中的各段数据（只读）
+    const float* initialShape() const;
+    const uint32_t* anchors(uint32_t cascade) const;
+    const float* deltas(uint32_t cascade) const;
+    const FlatSplit* splits(uint32_t cascade, uint32_t tree) const;
+    const float* leaves(uint32_t cascade, uint32_t tree) const;
+
+    // 映射的字节数
+    size_t mappedBytes() const { return _size; }
+
+private:
+    FlatShapeModel(const uint8_t* data, size_t size);
+
+    const uint8_t* _data;
+    size_t _size;
+    const FlatShapeModelHeader* _header;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// 有界单生产者/单消费者无锁环形队列
+// 只允许一个线程调用push系列函数、一个线程调用pop系列函数
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : _buffer(capacity > 0 ? capacity : 1),
+          _capacity(capacity > 0 ? capacity : 1),
+          _head(0),
+          _tail(0) {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 入队（生产者线程），队列已满时返回false且不修改item
+    bool tryPush(T&& item) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= _capacity) {
+            return false;
+        }
+        _buffer[head % _capacity] = std::move(item);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 出队（消费者线程），队列为空时返回false
+    bool tryPop(T& item) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(_buffer[tail % _capacity]);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 当前元素个数（近似值，仅用于统计）
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+private:
+    std::vector<T> _buffer;
+    const size_t _capacity;
+
+    // 生产者和消费者的索引分别放在独立的缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> _head;   // 下一个写入位置（只由生产者修改）
+    alignas(64) std::atomic<size_t> _tail;   // 下一个读取位置（只由消费者修改）
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "work_stealing_pool.hpp"
+
+// 参与扫描的检测器
+enum class SweepDetector {
+    EYES_CLOSED,    // EAR低于阈值的连续帧数
+    YAWNING         // MAR高于阈值的连续帧数
+};
+
+// 一段连续的特征序列（一个特征文件），计数器在序列之间清零
+struct SweepSeries {
+    std::vector<float> value;        // 每帧的EAR或MAR
+    std::vector<uint8_t> has_face;   // 是否检测到人脸（未检测到人脸的帧不更新计数器，判定为正常）
+    std::vector<uint8_t> label;      // 标注：该帧是否处于该行为中
+};
+
+// 一组阈值的扫描结果
+struct SweepResult {
+    double threshold = 0.0;          // EAR/MAR阈值
+    int frames = 0;                  // 连续帧数阈值
+    uint64_t alerts = 0;             // 告警次数（判定从正常变为该行为的次数，与事件数一致）
+    uint64_t flagged_frames = 0;     // 判定为该行为的帧数
+    uint64_t true_positive = 0;      // 判定且标注的帧数
+    uint64_t false_positive = 0;     // 判定但未标注的帧数
+    uint64_t false_negative = 0;     // 标注但未判定的帧数
+    uint64_t labelled_events = 0;    // 标注的行为段数
+    uint64_t detected_events = 0;    // 至少有一帧被判定的标注段数
+
+    double precision() const;
+    double recall() const;
+    double f1() const;
+    double eventRecall() const;
+};
+
+// 离线阈值扫描
+//
+// 在记录的特征序列上重放BehaviorAnalyzer中闭眼/哈欠的连续帧计数逻辑，一次评估大量阈值组合。
+// 计数器的值只取决于EAR/MAR阈值，与连续帧数阈值无关：每个任务负责一组相邻的EAR/MAR阈值，
+// 逐帧用无分支的循环同时更新这一组计数器，再与所有连续帧数阈值比较并累计，内层循环可被编译器向量化；
+// 各组阈值作为独立任务在线程池上并行
+class ThresholdSweep {
+public:
+    // 按[from, to]和步长生成取值
+    static std::vector<double> range(double from, double to, double step);
+
+    // 对thresholds × frame_counts的所有组合求结果（按阈值、帧数顺序排列）
+    static std::vector<SweepResult> run(SweepDetector detector,
+                                        const std::vector<SweepSeries>& series,
+                                        const std::vector<double>& thresholds,
+                                        const std::vector<int>& frame_counts,
+                                        WorkStealingPool& pool);
+};
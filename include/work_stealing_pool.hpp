@@ -0,0 +1,73 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+// 工作窃取线程池
+// 每个工作线程有自己的任务队列：工作线程内部提交的任务放入自己队列的尾部并优先执行（LIFO，
+// 缓存友好），外部提交的任务轮流分配给各工作线程；自己的队列为空时从其他线程队列的头部窃取
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // thread_count <= 0 时使用硬件并发数
+    explicit WorkStealingPool(int thread_count = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // 提交任务
+    void submit(Task task);
+
+    // 等待所有已提交的任务执行完毕
+    void waitIdle();
+
+    // 停止线程池（未执行的任务被丢弃）
+    void shutdown();
+
+    // 工作线程数量
+    int size() const;
+
+    // 当前线程在线程池中的编号，不是工作线程时返回-1
+    static int currentWorkerIndex();
+
+    // 被窃取执行的任务数（统计用）
+    uint64_t getStealCount() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // 工作线程函数
+    void workerLoop(int index);
+
+    // 从自己的队列尾部取任务
+    bool popLocal(int index, Task& task);
+
+    // 从其他工作线程队列的头部窃取任务
+    bool steal(int index, Task& task);
+
+private:
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<bool> _stopping;
+    std::atomic<size_t> _nextQueue;
+    std::atomic<uint64_t> _stealCount;
+
+    // 空闲等待和waitIdle使用
+    std::mutex _idleMutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _allIdle;
+    size_t _pendingTasks;                // 已提交但尚未执行完的任务数
+    std::atomic<size_t> _queuedTasks;    // 仍在队列中等待执行的任务数
+};
@@ -0,0 +1,169 @@
+#include "../include/behavior_analyzer.hpp"
+#include <algorithm>
+#include <cmath>
+
+BehaviorAnalyzer::BehaviorAnalyzer(uint32_t seed, const DetectionThresholds& thresholds)
+    : _thresholds(thresholds),
+      _rng(seed),
+      _percent(0, 99),
+      _eyeClosedCounter(0),
+      _yawningCounter(0),
+      _drinkingCounter(0),
+      _phoneCallingCounter(0) {
+}
+
+void BehaviorAnalyzer::setThresholds(const DetectionThresholds& thresholds) {
+    _thresholds = thresholds;
+}
+
+const DetectionThresholds& BehaviorAnalyzer::getThresholds() const {
+    return _thresholds;
+}
+
+DriverBehavior BehaviorAnalyzer::analyze(const cv::Mat& frame, const dlib::full_object_detection& shape) {
+    // 特征点复制一次，一次算出EAR/MAR/侧倾角等几何特征
+    LandmarkFeatures features = LandmarkFeatureKernel::compute(shape);
+    _features.face_size = features.face_size;
+    
+    // 检测各种行为
+    bool eyesClosed = detectEyesClosed(features);
+    bool yawning = detectYawning(features);
+    bool drinking = detectDrinking(frame);
+    bool phoneCalling = detectPhoneCalling(frame, features);
+    
+    // 根据检测结果更新行为状态
+    if (phoneCalling) {
+        return DriverBehavior::PHONE_CALLING;
+    } else if (drinking) {
+        return DriverBehavior::DRINKING;
+    } else if (eyesClosed) {
+        return DriverBehavior::EYES_CLOSED;
+    } else if (yawning) {
+        return DriverBehavior::YAWNING;
+    }
+    return DriverBehavior::NORMAL;
+}
+
+void BehaviorAnalyzer::reset() {
+    _eyeClosedCounter = 0;
+    _yawningCounter = 0;
+    _drinkingCounter = 0;
+    _phoneCallingCounter = 0;
+    _features = FrameFeatures();
+}
+
+const FrameFeatures& BehaviorAnalyzer::getLastFeatures() const {
+    return _features;
+}
+
+int BehaviorAnalyzer::randomPercent() {
+    return _percent(_rng);
+}
+
+bool BehaviorAnalyzer::detectEyesClosed(const LandmarkFeatures& features) {
+    // 左右眼EAR的平均值
+    double avgEAR = features.ear;
+    _features.ear = avgEAR;
+    
+    // 判断是否闭眼
+    if (avgEAR < _thresholds.ear_threshold) {
+        _eyeClosedCounter++;
+    } else {
+        _eyeClosedCounter = 0;
+    }
+    
+    // 连续多帧检测到闭眼才判定为闭眼状态
+    return _eyeClosedCounter >= _thresholds.eye_closed_frames;
+}
+
+bool BehaviorAnalyzer::detectYawning(const LandmarkFeatures& features) {
+    // 嘴部纵横比
+    double mar = features.mar;
+    _features.mar = mar;
+    
+    // 判断是否打哈欠
+    if (mar > _thresholds.mar_threshold) {
+        _yawningCounter++;
+    } else {
+        _yawningCounter = 0;
+    }
+    
+    // 连续多帧检测到嘴巴张开才判定为打哈欠
+    return _yawningCounter >= _thresholds.yawning_frames;
+}
+
+bool BehaviorAnalyzer::detectDrinking(const cv::Mat& frame) {
+    // 简化实现：基于手部检测和姿势估计
+    // 实际应用中应使用更复杂的手部检测和姿势识别算法
+    
+    // 这里使用简单的颜色检测和运动检测来模拟
+    // 在实际应用中，应该使用更高级的方法，如目标检测网络(YOLO, SSD等)
+    
+    // 简单模拟：随机概率触发，实际应用中替换为真实检测逻辑
+    if (randomPercent() < 5) {  // 5%的概率触发
+        _drinkingCounter++;
+    } else {
+        _drinkingCounter = std::max(0, _drinkingCounter - 1);
+    }
+    
+    return _drinkingCounter > _thresholds.drinking_frames;
+}
+
+bool BehaviorAnalyzer::detectPhoneCalling(const cv::Mat& frame, const LandmarkFeatures& features) {
+    // 简化实现：基于手部位置和头部姿势
+    // 实际应用中应使用更复杂的手部检测和姿势识别算法
+    
+    // 检测头部倾斜和手部靠近耳朵的姿势
+    // 这里使用简单的启发式方法模拟
+    
+    // 检查头部是否倾斜
+    double roll = features.head_roll;
+    _features.head_roll = roll;
+    double eyeAngle = std::abs(roll);
+    
+    // 简单模拟：随机概率触发，实际应用中替换为真实检测逻辑
+    if (eyeAngle > 10 || randomPercent() < 3) {  // 头部倾斜或3%的概率触发
+        _phoneCallingCounter++;
+    } else {
+        _phoneCallingCounter = std::max(0, _phoneCallingCounter - 1);
+    }
+    
+    return _phoneCallingCounter > _thresholds.phone_calling_frames;
+}
+
+double BehaviorAnalyzer::calculateEAR(const std::vector<dlib::point>& eye) {
+    // 计算眼睛纵横比 (Eye Aspect Ratio)
+    // EAR = (||p2-p6|| + ||p3-p5||) / (2 * ||p1-p4||)
+    double a = std::sqrt(std::pow(eye[1].x() - eye[5].x(), 2) + std::pow(eye[1].y() - eye[5].y(), 2));
+    double b = std::sqrt(std::pow(eye[2].x() - eye[4].x(), 2) + std::pow(eye[2].y() - eye[4].y(), 2));
+    double c = std::sqrt(std::pow(eye[0].x() - eye[3].x(), 2) + std::pow(eye[0].y() - eye[3].y(), 2));
+    
+    // 避免除零错误
+    if (c < 0.1) {
+        return 0.0;
+    }
+    
+    return (a + b) / (2.0 * c);
+}
+
+double BehaviorAnalyzer::calculateMAR(const dlib::full_object_detection& shape) {
+    // 计算嘴部纵横比 (Mouth Aspect Ratio)
+    // 使用嘴部的6个关键点 (48, 54, 51, 57, 62, 66)
+    
+    // 计算嘴部高度
+    double h1 = std::sqrt(std::pow(shape.part(51).x() - shape.part(57).x(), 2) + 
+                         std::pow(shape.part(51).y() - shape.part(57).y(), 2));
+    double h2 = std::sqrt(std::pow(shape.part(62).x() - shape.part(66).x(), 2) + 
+                         std::pow(shape.part(62).y() - shape.part(66).y(), 2));
+    
+    // 计算嘴部宽度
+    double w = std::sqrt(std::pow(shape.part(48).x() - shape.part(54).x(), 2) + 
+                        std::pow(shape.part(48).y() - shape.part(54).y(), 2));
+    
+    // 避免除零错误
+    if (w < 0.1) {
+        return 0.0;
+    }
+    
+    return (h1 + h2) / (2.0 * w);
+}
@@ -0,0 +1,310 @@
+#include "../include/clip_recorder.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+// 使用C++17的文件系统库
+namespace fs = std::filesystem;
+
+ClipRecorder::ClipRecorder(const ClipConfig& config)
+    : _config(config),
+      _running(false),
+      _bufferBytes(0),
+      _writerStopping(false),
+      _framesBuffered(0),
+      _framesDropped(0),
+      _clipsWritten(0),
+      _clipsFailed(0) {
+    _config.scale = std::min(1.0, std::max(0.1, _config.scale));
+    _config.jpeg_quality = std::min(100, std::max(1, _config.jpeg_quality));
+    _config.pre_seconds = std::max(0.0, _config.pre_seconds);
+    _config.post_seconds = std::max(0.0, _config.post_seconds);
+}
+
+ClipRecorder::~ClipRecorder() {
+    stop();
+}
+
+bool ClipRecorder::start() {
+    if (!_config.enabled || _running) {
+        return false;
+    }
+
+    try {
+        fs::create_directories(_config.dir);
+    } catch (const std::exception& e) {
+        std::cerr << "创建片段目录失败: " << _config.dir << " - " << e.what() << std::endl;
+        return false;
+    }
+
+    // 输入队列只缓冲很少的帧：压缩线程跟不上时直接丢帧，而不是占住帧缓冲池
+    _input = std::make_unique<SpscQueue<PendingFrame>>(8);
+    _writerStopping = false;
+    _running = true;
+    _compressThread = std::thread(&ClipRecorder::compressLoop, this);
+    _writeThread = std::thread(&ClipRecorder::writeLoop, this);
+
+    std::cout << "事件片段录制已启动，片段目录: " << _config.dir << std::endl;
+    return true;
+}
+
+void ClipRecorder::stop() {
+    if (!_running) {
+        return;
+    }
+
+    _running = false;
+    if (_compressThread.joinable()) {
+        _compressThread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _writerStopping = true;
+    }
+    _jobAvailable.notify_all();
+    if (_writeThread.joinable()) {
+        _writeThread.join();
+    }
+}
+
+void ClipRecorder::onFrame(const FrameHandle& frame) {
+    if (!_running || frame.empty()) {
+        return;
+    }
+
+    PendingFrame pending;
+    pending.frame = frame;
+    pending.time = std::chrono::system_clock::now();
+    if (!_input->tryPush(std::move(pending))) {
+        _framesDropped++;
+    }
+}
+
+std::string ClipRecorder::requestClip(const MonitorEvent& event) {
+    if (!_running || _config.behaviors.count(event.behavior) == 0) {
+        return "";
+    }
+
+    // 文件名：行为_日期_时间_毫秒.avi
+    auto time_t_event = std::chrono::system_clock::to_time_t(event.timestamp);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        event.timestamp.time_since_epoch()) % 1000;
+    std::stringstream ss;
+    ss << _config.dir << "/" << behaviorToKey(event.behavior);
+    if (event.stream_id > 0) {
+        ss << "_" << event.stream_id;
+    }
+    ss << "_" << std::put_time(std::localtime(&time_t_event), "%Y-%m-%d_%H-%M-%S")
+       << "." << std::setfill('0') << std::setw(3) << ms.count() << ".avi";
+
+    PendingClip clip;
+    clip.path = ss.str();
+    clip.begin = event.timestamp - std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::duration<double>(_config.pre_seconds));
+    clip.end = event.timestamp + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::duration<double>(_config.post_seconds));
+
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _pendingClips.push_back(clip);
+    return clip.path;
+}
+
+ClipStats ClipRecorder::getStats() const {
+    ClipStats stats;
+    stats.frames_buffered = _framesBuffered;
+    stats.frames_dropped = _framesDropped;
+    stats.clips_written = _clipsWritten;
+    stats.clips_failed = _clipsFailed;
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    stats.buffer_bytes = _bufferBytes;
+    stats.buffer_frames = _buffer.size();
+    return stats;
+}
+
+bool ClipRecorder::stringToBehavior(const std::string& behavior_str, DriverBehavior& behavior) {
+    if (behavior_str == "eyes_closed") {
+        behavior = DriverBehavior::EYES_CLOSED;
+    } else if (behavior_str == "yawning") {
+        behavior = DriverBehavior::YAWNING;
+    } else if (behavior_str == "drinking") {
+        behavior = DriverBehavior::DRINKING;
+    } else if (behavior_str == "phone_calling") {
+        behavior = DriverBehavior::PHONE_CALLING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string ClipRecorder::behaviorToKey(DriverBehavior behavior) {
+    switch (behavior) {
+        case DriverBehavior::NORMAL:
+            return "normal";
+        case DriverBehavior::EYES_CLOSED:
+            return "eyes_closed";
+        case DriverBehavior::YAWNING:
+            return "yawning";
+        case DriverBehavior::DRINKING:
+            return "drinking";
+        case DriverBehavior::PHONE_CALLING:
+            return "phone_calling";
+        default:
+            return "unknown";
+    }
+}
+
+void ClipRecorder::compressLoop() {
+    PendingFrame pending;
+    while (_running) {
+        if (!_input->tryPop(pending)) {
+            collectClips(std::chrono::system_clock::now(), false);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        compress(pending);
+        // 尽快释放帧缓冲
+        pending = PendingFrame();
+        collectClips(std::chrono::system_clock::now(), false);
+    }
+
+    // 停止时把队列中剩余的帧压缩完，未满时长的片段也写出
+    while (_input->tryPop(pending)) {
+        compress(pending);
+    }
+    pending = PendingFrame();
+    collectClips(std::chrono::system_clock::now(), true);
+}
+
+void ClipRecorder::compress(const PendingFrame& pending) {
+    // 压缩线程复用缩放缓冲
+    thread_local cv::Mat scaled;
+
+    const cv::Mat& image = pending.frame.image();
+    const cv::Mat* source = &image;
+    if (_config.scale < 1.0) {
+        cv::resize(image, scaled, cv::Size(), _config.scale, _config.scale, cv::INTER_AREA);
+        source = &scaled;
+    }
+
+    auto compressed = std::make_shared<CompressedFrame>();
+    compressed->time = pending.time;
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, _config.jpeg_quality};
+    if (!cv::imencode(".jpg", *source, compressed->jpeg, params)) {
+        return;
+    }
+    compressed->jpeg.shrink_to_fit();
+    _framesBuffered++;
+
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _bufferBytes += compressed->jpeg.size();
+    _buffer.push_back(std::move(compressed));
+
+    // 按时长和内存上限淘汰最早的帧：只需保留最长一个片段的时间跨度
+    auto keep = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::duration<double>(_config.pre_seconds + _config.post_seconds));
+    auto oldest_needed = pending.time - keep;
+    for (const auto& clip : _pendingClips) {
+        oldest_needed = std::min(oldest_needed, clip.begin);
+    }
+    while (_buffer.size() > 1 &&
+           (_buffer.front()->time < oldest_needed || _bufferBytes > _config.max_memory_bytes)) {
+        _bufferBytes -= _buffer.front()->jpeg.size();
+        _buffer.pop_front();
+    }
+}
+
+void ClipRecorder::collectClips(std::chrono::system_clock::time_point now, bool force) {
+    std::vector<ClipJob> ready;
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        for (auto it = _pendingClips.begin(); it != _pendingClips.end();) {
+            if (!force && now < it->end) {
+                ++it;
+                continue;
+            }
+            // 片段只引用缓存中的压缩帧，不复制数据
+            ClipJob job;
+            job.path = it->path;
+            for (const auto& frame : _buffer) {
+                if (frame->time >= it->begin && frame->time <= it->end) {
+                    job.frames.push_back(frame);
+                }
+            }
+            ready.push_back(std::move(job));
+            it = _pendingClips.erase(it);
+        }
+    }
+
+    if (ready.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        for (auto& job : ready) {
+            _jobs.push_back(std::move(job));
+        }
+    }
+    _jobAvailable.notify_one();
+}
+
+void ClipRecorder::writeLoop() {
+    while (true) {
+        ClipJob job;
+        {
+            std::unique_lock<std::mutex> lock(_jobMutex);
+            _jobAvailable.wait(lock, [this] { return !_jobs.empty() || _writerStopping; });
+            if (_jobs.empty()) {
+                break;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        if (writeClip(job)) {
+            _clipsWritten++;
+            std::cout << "保存事件片段: " << job.path << " (" << job.frames.size() << " 帧)" << std::endl;
+        } else {
+            _clipsFailed++;
+        }
+    }
+}
+
+bool ClipRecorder::writeClip(const ClipJob& job) {
+    if (job.frames.empty()) {
+        std::cerr << "事件片段没有可用的帧: " << job.path << std::endl;
+        return false;
+    }
+
+    // 按缓存帧的实际时间间隔计算帧率，回放速度与实际一致
+    double fps = 10.0;
+    if (job.frames.size() > 1) {
+        double span = std::chrono::duration<double>(job.frames.back()->time - job.frames.front()->time).count();
+        if (span > 0) {
+            fps = (job.frames.size() - 1) / span;
+        }
+    }
+
+    try {
+        cv::VideoWriter writer;
+        cv::Mat frame;
+        for (const auto& compressed : job.frames) {
+            frame = cv::imdecode(compressed->jpeg, cv::IMREAD_COLOR);
+            if (frame.empty()) {
+                continue;
+            }
+            if (!writer.isOpened() &&
+                !writer.open(job.path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, frame.size())) {
+                std::cerr << "无法创建事件片段: " << job.path << std::endl;
+                return false;
+            }
+            writer.write(frame);
+        }
+        return writer.isOpened();
+    } catch (const std::exception& e) {
+        std::cerr << "写出事件片段失败: " << e.what() << std::endl;
+        return false;
+    }
+}
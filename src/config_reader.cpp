@@ -1,4 +1,5 @@
 #include "../include/config_reader.hpp"
+#include "../include/dms_config.hpp"
 #include <iostream>
 #include <fstream>
 
@@ -12,6 +13,7 @@ bool ConfigReader::loadConfig() {
         // 打开配置文件
         std::ifstream file(_configFile);
         if (!file.is_open()) {
+            _loadError = "无法打开配置文件";
             std::cerr << "无法打开配置文件: " << _configFile << std::endl;
             return false;
         }
@@ -19,15 +21,255 @@ bool ConfigReader::loadConfig() {
         // 解析JSON
         file >> _config;
         file.close();
+        _loadError.clear();
         
         std::cout << "成功加载配置文件: " << _configFile << std::endl;
         return true;
     } catch (const std::exception& e) {
+        _loadError = e.what();
         std::cerr << "加载配置文件失败: " << e.what() << std::endl;
         return false;
     }
 }
 
+std::shared_ptr<const DmsConfig> ConfigReader::compile(std::vector<std::string>& errors) const {
+    if (!_loadError.empty()) {
+        errors.push_back(_configFile + ": " + _loadError);
+        return nullptr;
+    }
+    
+    auto config = std::make_shared<DmsConfig>();
+    if (!DmsConfig::fromJson(_config, *config, errors)) {
+        return nullptr;
+    }
+    return config;
+}
+
+std::string ConfigReader::getEvidenceMode() const {
+    try {
+        return _config.at("evidence").at("mode");
+    } catch (const std::exception& e) {
+        std::cerr << "获取证据图像保存方式失败: " << e.what() << std::endl;
+        return "full"; // 默认值
+    }
+}
+
+int ConfigReader::getEvidenceJpegQuality() const {
+    try {
+        return _config.at("evidence").at("jpeg_quality");
+    } catch (const std::exception& e) {
+        std::cerr << "获取证据图像JPEG质量失败: " << e.what() << std::endl;
+        return 95; // 默认值
+    }
+}
+
+int ConfigReader::getEvidenceThumbnailWidth() const {
+    try {
+        return _config.at("evidence").at("thumbnail_width");
+    } catch (const std::exception& e) {
+        std::cerr << "获取证据缩略图宽度失败: " << e.what() << std::endl;
+        return 320; // 默认值
+    }
+}
+
+double ConfigReader::getEvidenceRoiMargin() const {
+    try {
+        return _config.at("evidence").at("roi_margin");
+    } catch (const std::exception& e) {
+        std::cerr << "获取人脸区域扩展比例失败: " << e.what() << std::endl;
+        return 0.3; // 默认值
+    }
+}
+
+int ConfigReader::getEvidenceMaxDiskMB() const {
+    try {
+        return _config.at("evidence").at("max_disk_mb");
+    } catch (const std::exception& e) {
+        std::cerr << "获取证据图像磁盘配额失败: " << e.what() << std::endl;
+        return 0; // 默认值
+    }
+}
+
+int ConfigReader::getEvidenceEncoderThreads() const {
+    try {
+        return _config.at("evidence").at("encoder_threads");
+    } catch (const std::exception& e) {
+        std::cerr << "获取证据图像编码线程数失败: " << e.what() << std::endl;
+        return 2; // 默认值
+    }
+}
+
+int ConfigReader::getEvidenceMaxPending() const {
+    try {
+        return _config.at("evidence").at("max_pending");
+    } catch (const std::exception& e) {
+        std::cerr << "获取证据图像排队上限失败: " << e.what() << std::endl;
+        return 16; // 默认值
+    }
+}
+
+bool ConfigReader::isClipEnabled() const {
+    try {
+        return _config.at("clip").at("enabled");
+    } catch (const std::exception& e) {
+        std::cerr << "获取是否录制事件片段失败: " << e.what() << std::endl;
+        return false; // 默认值
+    }
+}
+
+std::string ConfigReader::getClipDir() const {
+    try {
+        return _config.at("clip").at("dir");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件片段目录失败: " << e.what() << std::endl;
+        return "clips"; // 默认值
+    }
+}
+
+double ConfigReader::getClipPreSeconds() const {
+    try {
+        return _config.at("clip").at("pre_seconds");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件前片段时长失败: " << e.what() << std::endl;
+        return 5.0; // 默认值
+    }
+}
+
+double ConfigReader::getClipPostSeconds() const {
+    try {
+        return _config.at("clip").at("post_seconds");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件后片段时长失败: " << e.what() << std::endl;
+        return 5.0; // 默认值
+    }
+}
+
+double ConfigReader::getClipScale() const {
+    try {
+        return _config.at("clip").at("scale");
+    } catch (const std::exception& e) {
+        std::cerr << "获取片段缩放比例失败: " << e.what() << std::endl;
+        return 0.5; // 默认值
+    }
+}
+
+int ConfigReader::getClipJpegQuality() const {
+    try {
+        return _config.at("clip").at("jpeg_quality");
+    } catch (const std::exception& e) {
+        std::cerr << "获取片段JPEG质量失败: " << e.what() << std::endl;
+        return 70; // 默认值
+    }
+}
+
+int ConfigReader::getClipMaxMemoryMB() const {
+    try {
+        return _config.at("clip").at("max_memory_mb");
+    } catch (const std::exception& e) {
+        std::cerr << "获取片段缓存内存上限失败: " << e.what() << std::endl;
+        return 64; // 默认值
+    }
+}
+
+std::vector<std::string> ConfigReader::getClipBehaviors() const {
+    try {
+        return _config.at("clip").at("behaviors").get<std::vector<std::string>>();
+    } catch (const std::exception& e) {
+        std::cerr << "获取片段行为列表失败: " << e.what() << std::endl;
+        return {"eyes_closed", "phone_calling"}; // 默认值
+    }
+}
+
+int ConfigReader::getEventRingCapacity() const {
+    try {
+        return _config.at("output").at("event_ring_capacity");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件缓存容量失败: " << e.what() << std::endl;
+        return 4096; // 默认值
+    }
+}
+
+int ConfigReader::getEventStoreSegmentMB() const {
+    try {
+        return _config.at("event_store").at("segment_mb");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件段文件大小上限失败: " << e.what() << std::endl;
+        return 4; // 默认值
+    }
+}
+
+int ConfigReader::getEventStoreSegmentSeconds() const {
+    try {
+        return _config.at("event_store").at("segment_seconds");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件段文件时间跨度失败: " << e.what() << std::endl;
+        return 3600; // 默认值
+    }
+}
+
+int ConfigReader::getEventStoreIndexInterval() const {
+    try {
+        return _config.at("event_store").at("index_interval");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件索引间隔失败: " << e.what() << std::endl;
+        return 64; // 默认值
+    }
+}
+
+bool ConfigReader::isEventStoreGroupCommit() const {
+    try {
+        return _config.at("event_store").at("group_commit");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件存储批量fsync设置失败: " << e.what() << std::endl;
+        return true; // 默认值
+    }
+}
+
+int ConfigReader::getEventStoreSyncIntervalMs() const {
+    try {
+        return _config.at("event_store").at("sync_interval_ms");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件存储fsync间隔失败: " << e.what() << std::endl;
+        return 1000; // 默认值
+    }
+}
+
+int ConfigReader::getEventStoreSyncBatch() const {
+    try {
+        return _config.at("event_store").at("sync_batch");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件存储fsync批量失败: " << e.what() << std::endl;
+        return 32; // 默认值
+    }
+}
+
+bool ConfigReader::isFeatureRecordingEnabled() const {
+    try {
+        return _config.at("features").at("enabled");
+    } catch (const std::exception& e) {
+        std::cerr << "获取特征记录设置失败: " << e.what() << std::endl;
+        return false; // 默认值
+    }
+}
+
+std::string ConfigReader::getFeatureDir() const {
+    try {
+        return _config.at("features").at("dir");
+    } catch (const std::exception& e) {
+        std::cerr << "获取特征文件目录失败: " << e.what() << std::endl;
+        return "features"; // 默认值
+    }
+}
+
+int ConfigReader::getFeatureBlockRows() const {
+    try {
+        return _config.at("features").at("block_rows");
+    } catch (const std::exception& e) {
+        std::cerr << "获取特征数据块行数失败: " << e.what() << std::endl;
+        return 1024; // 默认值
+    }
+}
+
 bool ConfigReader::reload() {
     return loadConfig();
 }
@@ -72,6 +314,124 @@ int ConfigReader::getCameraFps() const {
     }
 }
 
+std::string ConfigReader::getSourceType() const {
+    try {
+        return _config.at("source").at("type");
+    } catch (const std::exception& e) {
+        std::cerr << "获取帧源类型失败: " << e.what() << std::endl;
+        return "camera"; // 默认值
+    }
+}
+
+std::string ConfigReader::getSourcePath() const {
+    try {
+        return _config.at("source").at("path");
+    } catch (const std::exception& e) {
+        std::cerr << "获取帧源路径失败: " << e.what() << std::endl;
+        return ""; // 默认值
+    }
+}
+
+bool ConfigReader::isSourceLoop() const {
+    try {
+        return _config.at("source").at("loop");
+    } catch (const std::exception& e) {
+        std::cerr << "获取帧源是否循环失败: " << e.what() << std::endl;
+        return false; // 默认值
+    }
+}
+
+bool ConfigReader::isSourceAsFastAsPossible() const {
+    try {
+        return _config.at("source").at("as_fast_as_possible");
+    } catch (const std::exception& e) {
+        std::cerr << "获取帧源回放模式失败: " << e.what() << std::endl;
+        return false; // 默认值
+    }
+}
+
+int ConfigReader::getSyntheticFrames() const {
+    try {
+        return _config.at("source").at("synthetic_frames");
+    } catch (const std::exception& e) {
+        std::cerr << "获取合成帧数量失败: " << e.what() << std::endl;
+        return 0; // 默认值
+    }
+}
+
+int ConfigReader::getPipelineQueueCapacity() const {
+    try {
+        return _config.at("pipeline").at("queue_capacity");
+    } catch (const std::exception& e) {
+        std::cerr << "获取流水线队列容量失败: " << e.what() << std::endl;
+        return 4; // 默认值
+    }
+}
+
+std::string ConfigReader::getPipelineDropPolicy() const {
+    try {
+        return _config.at("pipeline").at("drop_policy");
+    } catch (const std::exception& e) {
+        std::cerr << "获取流水线丢帧策略失败: " << e.what() << std::endl;
+        return "drop_oldest"; // 默认值
+    }
+}
+
+int ConfigReader::getEngineWorkerThreads() const {
+    try {
+        return _config.at("engine").at("worker_threads");
+    } catch (const std::exception& e) {
+        std::cerr << "获取引擎工作线程数失败: " << e.what() << std::endl;
+        return 0; // 默认值
+    }
+}
+
+std::vector<FrameSourceConfig> ConfigReader::getEngineStreams() const {
+    std::vector<FrameSourceConfig> streams;
+    if (!_config.contains("engine") || !_config["engine"].contains("streams")) {
+        return streams;
+    }
+    try {
+        for (const auto& item : _config.at("engine").at("streams")) {
+            // 未指定的字段沿用摄像头和帧源的全局配置
+            FrameSourceConfig source;
+            source.name = item.value("name", "stream" + std::to_string(streams.size()));
+            source.type = FrameSource::stringToType(item.value("type", std::string("camera")));
+            source.device_id = item.value("device_id", 0);
+            source.path = item.value("path", std::string());
+            source.width = item.value("width", getCameraWidth());
+            source.height = item.value("height", getCameraHeight());
+            source.fps = item.value("fps", getCameraFps());
+            source.loop = item.value("loop", false);
+            source.as_fast_as_possible = item.value("as_fast_as_possible", false);
+            source.synthetic_frames = item.value("synthetic_frames", 0);
+            streams.push_back(source);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "获取视频流列表失败: " << e.what() << std::endl;
+        streams.clear();
+    }
+    return streams;
+}
+
+int ConfigReader::getDispatchQueueCapacity() const {
+    try {
+        return _config.at("dispatch").at("queue_capacity");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件队列容量失败: " << e.what() << std::endl;
+        return 64; // 默认值
+    }
+}
+
+std::string ConfigReader::getDispatchOverflowPolicy() const {
+    try {
+        return _config.at("dispatch").at("overflow_policy");
+    } catch (const std::exception& e) {
+        std::cerr << "获取事件队列溢出策略失败: " << e.what() << std::endl;
+        return "drop_oldest"; // 默认值
+    }
+}
+
 double ConfigReader::getEARThreshold() const {
     try {
         return _config["detection"]["ear_threshold"];
@@ -126,6 +486,51 @@ int ConfigReader::getPhoneCallingFrames() const {
     }
 }
 
+double ConfigReader::getDetectionScale() const {
+    try {
+        return _config.at("detection").at("detection_scale");
+    } catch (const std::exception& e) {
+        std::cerr << "获取人脸检测缩放比例失败: " << e.what() << std::endl;
+        return 1.0; // 默认值
+    }
+}
+
+std::string ConfigReader::getTrackingMode() const {
+    try {
+        return _config.at("tracking").at("mode");
+    } catch (const std::exception& e) {
+        std::cerr << "获取人脸跟踪模式失败: " << e.what() << std::endl;
+        return "off"; // 默认值
+    }
+}
+
+int ConfigReader::getTrackingRedetectInterval() const {
+    try {
+        return _config.at("tracking").at("redetect_interval");
+    } catch (const std::exception& e) {
+        std::cerr << "获取人脸检测间隔失败: " << e.what() << std::endl;
+        return 10; // 默认值
+    }
+}
+
+double ConfigReader::getTrackingMinIoU() const {
+    try {
+        return _config.at("tracking").at("min_iou");
+    } catch (const std::exception& e) {
+        std::cerr << "获取跟踪最小IoU失败: " << e.what() << std::endl;
+        return 0.5; // 默认值
+    }
+}
+
+double ConfigReader::getTrackingMinPSR() const {
+    try {
+        return _config.at("tracking").at("min_psr");
+    } catch (const std::exception& e) {
+        std::cerr << "获取跟踪最小峰值旁瓣比失败: " << e.what() << std::endl;
+        return 7.0; // 默认值
+    }
+}
+
 bool ConfigReader::isEnableSound() const {
     try {
         return _config["alert"]["enable_sound"];
@@ -0,0 +1,180 @@
+#include "../include/config_watcher.hpp"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+ConfigWatcher::ConfigWatcher(std::shared_ptr<ConfigReader> reader, std::shared_ptr<const DmsConfig> current)
+    : _reader(std::move(reader)),
+      _current(std::move(current)),
+      _running(false),
+      _inotifyFd(-1),
+      _watchFd(-1) {
+    fs::path path(_reader->getConfigFilePath());
+    _dir = path.has_parent_path() ? path.parent_path().string() : ".";
+    _filename = path.filename().string();
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::start(ReloadCallback callback) {
+    if (_running) {
+        return false;
+    }
+    _callback = callback;
+
+#ifdef __linux__
+    // 监视目录而不是文件：改名替换后原文件的watch会失效
+    _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotifyFd < 0) {
+        std::cerr << "无法创建inotify实例: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    _watchFd = inotify_add_watch(_inotifyFd, _dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (_watchFd < 0) {
+        std::cerr << "无法监视配置目录 " << _dir << ": " << std::strerror(errno) << std::endl;
+        close(_inotifyFd);
+        _inotifyFd = -1;
+        return false;
+    }
+#else
+    std::error_code ec;
+    _lastWrite = fs::last_write_time(_reader->getConfigFilePath(), ec);
+#endif
+
+    _running = true;
+    _thread = std::thread(&ConfigWatcher::watchLoop, this);
+    std::cout << "正在监视配置文件: " << _reader->getConfigFilePath() << std::endl;
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (!_running) {
+        return;
+    }
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+
+#ifdef __linux__
+    if (_inotifyFd >= 0) {
+        close(_inotifyFd);
+        _inotifyFd = -1;
+        _watchFd = -1;
+    }
+#endif
+}
+
+bool ConfigWatcher::reloadNow() {
+    // ConfigReader只在这里（监视线程）重新加载，解析失败时保留原来的JSON
+    _reader->reload();
+    std::vector<std::string> errors;
+    std::shared_ptr<const DmsConfig> next = _reader->compile(errors);
+
+    if (!next) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stats.rejected++;
+            _stats.last_errors = errors;
+        }
+        std::cerr << "配置重新加载失败，继续使用原配置:" << std::endl;
+        for (const auto& error : errors) {
+            std::cerr << "  " << error << std::endl;
+        }
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _current = next;
+        _stats.applied++;
+    }
+    std::cout << "配置已重新加载" << std::endl;
+    if (_callback) {
+        _callback(next);
+    }
+    return true;
+}
+
+std::shared_ptr<const DmsConfig> ConfigWatcher::current() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _current;
+}
+
+ConfigReloadStats ConfigWatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void ConfigWatcher::watchLoop() {
+    while (_running) {
+        if (!waitForChange(200)) {
+            continue;
+        }
+
+        // 编辑器保存时可能连续写多次，等文件稳定后再读取
+        int debounce_ms = current()->reload.debounce_ms;
+        while (_running && debounce_ms > 0 && waitForChange(debounce_ms)) {
+        }
+        if (!_running) {
+            break;
+        }
+        reloadNow();
+    }
+}
+
+bool ConfigWatcher::waitForChange(int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    bool changed = false;
+
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[4096];
+    while (_running && !changed) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            break;
+        }
+
+        // 分段等待，stop()时最多等待100ms
+        struct pollfd pfd = {_inotifyFd, POLLIN, 0};
+        int ready = poll(&pfd, 1, static_cast<int>(std::min<long long>(remaining, 100)));
+        if (ready <= 0) {
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(_inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length; ) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                if (event->len > 0 && _filename == event->name) {
+                    changed = true;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+#else
+    while (_running && !changed && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::error_code ec;
+        fs::file_time_type write_time = fs::last_write_time(_reader->getConfigFilePath(), ec);
+        if (!ec && write_time != _lastWrite) {
+            _lastWrite = write_time;
+            changed = true;
+        }
+    }
+#endif
+
+    return changed;
+}
@@ -0,0 +1,386 @@
+#include "../include/dms_config.hpp"
+#include <set>
+#include <sstream>
+#include <initializer_list>
+
+using json = nlohmann::json;
+
+namespace {
+
+// 按字段路径读取并校验JSON中的值，错误记录为 "路径: 原因"
+class FieldReader {
+public:
+    FieldReader(const json& root, std::vector<std::string>& errors, const std::string& prefix = "")
+        : _root(root), _errors(errors), _prefix(prefix) {
+    }
+
+    // 完整的字段路径
+    std::string fullPath(const std::string& path) const {
+        return _prefix.empty() ? path : _prefix + "." + path;
+    }
+
+    void fail(const std::string& path, const std::string& reason) {
+        _errors.push_back(fullPath(path) + ": " + reason);
+    }
+
+    // 查找字段（路径以'.'分隔），不存在时返回nullptr
+    const json* find(const std::string& path) {
+        const json* node = &_root;
+        std::stringstream ss(path);
+        std::string key;
+        std::string walked;
+        while (std::getline(ss, key, '.')) {
+            if (!node->is_object()) {
+                fail(walked, "应为JSON对象");
+                return nullptr;
+            }
+            auto it = node->find(key);
+            if (it == node->end()) {
+                return nullptr;
+            }
+            node = &(*it);
+            walked = walked.empty() ? key : walked + "." + key;
+        }
+        return node;
+    }
+
+    void readBool(const std::string& path, bool& out) {
+        const json* node = find(path);
+        if (!node) {
+            return;
+        }
+        if (!node->is_boolean()) {
+            fail(path, "应为true或false");
+            return;
+        }
+        out = node->get<bool>();
+    }
+
+    template <typename Int>
+    void readInt(const std::string& path, Int& out, long long min, long long max) {
+        const json* node = find(path);
+        if (!node) {
+            return;
+        }
+        if (!node->is_number_integer()) {
+            fail(path, "应为整数");
+            return;
+        }
+        long long value = node->get<long long>();
+        if (value < min || value > max) {
+            fail(path, "取值 " + std::to_string(value) + " 超出范围 [" +
+                 std::to_string(min) + ", " + std::to_string(max) + "]");
+            return;
+        }
+        out = static_cast<Int>(value);
+    }
+
+    void readDouble(const std::string& path, double& out, double min, double max) {
+        const json* node = find(path);
+        if (!node) {
+            return;
+        }
+        if (!node->is_number()) {
+            fail(path, "应为数值");
+            return;
+        }
+        double value = node->get<double>();
+        if (value < min || value > max) {
+            std::stringstream ss;
+            ss << "取值 " << value << " 超出范围 [" << min << ", " << max << "]";
+            fail(path, ss.str());
+            return;
+        }
+        out = value;
+    }
+
+    void readString(const std::string& path, std::string& out, bool allow_empty = true) {
+        const json* node = find(path);
+        if (!node) {
+            return;
+        }
+        if (!node->is_string()) {
+            fail(path, "应为字符串");
+            return;
+        }
+        std::string value = node->get<std::string>();
+        if (value.empty() && !allow_empty) {
+            fail(path, "不能为空");
+            return;
+        }
+        out = value;
+    }
+
+    // 读取取值限定在allowed中的字符串，未配置时返回false
+    bool readChoice(const std::string& path, std::string& out, std::initializer_list<const char*> allowed) {
+        const json* node = find(path);
+        if (!node) {
+            return false;
+        }
+        std::string joined;
+        for (const char* option : allowed) {
+            joined += joined.empty() ? option : std::string(" / ") + option;
+        }
+        if (!node->is_string()) {
+            fail(path, "应为字符串 (" + joined + ")");
+            return false;
+        }
+        std::string value = node->get<std::string>();
+        for (const char* option : allowed) {
+            if (value == option) {
+                out = value;
+                return true;
+            }
+        }
+        fail(path, "未知的取值 '" + value + "'，可选 " + joined);
+        return false;
+    }
+
+private:
+    const json& _root;
+    std::vector<std::string>& _errors;
+    std::string _prefix;
+};
+
+// 帧源字段（全局的camera/source和每路视频流共用）
+void readSourceFields(FieldReader& reader, const std::string& type_path, FrameSourceConfig& source) {
+    std::string type;
+    if (reader.readChoice(type_path, type, {"camera", "video", "images", "synthetic"})) {
+        source.type = FrameSource::stringToType(type);
+    }
+}
+
+void checkSourcePath(FieldReader& reader, const std::string& path_field, const FrameSourceConfig& source) {
+    if ((source.type == FrameSourceType::VIDEO_FILE || source.type == FrameSourceType::IMAGE_SEQUENCE) &&
+        source.path.empty()) {
+        reader.fail(path_field, "视频文件和图像序列帧源需要指定路径");
+    }
+}
+
+} // namespace
+
+EngineConfig DmsConfig::engineConfig() const {
+    EngineConfig config;
+    config.worker_threads = worker_threads;
+    config.target_fps = target_fps;
+    config.detection_scale = detection_scale;
+    config.detector = detector;
+    config.tracking = tracking;
+    config.motion_gate = motion_gate;
+    config.driver_roi = driver_roi;
+    config.pipeline = pipeline;
+    config.thresholds = thresholds;
+    config.features = features;
+    return config;
+}
+
+bool DmsConfig::fromJson(const json& root, DmsConfig& config, std::vector<std::string>& errors) {
+    size_t error_count = errors.size();
+    config = DmsConfig();
+    if (!root.is_object()) {
+        errors.push_back("(根): 配置文件应为JSON对象");
+        return false;
+    }
+    FieldReader r(root, errors);
+    std::string choice;
+
+    // 摄像头和帧源
+    r.readInt("camera.device_id", config.source.device_id, 0, 255);
+    r.readInt("camera.width", config.source.width, 16, 16384);
+    r.readInt("camera.height", config.source.height, 16, 16384);
+    r.readInt("camera.fps", config.source.fps, 1, 1000);
+    config.target_fps = config.source.fps;
+    readSourceFields(r, "source.type", config.source);
+    r.readString("source.path", config.source.path);
+    r.readBool("source.loop", config.source.loop);
+    r.readBool("source.as_fast_as_possible", config.source.as_fast_as_possible);
+    r.readInt("source.synthetic_frames", config.source.synthetic_frames, 0, 100000000);
+    checkSourcePath(r, "source.path", config.source);
+
+    // 流水线
+    r.readInt("pipeline.queue_capacity", config.pipeline.queue_capacity, 1, 1024);
+    if (r.readChoice("pipeline.drop_policy", choice, {"block", "drop_oldest"})) {
+        config.pipeline.drop_policy = DriverMonitor::stringToDropPolicy(choice);
+    }
+
+    // 多路监测：未指定的字段沿用摄像头和帧源的全局配置
+    r.readInt("engine.worker_threads", config.worker_threads, 0, 256);
+    if (const json* streams = r.find("engine.streams")) {
+        if (!streams->is_array()) {
+            r.fail("engine.streams", "应为数组");
+        } else {
+            std::set<std::string> names;
+            for (size_t i = 0; i < streams->size(); ++i) {
+                std::string prefix = r.fullPath("engine.streams[" + std::to_string(i) + "]");
+                const json& item = (*streams)[i];
+                if (!item.is_object()) {
+                    errors.push_back(prefix + ": 应为JSON对象");
+                    continue;
+                }
+                FieldReader s(item, errors, prefix);
+                FrameSourceConfig source;
+                source.name = "stream" + std::to_string(i);
+                source.width = config.source.width;
+                source.height = config.source.height;
+                source.fps = config.source.fps;
+                s.readString("name", source.name, false);
+                readSourceFields(s, "type", source);
+                s.readInt("device_id", source.device_id, 0, 255);
+                s.readString("path", source.path);
+                s.readInt("width", source.width, 16, 16384);
+                s.readInt("height", source.height, 16, 16384);
+                s.readInt("fps", source.fps, 1, 1000);
+                s.readBool("loop", source.loop);
+                s.readBool("as_fast_as_possible", source.as_fast_as_possible);
+                s.readInt("synthetic_frames", source.synthetic_frames, 0, 100000000);
+                checkSourcePath(s, "path", source);
+                if (!names.insert(source.name).second) {
+                    s.fail("name", "视频流名称 '" + source.name + "' 重复");
+                }
+                config.streams.push_back(source);
+            }
+        }
+    }
+
+    // 行为判定
+    r.readDouble("detection.ear_threshold", config.thresholds.ear_threshold, 0.0, 1.0);
+    r.readDouble("detection.mar_threshold", config.thresholds.mar_threshold, 0.0, 5.0);
+    r.readInt("detection.eye_closed_frames", config.thresholds.eye_closed_frames, 1, 10000);
+    r.readInt("detection.yawning_frames", config.thresholds.yawning_frames, 1, 10000);
+    r.readInt("detection.drinking_frames", config.thresholds.drinking_frames, 1, 10000);
+    r.readInt("detection.phone_calling_frames", config.thresholds.phone_calling_frames, 1, 10000);
+    r.readDouble("detection.detection_scale", config.detection_scale, 0.05, 1.0);
+
+    // 人脸检测后端
+    if (r.readChoice("face_detector.backend", choice, {"hog", "dnn"})) {
+        config.detector.backend = FaceDetector::stringToBackend(choice);
+    }
+    r.readInt("face_detector.hog_threads", config.detector.hog_threads, 0, 256);
+    r.readString("face_detector.dnn_model", config.detector.dnn_model, false);
+    r.readInt("face_detector.dnn_threads", config.detector.dnn_threads, 1, 256);
+    r.readDouble("face_detector.score_threshold", config.detector.score_threshold, 0.0, 1.0);
+    r.readDouble("face_detector.nms_threshold", config.detector.nms_threshold, 0.0, 1.0);
+    r.readDouble("face_detector.box_scale", config.detector.box_scale, 0.3, 2.0);
+
+    // 人脸跟踪
+    if (r.readChoice("tracking.mode", choice, {"off", "landmarks", "correlation"})) {
+        config.tracking.mode = FaceTracker::stringToMode(choice);
+    }
+    r.readInt("tracking.redetect_interval", config.tracking.redetect_interval, 1, 100000);
+    r.readDouble("tracking.min_iou", config.tracking.min_iou, 0.0, 1.0);
+    r.readDouble("tracking.min_psr", config.tracking.min_psr, 0.0, 1000.0);
+
+    // 运动门控
+    r.readBool("motion_gate.enabled", config.motion_gate.enabled);
+    r.readDouble("motion_gate.face_threshold", config.motion_gate.face_threshold, 0.0, 255.0);
+    r.readDouble("motion_gate.eye_threshold", config.motion_gate.eye_threshold, 0.0, 255.0);
+    r.readInt("motion_gate.max_skip_frames", config.motion_gate.max_skip_frames, 0, 1000);
+
+    // 驾驶员区域
+    if (r.readChoice("driver_roi.mode", choice, {"off", "fixed", "auto"})) {
+        config.driver_roi.mode = DriverRoi::stringToMode(choice);
+    }
+    r.readDouble("driver_roi.x", config.driver_roi.x, 0.0, 1.0);
+    r.readDouble("driver_roi.y", config.driver_roi.y, 0.0, 1.0);
+    r.readDouble("driver_roi.width", config.driver_roi.width, 0.01, 1.0);
+    r.readDouble("driver_roi.height", config.driver_roi.height, 0.01, 1.0);
+    if (r.readChoice("driver_roi.selection", choice, {"largest", "central"})) {
+        config.driver_roi.selection = DriverRoi::stringToSelection(choice);
+    }
+    r.readInt("driver_roi.learn_frames", config.driver_roi.learn_frames, 1, 100000);
+    r.readDouble("driver_roi.margin", config.driver_roi.margin, 0.0, 10.0);
+    if (config.driver_roi.x + config.driver_roi.width > 1.0 + 1e-9 ||
+        config.driver_roi.y + config.driver_roi.height > 1.0 + 1e-9) {
+        r.fail("driver_roi", "区域超出画面范围");
+    }
+
+    // 警报
+    r.readBool("alert.enable_sound", config.alert.enable_sound);
+    r.readInt("alert.sound_volume", config.alert.sound_volume, 0, 100);
+    r.readBool("alert.display_warning", config.alert.display_warning);
+    r.readBool("alert.log_events", config.alert.log_events);
+
+    // 事件分发
+    r.readInt("dispatch.queue_capacity", config.dispatch.queue_capacity, 1, 1000000);
+    if (r.readChoice("dispatch.overflow_policy", choice, {"drop_oldest", "drop_newest", "block"})) {
+        config.dispatch.overflow = EventDispatcher::stringToOverflowPolicy(choice);
+    }
+
+    // 模型
+    r.readString("model.face_landmark_model", config.model.path, false);
+    r.readString("model.face_landmark_cache", config.model.cache_path, true);
+    r.readBool("model.build_cache", config.model.build_cache);
+    if (r.readChoice("model.landmark_engine", choice, {"dlib", "flat"})) {
+        config.model.engine = FlatShapeModel::stringToEngine(choice);
+    }
+
+    // 输出
+    r.readBool("output.save_events", config.output.save_events);
+    r.readString("output.events_dir", config.output.events_dir, false);
+    r.readBool("output.save_images", config.output.save_images);
+    r.readString("output.images_dir", config.output.images_dir, false);
+    r.readInt("output.event_ring_capacity", config.output.event_ring_capacity, 1, 10000000);
+
+    // 事件存储
+    int segment_mb = static_cast<int>(config.event_store.max_segment_bytes >> 20);
+    r.readInt("event_store.segment_mb", segment_mb, 1, 4096);
+    config.event_store.max_segment_bytes = static_cast<uint64_t>(segment_mb) << 20;
+    r.readInt("event_store.segment_seconds", config.event_store.max_segment_seconds, 0, 30LL * 86400);
+    r.readInt("event_store.index_interval", config.event_store.index_interval, 1, 1000000);
+    r.readBool("event_store.group_commit", config.event_store.group_commit);
+    r.readInt("event_store.sync_interval_ms", config.event_store.sync_interval_ms, 1, 600000);
+    r.readInt("event_store.sync_batch", config.event_store.sync_batch, 1, 1000000);
+    config.event_store.dir = config.output.events_dir;
+
+    // 证据图像
+    if (r.readChoice("evidence.mode", choice, {"full", "face_roi", "thumbnail"})) {
+        config.evidence.mode = EvidenceEncoder::stringToMode(choice);
+    }
+    r.readInt("evidence.jpeg_quality", config.evidence.jpeg_quality, 1, 100);
+    r.readInt("evidence.thumbnail_width", config.evidence.thumbnail_width, 16, 8192);
+    r.readDouble("evidence.roi_margin", config.evidence.roi_margin, 0.0, 2.0);
+    int max_disk_mb = static_cast<int>(config.evidence.max_disk_bytes >> 20);
+    r.readInt("evidence.max_disk_mb", max_disk_mb, 0, 100000000);
+    config.evidence.max_disk_bytes = static_cast<uint64_t>(max_disk_mb) << 20;
+    r.readInt("evidence.encoder_threads", config.evidence.encoder_threads, 1, 64);
+    r.readInt("evidence.max_pending", config.evidence.max_pending, 1, 100000);
+
+    // 事件视频片段
+    r.readBool("clip.enabled", config.clip.enabled);
+    r.readString("clip.dir", config.clip.dir, false);
+    r.readDouble("clip.pre_seconds", config.clip.pre_seconds, 0.0, 600.0);
+    r.readDouble("clip.post_seconds", config.clip.post_seconds, 0.0, 600.0);
+    r.readDouble("clip.scale", config.clip.scale, 0.1, 1.0);
+    r.readInt("clip.jpeg_quality", config.clip.jpeg_quality, 1, 100);
+    int clip_memory_mb = static_cast<int>(config.clip.max_memory_bytes >> 20);
+    r.readInt("clip.max_memory_mb", clip_memory_mb, 1, 65536);
+    config.clip.max_memory_bytes = static_cast<uint64_t>(clip_memory_mb) << 20;
+    if (const json* behaviors = r.find("clip.behaviors")) {
+        if (!behaviors->is_array()) {
+            r.fail("clip.behaviors", "应为字符串数组");
+        } else {
+            config.clip.behaviors.clear();
+            for (size_t i = 0; i < behaviors->size(); ++i) {
+                const json& item = (*behaviors)[i];
+                DriverBehavior behavior;
+                if (!item.is_string() || !ClipRecorder::stringToBehavior(item.get<std::string>(), behavior)) {
+                    r.fail("clip.behaviors[" + std::to_string(i) + "]",
+                           "未知的行为，可选 eyes_closed / yawning / drinking / phone_calling");
+                    continue;
+                }
+                config.clip.behaviors.insert(behavior);
+            }
+        }
+    }
+
+    // 每帧特征记录
+    r.readBool("features.enabled", config.features.enabled);
+    r.readString("features.dir", config.features.dir, false);
+    r.readInt("features.block_rows", config.features.block_rows, 1, 1000000);
+
+    // 配置热加载
+    r.readBool("config_reload.enabled", config.reload.enabled);
+    r.readInt("config_reload.debounce_ms", config.reload.debounce_ms, 0, 10000);
+
+    return errors.size() == error_count;
+}
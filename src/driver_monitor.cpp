@@ -1,19 +1,27 @@
 #include "../include/driver_monitor.hpp"
+#include "../include/dms_config.hpp"
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <future>
 
 DriverMonitor::DriverMonitor() 
-    : _running(false), 
-      _currentBehavior(DriverBehavior::NORMAL),
-      _EAR_THRESHOLD(0.25),
-      _MAR_THRESHOLD(0.6),
-      _EYE_CLOSED_FRAMES(3),
-      _YAWNING_FRAMES(5),
-      _eyeClosedCounter(0),
-      _yawningCounter(0),
-      _drinkingCounter(0),
-      _phoneCallingCounter(0) {
+    : _faceDetector(std::make_unique<ScaledFaceDetector>()),
+      _running(false), 
+      _finished(false),
+      _targetFps(30.0),
+      _captureDone(false),
+      _inferenceDone(false),
+      _classifyDone(false),
+      _framesCaptured(0),
+      _framesProcessed(0),
+      _framesDropped(0),
+      _detectorInvocations(0),
+      _framesReused(0),
+      _elapsedNanos(0),
+      _totalLatencyNanos(0),
+      _firstDetectionNanos(-1),
+      _currentBehavior(DriverBehavior::NORMAL) {
 }
 
 DriverMonitor::~DriverMonitor() {
@@ -21,33 +29,55 @@ DriverMonitor::~DriverMonitor() {
 }
 
 bool DriverMonitor::initialize(int camera_id) {
+    FrameSourceConfig config;
+    config.type = FrameSourceType::CAMERA;
+    config.device_id = camera_id;
+    return initialize(FrameSource::create(config));
+}
+
+bool DriverMonitor::initialize(std::unique_ptr<FrameSource> source) {
     try {
-        // 初始化摄像头
-        _camera.open(camera_id);
-        if (!_camera.isOpened()) {
-            std::cerr << "无法打开摄像头 ID: " << camera_id << std::endl;
-            return false;
-        }
+        _initStartTime = std::chrono::steady_clock::now();
+        _startup = StartupStats();
+        _firstDetectionNanos = -1;
         
-        // 设置摄像头参数
-        _camera.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-        _camera.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
-        
-        // 初始化dlib人脸检测器
-        _faceDetector = dlib::get_frontal_face_detector();
-        
-        // 加载面部特征点预测模型
+        // 加载面部特征点预测模型（在后台线程上进行，与打开帧源重叠）
         // 注意：需要下载shape_predictor_68_face_landmarks.dat文件
         // 可以从 http://dlib.net/files/shape_predictor_68_face_landmarks.dat.bz2 下载
-        std::string model_path = "shape_predictor_68_face_landmarks.dat";
-        try {
-            dlib::deserialize(model_path) >> _shapePredictor;
-        } catch (const std::exception& e) {
-            std::cerr << "无法加载面部特征点预测模型: " << e.what() << std::endl;
-            std::cerr << "请确保 " << model_path << " 文件存在" << std::endl;
+        // 首次加载后写出展开缓存，之后启动时直接映射缓存
+        ShapeModelLoadInfo model_info;
+        std::future<bool> model_loaded = std::async(std::launch::async, [this, &model_info] {
+            return _landmarkPredictor.load(_modelConfig, model_info);
+        });
+        
+        // 打开帧源
+        bool source_opened = source && source->open();
+        _startup.source_open_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - _initStartTime).count();
+        
+        bool model_ok = model_loaded.get();
+        _startup.model_load_ms = model_info.load_ms;
+        _startup.model_from_cache = model_info.from_cache;
+        _startup.init_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - _initStartTime).count();
+        
+        if (!source_opened) {
+            std::cerr << "无法打开帧源" << std::endl;
+            return false;
+        }
+        _frameSource = std::move(source);
+        std::cout << "帧源: " << _frameSource->describe() << std::endl;
+        std::cout << "人脸检测: " << _faceDetector->describe() << std::endl;
+        
+        if (!model_ok) {
             return false;
         }
         
+        std::cout << "面部特征点模型: " << model_info.source
+                  << (model_info.from_cache ? "（展开缓存）" : "")
+                  << " 推理引擎 " << FlatShapeModel::engineToString(model_info.engine)
+                  << " 加载耗时 " << _startup.model_load_ms << " ms"
+                  << " 帧源打开耗时 " << _startup.source_open_ms << " ms" << std::endl;
         std::cout << "驾驶行为监测系统初始化成功" << std::endl;
         return true;
     } catch (const std::exception& e) {
@@ -56,20 +86,66 @@ bool DriverMonitor::initialize(int camera_id) {
     }
 }
 
+bool DriverMonitor::initialize(const DmsConfig& config) {
+    // 配置在快照编译时已校验，这里只做字段拷贝，运行时直接读取成员
+    setTargetFps(config.target_fps);
+    setDetectionScale(config.detection_scale);
+    setFaceDetectorConfig(config.detector);
+    setTrackingConfig(config.tracking);
+    setMotionGateConfig(config.motion_gate);
+    setDriverRoiConfig(config.driver_roi);
+    setPipelineConfig(config.pipeline);
+    setThresholds(config.thresholds);
+    setModelConfig(config.model);
+    return initialize(FrameSource::create(config.source));
+}
+
 bool DriverMonitor::start(BehaviorCallback callback) {
     if (_running) {
         std::cout << "驾驶行为监测系统已经在运行中" << std::endl;
         return false;
     }
     
-    if (!_camera.isOpened()) {
-        std::cerr << "摄像头未初始化，无法启动监测" << std::endl;
+    if (!_frameSource || !_frameSource->isOpened()) {
+        std::cerr << "帧源未初始化，无法启动监测" << std::endl;
         return false;
     }
     
     _callback = callback;
+    _finished = false;
+    _captureDone = false;
+    _inferenceDone = false;
+    _classifyDone = false;
+    _framesCaptured = 0;
+    _framesProcessed = 0;
+    _framesDropped = 0;
+    _detectorInvocations = 0;
+    _framesReused = 0;
+    _elapsedNanos = 0;
+    _motionGate.reset();
+    _totalLatencyNanos = 0;
+    
+    // 帧缓冲覆盖三个队列、各阶段正在处理的帧、当前帧和显示线程持有的帧，稳定运行时不再分配；
+    // 帧观察者（如事件片段录制）会异步持有少量帧，再多预留一些
+    size_t pool_capacity = 3 * _pipelineConfig.queue_capacity + 6;
+    if (_frameObserver) {
+        pool_capacity += 10;
+    }
+    _framePool = std::make_unique<FramePool>(pool_capacity);
+    
+    // 创建各阶段之间的队列
+    _captureQueue = std::make_unique<SpscQueue<FramePacket>>(_pipelineConfig.queue_capacity);
+    _latestFrame = std::make_unique<LatestSlot<FramePacket>>();
+    _inferenceQueue = std::make_unique<SpscQueue<FramePacket>>(_pipelineConfig.queue_capacity);
+    _classifyQueue = std::make_unique<SpscQueue<FramePacket>>(_pipelineConfig.queue_capacity);
+    
+    // 每个阶段一个线程
+    _startTime = std::chrono::steady_clock::now();
     _running = true;
-    _monitorThread = std::thread(&DriverMonitor::monitorThread, this);
+    _stageThreads.emplace_back(&DriverMonitor::captureStage, this);
+    _stageThreads.emplace_back(&DriverMonitor::inferenceStage, this);
+    _stageThreads.emplace_back(&DriverMonitor::classificationStage, this);
+    _stageThreads.emplace_back(&DriverMonitor::dispatchStage, this);
     
     std::cout << "驾驶行为监测系统已启动" << std::endl;
     return true;
@@ -82,21 +158,24 @@ void DriverMonitor::stop() {
     
     _running = false;
     
-    if (_monitorThread.joinable()) {
-        _monitorThread.join();
+    for (auto& thread : _stageThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
     }
+    _stageThreads.clear();
     
-    // 释放摄像头
-    if (_camera.isOpened()) {
-        _camera.release();
+    // 释放帧源
+    if (_frameSource) {
+        _frameSource->release();
     }
     
     std::cout << "驾驶行为监测系统已停止" << std::endl;
 }
 
-cv::Mat DriverMonitor::getCurrentFrame() const {
+FrameHandle DriverMonitor::getCurrentFrame() const {
     std::lock_guard<std::mutex> lock(_frameMutex);
-    return _currentFrame.clone();
+    return _currentFrame;
 }
 
 DriverBehavior DriverMonitor::getCurrentBehavior() const {
@@ -104,7 +183,155 @@ DriverBehavior DriverMonitor::getCurrentBehavior() const {
     return _currentBehavior;
 }
 
-std::string DriverMonitor::behaviorToString(DriverBehavior behavior) {
+bool DriverMonitor::isFinished() const {
+    return _finished;
+}
+
+MonitorStats DriverMonitor::getStats() const {
+    MonitorStats stats;
+    stats.frames_captured = _framesCaptured;
+    stats.frames_processed = _framesProcessed;
+    stats.frames_dropped = _framesDropped;
+    stats.elapsed_seconds = _elapsedNanos / 1e9;
+    if (stats.elapsed_seconds > 0) {
+        stats.fps = stats.frames_processed / stats.elapsed_seconds;
+    }
+    if (stats.frames_processed > 0) {
+        stats.avg_latency_ms = _totalLatencyNanos / 1e6 / stats.frames_processed;
+    }
+    stats.detector_invocations = _detectorInvocations;
+    if (stats.elapsed_seconds > 0) {
+        stats.detector_calls_per_second = stats.detector_invocations / stats.elapsed_seconds;
+    }
+    stats.frames_reused = _framesReused;
+    if (stats.frames_processed > 0) {
+        stats.motion_skip_ratio = static_cast<double>(stats.frames_reused) / stats.frames_processed;
+    }
+    stats.scheduler = _scheduler.getStats();
+    if (_framePool) {
+        stats.frame_pool = _framePool->getStats();
+        if (stats.frames_captured > 0) {
+            stats.bytes_copied_per_frame = static_cast<double>(stats.frame_pool.bytes_copied) / stats.frames_captured;
+        }
+    }
+    stats.startup = _startup;
+    int64_t first_detection = _firstDetectionNanos;
+    if (first_detection >= 0) {
+        stats.startup.first_detection_ms = first_detection / 1e6;
+    }
+    return stats;
+}
+
+void DriverMonitor::setDetectionScale(double scale) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改检测缩放比例" << std::endl;
+        return;
+    }
+    _faceDetector->setScale(scale);
+}
+
+void DriverMonitor::setFaceDetectorConfig(const FaceDetectorConfig& config) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改人脸检测后端" << std::endl;
+        return;
+    }
+    _faceDetector = FaceDetector::create(config, _faceDetector->getScale());
+}
+
+void DriverMonitor::setTrackingConfig(const TrackingConfig& config) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改人脸跟踪配置" << std::endl;
+        return;
+    }
+    _faceTracker.setConfig(config);
+}
+
+void DriverMonitor::setMotionGateConfig(const MotionGateConfig& config) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改运动门控配置" << std::endl;
+        return;
+    }
+    _motionGate.setConfig(config);
+}
+
+void DriverMonitor::setDriverRoiConfig(const DriverRoiConfig& config) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改驾驶员区域配置" << std::endl;
+        return;
+    }
+    _faceTracker.setDriverRoiConfig(config);
+}
+
+void DriverMonitor::setTargetFps(double target_fps) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改目标帧率" << std::endl;
+        return;
+    }
+    _targetFps = target_fps;
+}
+
+void DriverMonitor::setPipelineConfig(const PipelineConfig& config) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改流水线配置" << std::endl;
+        return;
+    }
+    _pipelineConfig = config;
+}
+
+void DriverMonitor::setThresholds(const DetectionThresholds& thresholds) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改行为阈值" << std::endl;
+        return;
+    }
+    _analyzer.setThresholds(thresholds);
+}
+
+void DriverMonitor::setModelConfig(const ShapeModelConfig& config) {
+    _modelConfig = config;
+}
+
+void DriverMonitor::applyConfig(std::shared_ptr<const DmsConfig> config) {
+    if (config) {
+        _liveConfig.publish(std::move(config));
+    }
+}
+
+void DriverMonitor::setFrameObserver(FrameObserver observer) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改帧观察者" << std::endl;
+        return;
+    }
+    _frameObserver = observer;
+}
+
+void DriverMonitor::setFeatureRecorder(std::shared_ptr<FeatureRecorder> recorder) {
+    if (_running) {
+        std::cerr << "监测运行中，无法修改特征记录器" << std::endl;
+        return;
+    }
+    _featureRecorder = recorder;
+}
+
+FrameDropPolicy DriverMonitor::stringToDropPolicy(const std::string& policy_str) {
+    if (policy_str == "block") {
+        return FrameDropPolicy::BLOCK;
+    } else {
+        return FrameDropPolicy::DROP_OLDEST;
+    }
+}
+
+std::string DriverMonitor::dropPolicyToString(FrameDropPolicy policy) {
+    switch (policy) {
+        case FrameDropPolicy::BLOCK:
+            return "block";
+        case FrameDropPolicy::DROP_OLDEST:
+            return "drop_oldest";
+        default:
+            return "drop_oldest";
+    }
+}
+
+std::string_view DriverMonitor::behaviorName(DriverBehavior behavior) {
     switch (behavior) {
         case DriverBehavior::NORMAL:
             return "正常驾驶";
@@ -121,7 +348,7 @@ std::string DriverMonitor::behaviorToString(DriverBehavior behavior) {
     }
 }
 
-std::string DriverMonitor::getBehaviorMessage(DriverBehavior behavior) {
+std::string_view DriverMonitor::behaviorMessage(DriverBehavior behavior) {
     switch (behavior) {
         case DriverBehavior::NORMAL:
             return "驾驶状态良好，请继续保持";
@@ -138,211 +365,265 @@ std::string DriverMonitor::getBehaviorMessage(DriverBehavior behavior) {
     }
 }
 
-void DriverMonitor::monitorThread() {
-    cv::Mat frame;
-    dlib::cv_image<dlib::bgr_pixel> dlib_frame;
-    std::vector<dlib::rectangle> faces;
+std::string DriverMonitor::behaviorToString(DriverBehavior behavior) {
+    return std::string(behaviorName(behavior));
+}
+
+std::string DriverMonitor::getBehaviorMessage(DriverBehavior behavior) {
+    return std::string(behaviorMessage(behavior));
+}
+
+MonitorEvent DriverMonitor::makeEvent(int stream_id, const FramePacket& packet) {
+    MonitorEvent event;
+    event.stream_id = stream_id;
+    event.sequence = packet.sequence;
+    event.behavior = packet.behavior;
+    event.message = std::string(behaviorMessage(packet.behavior));
+    event.frame = packet.frame;
+    event.has_face = packet.has_face;
+    if (packet.has_face) {
+        event.face = cv::Rect(cv::Point(packet.face.left(), packet.face.top()),
+                              cv::Point(packet.face.right() + 1, packet.face.bottom() + 1));
+    }
+    event.timestamp = std::chrono::system_clock::now();
+    return event;
+}
+
+void DriverMonitor::backoff(int& idle_rounds) {
+    // 先短暂让出CPU，持续空闲后再休眠，避免空转占满核心
+    if (++idle_rounds < 64) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void DriverMonitor::captureStage() {
+    // 回放帧源的"尽可能快"模式不做帧率控制，用于吞吐量测试
+    const bool paced = !_frameSource->isFreeRunning();
+    const bool blocking = _pipelineConfig.drop_policy == FrameDropPolicy::BLOCK;
+    uint64_t sequence = 0;
+    uint64_t config_version = _liveConfig.version();
+    
+    _scheduler.setTargetFps(paced ? _targetFps : 0.0);
+    _scheduler.reset();
     
     while (_running) {
-        // 捕获一帧
-        if (!_camera.read(frame)) {
-            std::cerr << "无法从摄像头读取帧" << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(30));
-            continue;
+        // 配置热加载：调度器只由本线程使用，下一个周期起按新帧率计算截止时间
+        if (auto config = _liveConfig.poll(config_version)) {
+            if (paced && config->target_fps != _scheduler.getTargetFps()) {
+                _scheduler.setTargetFps(config->target_fps);
+                std::cout << "目标帧率已更新为 " << config->target_fps << " fps" << std::endl;
+            }
         }
         
-        // 更新当前帧
-        {
-            std::lock_guard<std::mutex> lock(_frameMutex);
-            _currentFrame = frame.clone();
+        // 等待下一帧的截止时间，超出预算时跳过错过的帧，保证读取到最新的帧
+        int skipped = _scheduler.waitNextFrame();
+        if (skipped > 0) {
+            _frameSource->skip(skipped);
         }
         
-        // 转换为dlib图像格式
-        dlib_frame = dlib::cv_image<dlib::bgr_pixel>(frame);
-        
-        // 检测人脸
-        faces = _faceDetector(dlib_frame);
-        
-        DriverBehavior detectedBehavior = DriverBehavior::NORMAL;
-        
-        if (!faces.empty()) {
-            // 获取第一个人脸的特征点
-            dlib::full_object_detection shape = _shapePredictor(dlib_frame, faces[0]);
-            
-            // 检测各种行为
-            bool eyesClosed = detectEyesClosed(shape);
-            bool yawning = detectYawning(shape);
-            bool drinking = detectDrinking(frame);
-            bool phoneCalling = detectPhoneCalling(frame, shape);
-            
-            // 根据检测结果更新行为状态
-            if (phoneCalling) {
-                detectedBehavior = DriverBehavior::PHONE_CALLING;
-            } else if (drinking) {
-                detectedBehavior = DriverBehavior::DRINKING;
-            } else if (eyesClosed) {
-                detectedBehavior = DriverBehavior::EYES_CLOSED;
-            } else if (yawning) {
-                detectedBehavior = DriverBehavior::YAWNING;
+        // 捕获一帧，直接读入池中的缓冲
+        FramePacket packet;
+        packet.frame = _framePool->acquire();
+        if (!_framePool->read(packet.frame, [this](cv::Mat& image) { return _frameSource->read(image); })) {
+            if (_frameSource->isExhausted()) {
+                std::cout << "帧源数据已全部处理" << std::endl;
+                break;
             }
-            
-            // 在图像上绘制人脸特征点
-            for (unsigned long i = 0; i < shape.num_parts(); ++i) {
-                cv::circle(frame, cv::Point(shape.part(i).x(), shape.part(i).y()), 2, cv::Scalar(0, 255, 0), -1);
+            std::cerr << "无法从帧源读取帧" << std::endl;
+            if (!paced) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(30));
             }
-            
-            // 绘制人脸框
-            cv::rectangle(frame, 
-                         cv::Point(faces[0].left(), faces[0].top()), 
-                         cv::Point(faces[0].right(), faces[0].bottom()), 
-                         cv::Scalar(0, 255, 0), 2);
+            continue;
         }
+        packet.sequence = ++sequence;
+        packet.capture_time = std::chrono::steady_clock::now();
+        _framesCaptured++;
+        _scheduler.frameCaptured();
         
-        // 更新当前行为
-        {
-            std::lock_guard<std::mutex> lock(_behaviorMutex);
-            if (_currentBehavior != detectedBehavior) {
-                _currentBehavior = detectedBehavior;
-                
-                // 调用回调函数
-                if (_callback) {
-                    _callback(_currentBehavior, getBehaviorMessage(_currentBehavior), frame);
-                }
+        // 交给推理阶段
+        if (!blocking) {
+            // 推理还没取走上一帧时用这一帧替换它，丢弃的总是较旧的帧
+            if (_latestFrame->publish(std::move(packet))) {
+                _framesDropped++;
             }
+            continue;
+        }
+        int idle_rounds = 0;
+        while (!_captureQueue->tryPush(std::move(packet))) {
+            if (!_running) {
+                _framesDropped++;
+                break;
+            }
+            backoff(idle_rounds);
         }
-        
-        // 在图像上显示当前行为
-        cv::putText(frame, 
-                   "行为: " + behaviorToString(detectedBehavior), 
-                   cv::Point(10, 30), 
-                   cv::FONT_HERSHEY_SIMPLEX, 
-                   0.7, 
-                   cv::Scalar(0, 0, 255), 
-                   2);
-        
-        // 控制帧率
-        std::this_thread::sleep_for(std::chrono::milliseconds(30));
-    }
-}
-
-bool DriverMonitor::detectEyesClosed(const dlib::full_object_detection& shape) {
-    // 左眼特征点索引 (基于68点模型)
-    std::vector<dlib::point> leftEye;
-    for (int i = 36; i <= 41; ++i) {
-        leftEye.push_back(shape.part(i));
-    }
-    
-    // 右眼特征点索引
-    std::vector<dlib::point> rightEye;
-    for (int i = 42; i <= 47; ++i) {
-        rightEye.push_back(shape.part(i));
-    }
-    
-    // 计算左右眼的EAR
-    double leftEAR = calculateEAR(leftEye);
-    double rightEAR = calculateEAR(rightEye);
-    
-    // 取平均值
-    double avgEAR = (leftEAR + rightEAR) / 2.0;
-    
-    // 判断是否闭眼
-    if (avgEAR < _EAR_THRESHOLD) {
-        _eyeClosedCounter++;
-    } else {
-        _eyeClosedCounter = 0;
-    }
-    
-    // 连续多帧检测到闭眼才判定为闭眼状态
-    return _eyeClosedCounter >= _EYE_CLOSED_FRAMES;
-}
-
-bool DriverMonitor::detectYawning(const dlib::full_object_detection& shape) {
-    // 计算嘴部纵横比
-    double mar = calculateMAR(shape);
-    
-    // 判断是否打哈欠
-    if (mar > _MAR_THRESHOLD) {
-        _yawningCounter++;
-    } else {
-        _yawningCounter = 0;
-    }
-    
-    // 连续多帧检测到嘴巴张开才判定为打哈欠
-    return _yawningCounter >= _YAWNING_FRAMES;
-}
-
-bool DriverMonitor::detectDrinking(const cv::Mat& frame) {
-    // 简化实现：基于手部检测和姿势估计
-    // 实际应用中应使用更复杂的手部检测和姿势识别算法
-    
-    // 这里使用简单的颜色检测和运动检测来模拟
-    // 在实际应用中，应该使用更高级的方法，如目标检测网络(YOLO, SSD等)
-    
-    // 简单模拟：随机概率触发，实际应用中替换为真实检测逻辑
-    if (rand() % 100 < 5) {  // 5%的概率触发
-        _drinkingCounter++;
-    } else {
-        _drinkingCounter = std::max(0, _drinkingCounter - 1);
     }
     
-    return _drinkingCounter > 3;
+    _captureDone = true;
 }
 
-bool DriverMonitor::detectPhoneCalling(const cv::Mat& frame, const dlib::full_object_detection& shape) {
-    // 简化实现：基于手部位置和头部姿势
-    // 实际应用中应使用更复杂的手部检测和姿势识别算法
-    
-    // 检测头部倾斜和手部靠近耳朵的姿势
-    // 这里使用简单的启发式方法模拟
-    
-    // 检查头部是否倾斜
-    dlib::point leftEye = shape.part(36);
-    dlib::point rightEye = shape.part(45);
-    double eyeAngle = std::abs(std::atan2(rightEye.y() - leftEye.y(), rightEye.x() - leftEye.x()) * 180.0 / M_PI);
+void DriverMonitor::inferenceStage() {
+    const bool dropOldest = _pipelineConfig.drop_policy == FrameDropPolicy::DROP_OLDEST;
+    FramePacket packet;
+    int idle_rounds = 0;
+    uint64_t config_version = _liveConfig.version();
     
-    // 简单模拟：随机概率触发，实际应用中替换为真实检测逻辑
-    if (eyeAngle > 10 || rand() % 100 < 3) {  // 头部倾斜或3%的概率触发
-        _phoneCallingCounter++;
-    } else {
-        _phoneCallingCounter = std::max(0, _phoneCallingCounter - 1);
+    while (_running) {
+        // 配置热加载：人脸检测器只由本线程使用
+        if (auto config = _liveConfig.poll(config_version)) {
+            _faceDetector->setScale(config->detection_scale);
+        }
+        
+        // 取帧：丢帧模式下取最新采集的帧（被替换的旧帧已在采集阶段计入丢帧）
+        bool got = dropOldest ? _latestFrame->take(packet) : _captureQueue->tryPop(packet);
+        if (!got) {
+            if (_captureDone && _captureQueue->empty() && _latestFrame->empty()) {
+                break;
+            }
+            backoff(idle_rounds);
+            continue;
+        }
+        idle_rounds = 0;
+        
+        const cv::Mat& frame = packet.frame.image();
+        _preparedFrame.reset(frame);
+        
+        if (_motionGate.unchanged(_preparedFrame)) {
+            // 人脸区域几乎没有变化：复用上一次的人脸框和特征点，分类阶段照常推进计数器
+            packet.has_face = true;
+            packet.face = _lastFace;
+            packet.shape = _lastShape;
+            _framesReused++;
+        } else {
+            // 跟踪模式下优先用跟踪结果定位人脸，跟踪失败或到达检测间隔时再完整检测
+            // 检测器和跟踪器从同一份预处理缓存中取灰度图、缩小图，本帧只转换一次
+            bool detector_invoked = false;
+            packet.has_face = _faceTracker.locate(_preparedFrame, *_faceDetector, packet.face, detector_invoked);
+            if (detector_invoked) {
+                _detectorInvocations++;
+            }
+            
+            if (packet.has_face) {
+                // 获取人脸的特征点：写入本阶段复用的_lastShape（特征点数不变时flat引擎不分配），
+                // 再复制到随帧传递的缓冲中
+                _landmarkPredictor.predict(frame, packet.face, _lastShape);
+                _faceTracker.update(_lastShape);
+                _motionGate.update(_preparedFrame, packet.face, _lastShape);
+                _lastFace = packet.face;
+                packet.shape = _lastShape;
+            } else {
+                _motionGate.reset();
+            }
+        }
+        
+        // 分类阶段需要连续的帧来维护计数器，这里不再丢帧
+        while (!_inferenceQueue->tryPush(std::move(packet)) && _running) {
+            backoff(idle_rounds);
+        }
+        idle_rounds = 0;
     }
     
-    return _phoneCallingCounter > 5;
+    _inferenceDone = true;
 }
 
-double DriverMonitor::calculateEAR(const std::vector<dlib::point>& eye) {
-    // 计算眼睛纵横比 (Eye Aspect Ratio)
-    // EAR = (||p2-p6|| + ||p3-p5||) / (2 * ||p1-p4||)
-    double a = std::sqrt(std::pow(eye[1].x() - eye[5].x(), 2) + std::pow(eye[1].y() - eye[5].y(), 2));
-    double b = std::sqrt(std::pow(eye[2].x() - eye[4].x(), 2) + std::pow(eye[2].y() - eye[4].y(), 2));
-    double c = std::sqrt(std::pow(eye[0].x() - eye[3].x(), 2) + std::pow(eye[0].y() - eye[3].y(), 2));
+void DriverMonitor::classificationStage() {
+    FramePacket packet;
+    int idle_rounds = 0;
+    uint64_t config_version = _liveConfig.version();
     
-    // 避免除零错误
-    if (c < 0.1) {
-        return 0.0;
+    while (_running) {
+        // 配置热加载：新阈值从下一帧起生效，连续帧计数器保留
+        if (auto config = _liveConfig.poll(config_version)) {
+            _analyzer.setThresholds(config->thresholds);
+        }
+        
+        if (!_inferenceQueue->tryPop(packet)) {
+            if (_inferenceDone && _inferenceQueue->empty()) {
+                break;
+            }
+            backoff(idle_rounds);
+            continue;
+        }
+        idle_rounds = 0;
+        
+        // 检测各种行为
+        packet.behavior = DriverBehavior::NORMAL;
+        if (packet.has_face) {
+            packet.behavior = _analyzer.analyze(packet.frame.image(), packet.shape);
+        }
+        
+        // 记录本帧特征（只是放入无锁队列）
+        if (_featureRecorder) {
+            _featureRecorder->record(FeatureRecorder::makeSample(
+                packet.sequence, packet.has_face, packet.face, _analyzer.getLastFeatures(), packet.behavior));
+        }
+        
+        while (!_classifyQueue->tryPush(std::move(packet)) && _running) {
+            backoff(idle_rounds);
+        }
+        idle_rounds = 0;
     }
     
-    return (a + b) / (2.0 * c);
+    _classifyDone = true;
 }
 
-double DriverMonitor::calculateMAR(const dlib::full_object_detection& shape) {
-    // 计算嘴部纵横比 (Mouth Aspect Ratio)
-    // 使用嘴部的6个关键点 (48, 54, 51, 57, 62, 66)
-    
-    // 计算嘴部高度
-    double h1 = std::sqrt(std::pow(shape.part(51).x() - shape.part(57).x(), 2) + 
-                         std::pow(shape.part(51).y() - shape.part(57).y(), 2));
-    double h2 = std::sqrt(std::pow(shape.part(62).x() - shape.part(66).x(), 2) + 
-                         std::pow(shape.part(62).y() - shape.part(66).y(), 2));
-    
-    // 计算嘴部宽度
-    double w = std::sqrt(std::pow(shape.part(48).x() - shape.part(54).x(), 2) + 
-                        std::pow(shape.part(48).y() - shape.part(54).y(), 2));
+void DriverMonitor::dispatchStage() {
+    FramePacket packet;
+    int idle_rounds = 0;
     
-    // 避免除零错误
-    if (w < 0.1) {
-        return 0.0;
+    while (_running) {
+        if (!_classifyQueue->tryPop(packet)) {
+            if (_classifyDone && _classifyQueue->empty()) {
+                _finished = true;
+                break;
+            }
+            backoff(idle_rounds);
+            continue;
+        }
+        idle_rounds = 0;
+        
+        // 分发阶段是这一帧的唯一持有者，直接在缓冲上标注，标注完成后才发布为当前帧
+        cv::Mat& frame = packet.frame.mutableImage();
+        
+        _annotator.annotate(frame, packet.has_face, packet.face, packet.shape, packet.behavior);
+        
+        // 发布为当前帧（只增加引用计数）
+        {
+            std::lock_guard<std::mutex> lock(_frameMutex);
+            _currentFrame = packet.frame;
+        }
+        if (_frameObserver) {
+            _frameObserver(packet.frame);
+        }
+        
+        // 更新当前行为，锁内只做比较和赋值
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> lock(_behaviorMutex);
+            if (_currentBehavior != packet.behavior) {
+                _currentBehavior = packet.behavior;
+                changed = true;
+            }
+        }
+        
+        // 在锁外调用回调函数，标注已完成，回调可以异步持有这一帧
+        if (changed && _callback) {
+            _callback(makeEvent(0, packet));
+        }
+        
+        // 更新统计
+        auto now = std::chrono::steady_clock::now();
+        if (_firstDetectionNanos < 0) {
+            // 首次检测耗时：从开始初始化（加载模型、打开帧源）到第一帧结果分发
+            _firstDetectionNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                now - _initStartTime).count();
+            std::cout << "首次检测完成: 启动后 " << _firstDetectionNanos / 1e6 << " ms" << std::endl;
+        }
+        _framesProcessed++;
+        _totalLatencyNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - packet.capture_time).count();
+        _elapsedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - _startTime).count();
     }
-    
-    return (h1 + h2) / (2.0 * w);
 }
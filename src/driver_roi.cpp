@@ -0,0 +1,198 @@
+#include "../include/driver_roi.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 中位数（会重排输入）
+double median(std::vector<double>& values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+} // namespace
+
+DriverRoi::DriverRoi(const DriverRoiConfig& config)
+    : _config(config),
+      _learned(false) {
+}
+
+void DriverRoi::setConfig(const DriverRoiConfig& config) {
+    _config = config;
+    _learned = false;
+    _learnedRegion = cv::Rect();
+    _samples.clear();
+}
+
+const DriverRoiConfig& DriverRoi::getConfig() const {
+    return _config;
+}
+
+cv::Rect DriverRoi::region(const cv::Size& frame_size) const {
+    const cv::Rect full(0, 0, frame_size.width, frame_size.height);
+    switch (_config.mode) {
+        case DriverRoiMode::OFF:
+            return full;
+        case DriverRoiMode::AUTO:
+            if (_learned) {
+                cv::Rect learned = _learnedRegion & full;
+                if (!learned.empty()) {
+                    return learned;
+                }
+            }
+            return configuredRegion(frame_size);
+        case DriverRoiMode::FIXED:
+        default:
+            return configuredRegion(frame_size);
+    }
+}
+
+PreparedFrame& DriverRoi::crop(PreparedFrame& frame) {
+    _frameSize = frame.size();
+    _region = region(_frameSize);
+    if (_region == cv::Rect(0, 0, _frameSize.width, _frameSize.height)) {
+        return frame;
+    }
+    _cropped.reset(frame, _region);
+    return _cropped;
+}
+
+bool DriverRoi::select(const std::vector<dlib::rectangle>& faces, dlib::rectangle& face) {
+    if (faces.empty()) {
+        return false;
+    }
+
+    // 检测结果是子帧坐标，先平移回画面坐标；按规则比较，完全相同时保留靠前（置信度更高）的人脸
+    const dlib::point offset(_region.x, _region.y);
+    const double center_x = _region.x + _region.width * 0.5;
+    const double center_y = _region.y + _region.height * 0.5;
+    bool found = false;
+    unsigned long best_area = 0;
+    double best_distance = 0.0;
+    for (const auto& candidate : faces) {
+        dlib::rectangle rect = dlib::translate_rect(candidate, offset);
+        unsigned long area = rect.area();
+        double dx = (rect.left() + rect.right()) * 0.5 - center_x;
+        double dy = (rect.top() + rect.bottom()) * 0.5 - center_y;
+        double distance = dx * dx + dy * dy;
+
+        bool better = !found;
+        if (found && _config.selection == DriverSelection::CENTRAL) {
+            better = distance < best_distance || (distance == best_distance && area > best_area);
+        } else if (found) {
+            better = area > best_area || (area == best_area && distance < best_distance);
+        }
+        if (better) {
+            face = rect;
+            best_area = area;
+            best_distance = distance;
+            found = true;
+        }
+    }
+
+    if (_config.mode == DriverRoiMode::AUTO && !_learned) {
+        learn(face);
+    }
+    return true;
+}
+
+bool DriverRoi::isLearned() const {
+    return _learned;
+}
+
+DriverRoiMode DriverRoi::stringToMode(const std::string& mode_str) {
+    if (mode_str == "fixed") {
+        return DriverRoiMode::FIXED;
+    } else if (mode_str == "auto") {
+        return DriverRoiMode::AUTO;
+    } else {
+        return DriverRoiMode::OFF;
+    }
+}
+
+std::string DriverRoi::modeToString(DriverRoiMode mode) {
+    switch (mode) {
+        case DriverRoiMode::FIXED:
+            return "fixed";
+        case DriverRoiMode::AUTO:
+            return "auto";
+        default:
+            return "off";
+    }
+}
+
+DriverSelection DriverRoi::stringToSelection(const std::string& selection_str) {
+    if (selection_str == "central") {
+        return DriverSelection::CENTRAL;
+    } else {
+        return DriverSelection::LARGEST;
+    }
+}
+
+std::string DriverRoi::selectionToString(DriverSelection selection) {
+    switch (selection) {
+        case DriverSelection::CENTRAL:
+            return "central";
+        default:
+            return "largest";
+    }
+}
+
+cv::Rect DriverRoi::configuredRegion(const cv::Size& frame_size) const {
+    const cv::Rect full(0, 0, frame_size.width, frame_size.height);
+    cv::Rect configured(
+        static_cast<int>(std::lround(_config.x * frame_size.width)),
+        static_cast<int>(std::lround(_config.y * frame_size.height)),
+        static_cast<int>(std::lround(_config.width * frame_size.width)),
+        static_cast<int>(std::lround(_config.height * frame_size.height)));
+    configured &= full;
+    return configured.width < 2 || configured.height < 2 ? full : configured;
+}
+
+void DriverRoi::learn(const dlib::rectangle& face) {
+    _samples.push_back(face);
+    if (_samples.size() < static_cast<size_t>(std::max(1, _config.learn_frames))) {
+        return;
+    }
+
+    // 以人脸中心和边长的中位数为准，远离中位中心的样本（如学习期间偶尔选中的乘客）不计入
+    std::vector<double> xs, ys, sizes;
+    for (const auto& sample : _samples) {
+        xs.push_back((sample.left() + sample.right()) * 0.5);
+        ys.push_back((sample.top() + sample.bottom()) * 0.5);
+        sizes.push_back(0.5 * (sample.width() + sample.height()));
+    }
+    const double mid_x = median(xs);
+    const double mid_y = median(ys);
+    const double size = median(sizes);
+    const double limit = 1.5 * size;
+
+    cv::Rect bounds;
+    for (const auto& sample : _samples) {
+        double cx = (sample.left() + sample.right()) * 0.5;
+        double cy = (sample.top() + sample.bottom()) * 0.5;
+        if (std::abs(cx - mid_x) > limit || std::abs(cy - mid_y) > limit) {
+            continue;
+        }
+        cv::Rect rect(static_cast<int>(sample.left()), static_cast<int>(sample.top()),
+                      static_cast<int>(sample.width()), static_cast<int>(sample.height()));
+        bounds = bounds.empty() ? rect : (bounds | rect);
+    }
+    _samples.clear();
+
+    // 向外扩展，给头部转动和前后移动留出余量
+    const int pad = static_cast<int>(std::lround(_config.margin * size));
+    bounds = cv::Rect(bounds.x - pad, bounds.y - pad, bounds.width + 2 * pad, bounds.height + 2 * pad);
+    bounds &= cv::Rect(0, 0, _frameSize.width, _frameSize.height);
+    if (bounds.width < 2 || bounds.height < 2) {
+        return;
+    }
+    _learnedRegion = bounds;
+    _learned = true;
+
+    double percent = 100.0 * bounds.area() / std::max(1, _frameSize.area());
+    std::cout << "驾驶员区域学习完成: (" << bounds.x << ", " << bounds.y << ") "
+              << bounds.width << "x" << bounds.height << "，占画面的 " << percent << "%" << std::endl;
+}
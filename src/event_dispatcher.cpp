@@ -0,0 +1,158 @@
+#include "../include/event_dispatcher.hpp"
+#include <iostream>
+#include <algorithm>
+
+EventDispatcher::EventDispatcher() {
+}
+
+EventDispatcher::~EventDispatcher() {
+    stop();
+}
+
+int EventDispatcher::subscribe(const std::string& name, Handler handler, const SubscriberConfig& config) {
+    auto subscriber = std::make_unique<Subscriber>();
+    subscriber->name = name;
+    subscriber->handler = std::move(handler);
+    subscriber->config = config;
+    subscriber->config.queue_capacity = std::max<size_t>(1, config.queue_capacity);
+    subscriber->slots.resize(subscriber->config.queue_capacity);
+    subscriber->worker = std::thread(&EventDispatcher::workerLoop, this, std::ref(*subscriber));
+
+    std::lock_guard<std::mutex> lock(_subscribersMutex);
+    _subscribers.push_back(std::move(subscriber));
+    return static_cast<int>(_subscribers.size()) - 1;
+}
+
+void EventDispatcher::publish(const MonitorEvent& event) {
+    std::lock_guard<std::mutex> lock(_subscribersMutex);
+    for (auto& subscriber : _subscribers) {
+        enqueue(*subscriber, event);
+    }
+}
+
+void EventDispatcher::enqueue(Subscriber& subscriber, const MonitorEvent& event) {
+    std::unique_lock<std::mutex> lock(subscriber.mutex);
+    if (subscriber.stopping) {
+        return;
+    }
+
+    const size_t capacity = subscriber.slots.size();
+    subscriber.published++;
+
+    if (subscriber.count == capacity) {
+        switch (subscriber.config.overflow) {
+            case OverflowPolicy::DROP_NEWEST:
+                subscriber.dropped++;
+                return;
+            case OverflowPolicy::BLOCK:
+                subscriber.notFull.wait(lock, [&subscriber, capacity] {
+                    return subscriber.count < capacity || subscriber.stopping;
+                });
+                if (subscriber.stopping) {
+                    subscriber.dropped++;
+                    return;
+                }
+                break;
+            case OverflowPolicy::DROP_OLDEST:
+            default:
+                // 覆盖最早的事件（同时释放其图像引用）
+                subscriber.slots[subscriber.head] = MonitorEvent();
+                subscriber.head = (subscriber.head + 1) % capacity;
+                subscriber.count--;
+                subscriber.dropped++;
+                break;
+        }
+    }
+
+    subscriber.slots[(subscriber.head + subscriber.count) % capacity] = event;
+    subscriber.count++;
+    subscriber.maxDepth = std::max(subscriber.maxDepth, subscriber.count);
+    lock.unlock();
+    subscriber.notEmpty.notify_one();
+}
+
+void EventDispatcher::stop() {
+    std::lock_guard<std::mutex> lock(_subscribersMutex);
+    for (auto& subscriber : _subscribers) {
+        {
+            std::lock_guard<std::mutex> subscriber_lock(subscriber->mutex);
+            subscriber->stopping = true;
+        }
+        subscriber->notEmpty.notify_all();
+        subscriber->notFull.notify_all();
+    }
+    for (auto& subscriber : _subscribers) {
+        if (subscriber->worker.joinable()) {
+            subscriber->worker.join();
+        }
+    }
+}
+
+std::vector<SubscriberStats> EventDispatcher::getStats() const {
+    std::vector<SubscriberStats> result;
+    std::lock_guard<std::mutex> lock(_subscribersMutex);
+    for (const auto& subscriber : _subscribers) {
+        std::lock_guard<std::mutex> subscriber_lock(subscriber->mutex);
+        SubscriberStats stats;
+        stats.name = subscriber->name;
+        stats.published = subscriber->published;
+        stats.delivered = subscriber->delivered;
+        stats.dropped = subscriber->dropped;
+        stats.max_depth = subscriber->maxDepth;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+OverflowPolicy EventDispatcher::stringToOverflowPolicy(const std::string& policy_str) {
+    if (policy_str == "drop_newest") {
+        return OverflowPolicy::DROP_NEWEST;
+    } else if (policy_str == "block") {
+        return OverflowPolicy::BLOCK;
+    } else {
+        return OverflowPolicy::DROP_OLDEST;
+    }
+}
+
+std::string EventDispatcher::overflowPolicyToString(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::DROP_NEWEST:
+            return "drop_newest";
+        case OverflowPolicy::BLOCK:
+            return "block";
+        default:
+            return "drop_oldest";
+    }
+}
+
+void EventDispatcher::workerLoop(Subscriber& subscriber) {
+    const size_t capacity = subscriber.slots.size();
+
+    while (true) {
+        MonitorEvent event;
+        {
+            std::unique_lock<std::mutex> lock(subscriber.mutex);
+            subscriber.notEmpty.wait(lock, [&subscriber] {
+                return subscriber.count > 0 || subscriber.stopping;
+            });
+            // 停止时先处理完队列中剩余的事件
+            if (subscriber.count == 0) {
+                break;
+            }
+            event = std::move(subscriber.slots[subscriber.head]);
+            subscriber.slots[subscriber.head] = MonitorEvent();
+            subscriber.head = (subscriber.head + 1) % capacity;
+            subscriber.count--;
+        }
+        subscriber.notFull.notify_one();
+
+        try {
+            subscriber.handler(event);
+        } catch (const std::exception& e) {
+            std::cerr << "事件订阅者 " << subscriber.name << " 处理失败: " << e.what() << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(subscriber.mutex);
+        subscriber.delivered++;
+    }
+}
@@ -1,4 +1,5 @@
 #include "../include/event_logger.hpp"
+#include "../include/dms_config.hpp"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
@@ -11,33 +12,49 @@ namespace fs = std::filesystem;
 EventLogger::EventLogger(const std::string& events_dir, const std::string& images_dir)
     : _eventsDir(events_dir),
       _imagesDir(images_dir),
-      _saveImages(true) {
+      _saveImages(true),
+      _events(std::make_unique<EventRing>()) {
     
     // 确保目录存在
     ensureDirectoryExists(_eventsDir);
     ensureDirectoryExists(_imagesDir);
     
-    // 打开日志文件
-    std::string log_file_path = _eventsDir + "/events.log";
-    _logFile.open(log_file_path, std::ios::app);
+    // 证据图像在后台线程上编码写入
+    _encoder = std::make_unique<EvidenceEncoder>(_imagesDir, _evidenceConfig);
     
-    if (!_logFile.is_open()) {
-        std::cerr << "无法打开日志文件: " << log_file_path << std::endl;
-    } else {
-        std::cout << "事件日志将保存到: " << log_file_path << std::endl;
-    }
+    // 打开事件存储
+    openEventStore();
+}
+
+EventLogger::EventLogger(const DmsConfig& config)
+    : _eventsDir(config.output.events_dir),
+      _imagesDir(config.output.images_dir),
+      _saveImages(config.output.save_images),
+      _evidenceConfig(config.evidence),
+      _events(std::make_unique<EventRing>(config.output.event_ring_capacity)),
+      _storeConfig(config.event_store) {
+    
+    ensureDirectoryExists(_eventsDir);
+    ensureDirectoryExists(_imagesDir);
+    _encoder = std::make_unique<EvidenceEncoder>(_imagesDir, _evidenceConfig);
+    openEventStore();
 }
 
 EventLogger::~EventLogger() {
-    if (_logFile.is_open()) {
-        _logFile.close();
+    flush();
+    
+    if (_store) {
+        _store->close();
     }
 }
 
 bool EventLogger::logEvent(DriverBehavior behavior, const std::string& message, const cv::Mat& image) {
     try {
+        refreshConfig();
+        
         // 获取当前时间戳
-        std::string timestamp = getCurrentTimestamp();
+        auto now = std::chrono::system_clock::now();
+        std::string timestamp = formatTimestamp(now);
         
         // 保存图像（如果启用）
         std::string image_path;
@@ -46,31 +63,32 @@ bool EventLogger::logEvent(DriverBehavior behavior, const std::string& message,
             image_path = saveImage(image, prefix);
         }
         
-        // 创建事件记录
-        BehaviorEvent event;
-        event.behavior = behavior;
-        event.message = message;
-        event.timestamp = timestamp;
-        event.image_path = image_path;
+        appendEvent(behavior, message, now, timestamp, image_path);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "记录事件失败: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool EventLogger::logEvent(const MonitorEvent& event, const std::string& clip_path) {
+    try {
+        refreshConfig();
         
-        // 添加到事件列表
-        {
-            std::lock_guard<std::mutex> lock(_eventsMutex);
-            _events.push_back(event);
-        }
+        // 使用检测到行为的时间，而不是写日志的时间
+        std::string timestamp = formatTimestamp(event.timestamp);
         
-        // 写入日志文件
-        if (_logFile.is_open()) {
-            _logFile << timestamp << " | " 
-                    << DriverMonitor::behaviorToString(behavior) << " | " 
-                    << message << " | " 
-                    << image_path << std::endl;
-            _logFile.flush();
+        // 保存图像（如果启用）：直接提交共享帧，不复制像素
+        std::string image_path;
+        if (_saveImages && !event.frame.empty()) {
+            std::string filename = makeImageFilename(DriverMonitor::behaviorToString(event.behavior), timestamp);
+            if (event.stream_id > 0) {
+                filename.insert(filename.size() - 4, "_" + std::to_string(event.stream_id));
+            }
+            image_path = _encoder->submit(event.frame, event.has_face ? event.face : cv::Rect(), filename);
         }
         
-        std::cout << "记录事件: " << DriverMonitor::behaviorToString(behavior) 
-                 << " 时间: " << timestamp << std::endl;
-        
+        appendEvent(event.behavior, event.message, event.timestamp, timestamp, image_path, clip_path);
         return true;
     } catch (const std::exception& e) {
         std::cerr << "记录事件失败: " << e.what() << std::endl;
@@ -78,14 +96,46 @@ bool EventLogger::logEvent(DriverBehavior behavior, const std::string& message,
     }
 }
 
+void EventLogger::appendEvent(DriverBehavior behavior, const std::string& message,
+                              std::chrono::system_clock::time_point time, const std::string& timestamp,
+                              const std::string& image_path, const std::string& clip_path) {
+    // 创建事件记录
+    BehaviorEvent event;
+    event.behavior = behavior;
+    event.message = message;
+    event.timestamp = timestamp;
+    event.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    event.image_path = image_path;
+    event.clip_path = clip_path;
+    
+    // 写入事件存储（落盘由存储按批量fsync策略完成，这里不逐条flush）
+    // 编号由事件存储分配（重启后接着已保存的最后一个编号），写入失败时编号同样被占用
+    if (_store && !_store->append(event)) {
+        std::cerr << "写入事件存储失败: " << DriverMonitor::behaviorToString(behavior) << std::endl;
+    }
+    
+    // 添加到事件缓存（超出容量时覆盖最早的事件），沿用事件存储的编号，
+    // getEvents()、游标与事件存储、dms_event_dump 中的编号一致
+    _events->append(event);
+    
+    std::cout << "记录事件: " << DriverMonitor::behaviorToString(behavior) 
+             << " 时间: " << timestamp << std::endl;
+}
+
 std::vector<BehaviorEvent> EventLogger::getEvents() const {
-    std::lock_guard<std::mutex> lock(_eventsMutex);
-    return _events;
+    return _events->snapshot();
+}
+
+const EventRing& EventLogger::getEventRing() const {
+    return *_events;
+}
+
+void EventLogger::setEventRingCapacity(size_t capacity) {
+    _events = std::make_unique<EventRing>(capacity);
 }
 
 void EventLogger::clearEvents() {
-    std::lock_guard<std::mutex> lock(_eventsMutex);
-    _events.clear();
+    _events->clear();
 }
 
 void EventLogger::setEventsDir(const std::string& events_dir) {
@@ -93,13 +143,8 @@ void EventLogger::setEventsDir(const std::string& events_dir) {
         _eventsDir = events_dir;
         ensureDirectoryExists(_eventsDir);
         
-        // 重新打开日志文件
-        if (_logFile.is_open()) {
-            _logFile.close();
-        }
-        
-        std::string log_file_path = _eventsDir + "/events.log";
-        _logFile.open(log_file_path, std::ios::app);
+        // 重新打开事件存储
+        openEventStore();
     }
 }
 
@@ -107,6 +152,9 @@ void EventLogger::setImagesDir(const std::string& images_dir) {
     if (_imagesDir != images_dir) {
         _imagesDir = images_dir;
         ensureDirectoryExists(_imagesDir);
+        
+        // 新目录使用新的编码器（磁盘配额按目录统计）
+        _encoder = std::make_unique<EvidenceEncoder>(_imagesDir, _evidenceConfig);
     }
 }
 
@@ -126,14 +174,83 @@ bool EventLogger::isSaveImages() const {
     return _saveImages;
 }
 
+void EventLogger::setEvidenceConfig(const EvidenceConfig& config) {
+    _evidenceConfig = config;
+    _encoder = std::make_unique<EvidenceEncoder>(_imagesDir, _evidenceConfig);
+}
+
+void EventLogger::flush() {
+    if (_encoder) {
+        _encoder->flush();
+    }
+    if (_store) {
+        _store->sync();
+    }
+}
+
+EvidenceStats EventLogger::getEvidenceStats() const {
+    return _encoder ? _encoder->getStats() : EvidenceStats();
+}
+
+void EventLogger::setEventStoreConfig(const EventStoreConfig& config) {
+    _storeConfig = config;
+    openEventStore();
+}
+
+EventStoreStats EventLogger::getEventStoreStats() const {
+    return _store ? _store->getStats() : EventStoreStats();
+}
+
+void EventLogger::applyConfig(std::shared_ptr<const DmsConfig> config) {
+    if (config) {
+        _liveConfig.publish(std::move(config));
+    }
+}
+
+void EventLogger::refreshConfig() {
+    std::shared_ptr<const DmsConfig> config = _liveConfig.poll(_configVersion);
+    if (!config) {
+        return;
+    }
+    
+    // 目录变化时才重新打开事件存储或创建新的编码器，旧目录中的文件保留
+    if (config->output.events_dir != _eventsDir) {
+        std::cout << "事件目录已更新为 " << config->output.events_dir << std::endl;
+        setEventsDir(config->output.events_dir);
+    }
+    if (config->output.images_dir != _imagesDir) {
+        std::cout << "图像目录已更新为 " << config->output.images_dir << std::endl;
+        _encoder->flush();
+        setImagesDir(config->output.images_dir);
+    }
+    _saveImages = config->output.save_images;
+}
+
+void EventLogger::openEventStore() {
+    if (_store) {
+        _store->close();
+    }
+    
+    _storeConfig.dir = _eventsDir;
+    _store = std::make_unique<EventStore>(_storeConfig);
+    if (!_store->open()) {
+        std::cerr << "无法打开事件存储: " << _eventsDir << std::endl;
+        _store.reset();
+    } else {
+        std::cout << "事件记录将保存到: " << _eventsDir << "/events-*.seg" << std::endl;
+    }
+}
+
 std::string EventLogger::getCurrentTimestamp() const {
-    // 获取当前时间
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
+    return formatTimestamp(std::chrono::system_clock::now());
+}
+
+std::string EventLogger::formatTimestamp(std::chrono::system_clock::time_point time) const {
+    auto time_t_now = std::chrono::system_clock::to_time_t(time);
     
     // 获取毫秒部分
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+        time.time_since_epoch()) % 1000;
     
     // 格式化时间戳
     std::stringstream ss;
@@ -156,27 +273,22 @@ bool EventLogger::ensureDirectoryExists(const std::string& dir) const {
     }
 }
 
-std::string EventLogger::saveImage(const cv::Mat& image, const std::string& prefix) const {
+std::string EventLogger::makeImageFilename(const std::string& prefix, const std::string& timestamp) const {
+    std::string filename = prefix + "_" + timestamp + ".jpg";
+    // 替换文件名中的非法字符
+    std::replace(filename.begin(), filename.end(), ' ', '_');
+    std::replace(filename.begin(), filename.end(), ':', '-');
+    return filename;
+}
+
+std::string EventLogger::saveImage(const cv::Mat& image, const std::string& prefix) {
     try {
         // 确保目录存在
         ensureDirectoryExists(_imagesDir);
         
-        // 生成文件名
-        std::string timestamp = getCurrentTimestamp();
-        std::string filename = prefix + "_" + timestamp + ".jpg";
-        // 替换文件名中的非法字符
-        std::replace(filename.begin(), filename.end(), ' ', '_');
-        std::replace(filename.begin(), filename.end(), ':', '-');
-        
-        // 完整路径
-        std::string filepath = _imagesDir + "/" + filename;
-        
-        // 保存图像
-        cv::imwrite(filepath, image);
-        
-        std::cout << "保存图像: " << filepath << std::endl;
-        
-        return filepath;
+        // 生成文件名，交给后台编码器保存
+        std::string filename = makeImageFilename(prefix, getCurrentTimestamp());
+        return _encoder->submit(image, cv::Rect(), filename);
     } catch (const std::exception& e) {
         std::cerr << "保存图像失败: " << e.what() << std::endl;
         return "";
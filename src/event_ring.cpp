@@ -0,0 +1,163 @@
+#include "../include/event_ring.hpp"
+#include <mutex>
+#include <algorithm>
+
+EventCursor::EventCursor(const EventRing* ring, const EventQuery& query, uint64_t next_id, uint64_t generation)
+    : _ring(ring),
+      _query(query),
+      _nextId(next_id),
+      _generation(generation) {
+}
+
+bool EventCursor::next(BehaviorEvent& event) {
+    if (_done || !_ring) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(_ring->_mutex);
+    uint64_t first = _ring->firstIdLocked();
+    if (_generation != _ring->_generation) {
+        // 编号跳变（重新打开事件存储）：旧编号不再有意义，从缓存中最早的事件继续，不算作覆盖
+        _generation = _ring->_generation;
+        _nextId = first;
+    } else if (_nextId < first) {
+        // 游标落后于写入，中间的事件已被覆盖
+        _missed += first - _nextId;
+        _nextId = first;
+    }
+
+    while (_nextId < _ring->_nextId) {
+        const BehaviorEvent& candidate = _ring->atLocked(_nextId++);
+        if (candidate.timestamp_ns > _query.to_ns) {
+            _done = true;
+            return false;
+        }
+        if (_query.matches(candidate)) {
+            event = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+EventRing::EventRing(size_t capacity)
+    : _slots(std::max<size_t>(1, capacity)),
+      _nextId(1),
+      _generation(0),
+      _count(0),
+      _lastTimestampNs(std::numeric_limits<int64_t>::min()),
+      _appended(0),
+      _totals{} {
+}
+
+uint64_t EventRing::append(BehaviorEvent event) {
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (event.id == 0) {
+        event.id = _nextId;
+    } else if (event.id != _nextId) {
+        // 缓存按编号连续存放，编号跳变时之前的事件不再可寻址
+        _count = 0;
+        _nextId = event.id;
+        _generation++;
+    }
+    // 与事件存储一致：时间戳不早于上一个事件，二分查找依赖这一点
+    event.timestamp_ns = std::max(event.timestamp_ns, _lastTimestampNs);
+    _lastTimestampNs = event.timestamp_ns;
+    _nextId++;
+    _appended++;
+    size_t behavior = static_cast<size_t>(event.behavior);
+    if (behavior < kBehaviorCount) {
+        _totals[behavior]++;
+    }
+    const uint64_t id = event.id;
+    _slots[id % _slots.size()] = std::move(event);
+    _count = std::min(_count + 1, _slots.size());
+    return id;
+}
+
+void EventRing::clear() {
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    for (auto& slot : _slots) {
+        slot = BehaviorEvent();
+    }
+    _count = 0;
+}
+
+EventCursor EventRing::query(const EventQuery& query) const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return EventCursor(this, query, lowerBoundLocked(query.from_ns), _generation);
+}
+
+size_t EventRing::visit(const EventQuery& query, const std::function<bool(const BehaviorEvent&)>& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    size_t visited = 0;
+    for (uint64_t id = lowerBoundLocked(query.from_ns); id < _nextId; ++id) {
+        const BehaviorEvent& event = atLocked(id);
+        if (event.timestamp_ns > query.to_ns) {
+            break;
+        }
+        if (!query.matches(event)) {
+            continue;
+        }
+        visited++;
+        if (!visitor(event)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+std::vector<BehaviorEvent> EventRing::snapshot(const EventQuery& query, size_t max_events) const {
+    std::vector<BehaviorEvent> result;
+    visit(query, [&result, max_events](const BehaviorEvent& event) {
+        result.push_back(event);
+        return result.size() < max_events;
+    });
+    return result;
+}
+
+size_t EventRing::count(const EventQuery& query) const {
+    return visit(query, [](const BehaviorEvent&) { return true; });
+}
+
+std::array<uint64_t, kBehaviorCount> EventRing::getTotals() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _totals;
+}
+
+size_t EventRing::size() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _count;
+}
+
+size_t EventRing::capacity() const {
+    return _slots.size();
+}
+
+uint64_t EventRing::totalAppended() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _appended;
+}
+
+uint64_t EventRing::firstIdLocked() const {
+    return _nextId - _count;
+}
+
+const BehaviorEvent& EventRing::atLocked(uint64_t id) const {
+    return _slots[id % _slots.size()];
+}
+
+uint64_t EventRing::lowerBoundLocked(int64_t from_ns) const {
+    // 事件按时间顺序追加，在缓存范围内二分查找
+    uint64_t low = firstIdLocked();
+    uint64_t high = _nextId;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (atLocked(mid).timestamp_ns < from_ns) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,534 @@
+#include "../include/event_store.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <array>
+#include <unistd.h>
+
+// 使用C++17的文件系统库
+namespace fs = std::filesystem;
+
+namespace {
+
+// 段文件格式
+constexpr char kSegmentMagic[8] = {'D', 'M', 'S', 'E', 'V', 'T', '0', '1'};
+constexpr uint32_t kSegmentVersion = 1;
+constexpr size_t kSegmentHeaderSize = 8 + 4 + 8 + 8;   // 魔数 + 版本 + 首条事件编号 + 首条记录时间
+constexpr size_t kRecordHeaderSize = 4 + 4;            // 负载长度 + CRC32
+constexpr size_t kIndexEntrySize = 8 + 8 + 8;          // 时间戳 + 事件编号 + 偏移
+constexpr uint32_t kMaxPayloadSize = 1u << 20;         // 超过此长度视为损坏
+
+// CRC32（IEEE 802.3多项式）
+uint32_t crc32(const uint8_t* data, size_t size) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 小端编码
+void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+void putU64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& s) {
+    // 超长字符串截断到16位长度
+    uint16_t len = static_cast<uint16_t>(std::min<size_t>(s.size(), 0xFFFF));
+    putU16(out, len);
+    out.insert(out.end(), s.begin(), s.begin() + len);
+}
+
+uint64_t getU64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// 顺序解码，越界时置failed
+struct Decoder {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool failed = false;
+
+    uint64_t u64() {
+        if (end - p < 8) { failed = true; return 0; }
+        uint64_t v = getU64(p);
+        p += 8;
+        return v;
+    }
+
+    uint8_t u8() {
+        if (end - p < 1) { failed = true; return 0; }
+        return *p++;
+    }
+
+    std::string str() {
+        if (end - p < 2) { failed = true; return std::string(); }
+        size_t len = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8);
+        p += 2;
+        if (static_cast<size_t>(end - p) < len) { failed = true; return std::string(); }
+        std::string s(reinterpret_cast<const char*>(p), len);
+        p += len;
+        return s;
+    }
+};
+
+// 编码记录负载：事件编号, 时间戳, 行为, 提示信息, 图像路径, 片段路径
+void encodePayload(std::vector<uint8_t>& out, const BehaviorEvent& event) {
+    putU64(out, event.id);
+    putU64(out, static_cast<uint64_t>(event.timestamp_ns));
+    out.push_back(static_cast<uint8_t>(event.behavior));
+    putString(out, event.message);
+    putString(out, event.image_path);
+    putString(out, event.clip_path);
+}
+
+bool decodePayload(const uint8_t* data, size_t size, BehaviorEvent& event) {
+    Decoder d{data, data + size};
+    event.id = d.u64();
+    event.timestamp_ns = static_cast<int64_t>(d.u64());
+    event.behavior = static_cast<DriverBehavior>(d.u8());
+    event.message = d.str();
+    event.image_path = d.str();
+    event.clip_path = d.str();
+    event.timestamp.clear();
+    return !d.failed;
+}
+
+// 读取一条记录，返回false表示到达文件尾或记录不完整/损坏
+bool readRecord(std::ifstream& in, std::vector<uint8_t>& payload, BehaviorEvent& event) {
+    uint8_t header[kRecordHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    uint32_t len = getU32(header);
+    uint32_t crc = getU32(header + 4);
+    if (len == 0 || len > kMaxPayloadSize) {
+        return false;
+    }
+    payload.resize(len);
+    if (!in.read(reinterpret_cast<char*>(payload.data()), len)) {
+        return false;
+    }
+    if (crc32(payload.data(), len) != crc) {
+        return false;
+    }
+    return decodePayload(payload.data(), len, event);
+}
+
+// 读取并校验段头
+bool readSegmentHeader(std::ifstream& in, uint64_t& first_id, int64_t& start_ns) {
+    uint8_t header[kSegmentHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header, kSegmentMagic, sizeof(kSegmentMagic)) != 0 || getU32(header + 8) != kSegmentVersion) {
+        return false;
+    }
+    first_id = getU64(header + 12);
+    start_ns = static_cast<int64_t>(getU64(header + 20));
+    return true;
+}
+
+std::string segmentName(uint64_t first_id) {
+    std::stringstream ss;
+    ss << "events-" << std::setfill('0') << std::setw(20) << first_id;
+    return ss.str();
+}
+
+std::string indexPathOf(const std::string& segment_path) {
+    return fs::path(segment_path).replace_extension(".idx").string();
+}
+
+} // namespace
+
+EventStore::EventStore(const EventStoreConfig& config)
+    : _config(config),
+      _segment(nullptr),
+      _index(nullptr),
+      _segmentBytes(0),
+      _segmentRecords(0),
+      _segmentStartNs(0),
+      _nextId(1),
+      _lastTimestampNs(0),
+      _unsynced(0),
+      _open(false),
+      _stopping(false) {
+    _config.index_interval = std::max<uint32_t>(1, _config.index_interval);
+    _config.sync_batch = std::max<uint32_t>(1, _config.sync_batch);
+    _config.sync_interval_ms = std::max(1, _config.sync_interval_ms);
+}
+
+EventStore::~EventStore() {
+    close();
+}
+
+bool EventStore::open() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_open) {
+        return true;
+    }
+
+    try {
+        fs::create_directories(_config.dir);
+    } catch (const std::exception& e) {
+        std::cerr << "创建事件存储目录失败: " << _config.dir << " - " << e.what() << std::endl;
+        return false;
+    }
+
+    recover();
+
+    // 段文件在第一条记录写入时创建，首条记录时间即段的起始时间
+    _stopping = false;
+    _open = true;
+    if (_config.group_commit) {
+        _syncThread = std::thread(&EventStore::syncLoop, this);
+    }
+
+    std::cout << "事件存储目录: " << _config.dir << "，下一个事件编号: " << _nextId << std::endl;
+    return true;
+}
+
+void EventStore::close() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _syncWake.notify_all();
+    if (_syncThread.joinable()) {
+        _syncThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    closeSegment();
+    _open = false;
+}
+
+bool EventStore::append(BehaviorEvent& event) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_open) {
+        return false;
+    }
+
+    // 系统时间回拨时沿用上一条记录的时间，保证时间戳单调不减
+    event.timestamp_ns = std::max(event.timestamp_ns, _lastTimestampNs);
+    event.id = _nextId;
+
+    // 按大小和时间跨度切换新段
+    if (_segment &&
+        (_segmentBytes >= _config.max_segment_bytes ||
+         (_config.max_segment_seconds > 0 &&
+          event.timestamp_ns - _segmentStartNs >= _config.max_segment_seconds * 1000000000LL))) {
+        closeSegment();
+    }
+    if (!_segment && !openSegment(event.timestamp_ns)) {
+        // 写入失败的事件同样消耗编号：环形缓存沿用该编号，下一条记录不能重复使用
+        _nextId++;
+        return false;
+    }
+
+    _record.clear();
+    _record.resize(kRecordHeaderSize);
+    encodePayload(_record, event);
+    uint32_t len = static_cast<uint32_t>(_record.size() - kRecordHeaderSize);
+    uint32_t crc = crc32(_record.data() + kRecordHeaderSize, len);
+    for (int i = 0; i < 4; ++i) {
+        _record[i] = static_cast<uint8_t>(len >> (8 * i));
+        _record[4 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+
+    uint64_t offset = _segmentBytes;
+    if (std::fwrite(_record.data(), 1, _record.size(), _segment) != _record.size()) {
+        std::cerr << "写入事件记录失败: " << std::strerror(errno) << std::endl;
+        // 丢弃写了一半的段，下一条记录从新段开始
+        closeSegment();
+        _nextId++;
+        return false;
+    }
+
+    // 稀疏索引：每index_interval条记录一项
+    if (_index && _segmentRecords % _config.index_interval == 0) {
+        std::vector<uint8_t> entry;
+        entry.reserve(kIndexEntrySize);
+        putU64(entry, static_cast<uint64_t>(event.timestamp_ns));
+        putU64(entry, event.id);
+        putU64(entry, offset);
+        std::fwrite(entry.data(), 1, entry.size(), _index);
+    }
+
+    _segmentBytes += _record.size();
+    _segmentRecords++;
+    _nextId++;
+    _lastTimestampNs = event.timestamp_ns;
+    _stats.records++;
+    _stats.bytes += _record.size();
+    _stats.last_id = event.id;
+
+    _unsynced++;
+    if (!_config.group_commit) {
+        flushLocked(true);
+    } else if (_unsynced >= _config.sync_batch) {
+        lock.unlock();
+        _syncWake.notify_one();
+    }
+    return true;
+}
+
+void EventStore::sync() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    flushLocked(true);
+}
+
+bool EventStore::isOpen() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _open;
+}
+
+EventStoreStats EventStore::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+const EventStoreConfig& EventStore::getConfig() const {
+    return _config;
+}
+
+bool EventStore::openSegment(int64_t timestamp_ns) {
+    std::string base = (fs::path(_config.dir) / segmentName(_nextId)).string();
+    _segment = std::fopen((base + ".seg").c_str(), "wb");
+    if (!_segment) {
+        std::cerr << "无法创建事件段文件: " << base << ".seg" << std::endl;
+        return false;
+    }
+    _index = std::fopen((base + ".idx").c_str(), "wb");
+    if (!_index) {
+        std::cerr << "无法创建事件索引文件: " << base << ".idx" << std::endl;
+    }
+
+    std::vector<uint8_t> header(kSegmentMagic, kSegmentMagic + sizeof(kSegmentMagic));
+    putU32(header, kSegmentVersion);
+    putU64(header, _nextId);
+    putU64(header, static_cast<uint64_t>(timestamp_ns));
+    std::fwrite(header.data(), 1, header.size(), _segment);
+
+    _segmentBytes = header.size();
+    _segmentRecords = 0;
+    _segmentStartNs = timestamp_ns;
+    _stats.segments++;
+    return true;
+}
+
+void EventStore::closeSegment() {
+    if (_segment) {
+        flushLocked(true);
+        std::fclose(_segment);
+        _segment = nullptr;
+    }
+    if (_index) {
+        std::fclose(_index);
+        _index = nullptr;
+    }
+}
+
+void EventStore::flushLocked(bool force_sync) {
+    if (!_segment) {
+        return;
+    }
+    std::fflush(_segment);
+    if (_index) {
+        std::fflush(_index);
+    }
+    if (force_sync && _unsynced > 0) {
+        // 只有段文件需要落盘：索引可以从段文件重建，读取时也会校验偏移处的记录
+        ::fsync(fileno(_segment));
+        _unsynced = 0;
+        _stats.syncs++;
+    }
+}
+
+void EventStore::syncLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stopping) {
+        _syncWake.wait_for(lock, std::chrono::milliseconds(_config.sync_interval_ms), [this] {
+            return _stopping || _unsynced >= _config.sync_batch;
+        });
+        // 在锁内fsync：写入方是事件分发线程，不会阻塞检测流水线
+        flushLocked(true);
+    }
+}
+
+void EventStore::recover() {
+    std::vector<std::string> segments = EventStoreReader(_config.dir).listSegments();
+
+    // 从最后一个段开始找最后一条有效记录
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        std::ifstream in(*it, std::ios::binary);
+        uint64_t first_id = 0;
+        int64_t start_ns = 0;
+        if (!readSegmentHeader(in, first_id, start_ns)) {
+            continue;
+        }
+
+        uint64_t valid_end = kSegmentHeaderSize;
+        bool found = false;
+        std::vector<uint8_t> payload;
+        BehaviorEvent event;
+        while (readRecord(in, payload, event)) {
+            valid_end = static_cast<uint64_t>(in.tellg());
+            _nextId = event.id + 1;
+            _lastTimestampNs = event.timestamp_ns;
+            found = true;
+        }
+        in.close();
+
+        // 截掉异常退出时写了一半的记录
+        std::error_code ec;
+        if (fs::file_size(*it, ec) > valid_end && !ec) {
+            fs::resize_file(*it, valid_end, ec);
+            std::cerr << "事件段文件末尾有不完整的记录，已截断: " << *it << std::endl;
+        }
+
+        if (found) {
+            break;
+        }
+        // 空段至少说明编号从这里开始
+        _nextId = std::max(_nextId, first_id);
+        _lastTimestampNs = std::max(_lastTimestampNs, start_ns);
+    }
+    _lastTimestampNs = std::max<int64_t>(_lastTimestampNs, 0);
+}
+
+EventStoreReader::EventStoreReader(const std::string& dir)
+    : _dir(dir) {
+}
+
+std::vector<std::string> EventStoreReader::listSegments() const {
+    std::vector<std::string> segments;
+    std::error_code ec;
+    for (fs::directory_iterator it(_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        const fs::path& path = it->path();
+        if (path.extension() == ".seg" && path.filename().string().rfind("events-", 0) == 0) {
+            segments.push_back(path.string());
+        }
+    }
+    // 编号固定宽度，按文件名排序即按编号排序
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+bool EventStoreReader::readSince(int64_t since_ns,
+                                 const std::function<bool(const BehaviorEvent&)>& callback) const {
+    std::vector<std::string> segments = listSegments();
+
+    // 段内时间戳单调不减且段按时间顺序排列：
+    // 从最后一个起始时间不晚于since_ns的段开始读，更早的段可以整个跳过
+    size_t first = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        int64_t start_ns = 0;
+        if (segmentStartTime(segments[i], start_ns) && start_ns <= since_ns) {
+            first = i;
+        }
+    }
+
+    bool stopped = false;
+    for (size_t i = first; i < segments.size() && !stopped; ++i) {
+        uint64_t offset = (i == first) ? seekOffset(segments[i], since_ns) : 0;
+        readSegment(segments[i], offset, [&](const BehaviorEvent& event) {
+            if (event.timestamp_ns < since_ns) {
+                return true;
+            }
+            if (!callback(event)) {
+                stopped = true;
+                return false;
+            }
+            return true;
+        });
+    }
+    return !segments.empty();
+}
+
+bool EventStoreReader::readSegment(const std::string& path, uint64_t start_offset,
+                                   const std::function<bool(const BehaviorEvent&)>& callback) {
+    std::ifstream in(path, std::ios::binary);
+    uint64_t first_id = 0;
+    int64_t start_ns = 0;
+    if (!in.is_open() || !readSegmentHeader(in, first_id, start_ns)) {
+        std::cerr << "无效的事件段文件: " << path << std::endl;
+        return false;
+    }
+    if (start_offset > kSegmentHeaderSize) {
+        in.seekg(static_cast<std::streamoff>(start_offset));
+    }
+
+    std::vector<uint8_t> payload;
+    BehaviorEvent event;
+    while (readRecord(in, payload, event)) {
+        if (!callback(event)) {
+            break;
+        }
+    }
+    return true;
+}
+
+uint64_t EventStoreReader::seekOffset(const std::string& segment_path, int64_t since_ns) {
+    std::ifstream in(indexPathOf(segment_path), std::ios::binary);
+    if (!in.is_open()) {
+        return 0;
+    }
+
+    // 取最后一个时间戳早于since_ns的索引项：它之前的记录都早于since_ns
+    uint64_t offset = 0;
+    uint8_t entry[kIndexEntrySize];
+    while (in.read(reinterpret_cast<char*>(entry), sizeof(entry))) {
+        if (static_cast<int64_t>(getU64(entry)) >= since_ns) {
+            break;
+        }
+        offset = getU64(entry + 16);
+    }
+    return offset;
+}
+
+bool EventStoreReader::segmentStartTime(const std::string& segment_path, int64_t& start_ns) {
+    std::ifstream in(segment_path, std::ios::binary);
+    uint64_t first_id = 0;
+    return in.is_open() && readSegmentHeader(in, first_id, start_ns);
+}
@@ -0,0 +1,230 @@
+#include "../include/evidence_encoder.hpp"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+// 使用C++17的文件系统库
+namespace fs = std::filesystem;
+
+EvidenceEncoder::EvidenceEncoder(const std::string& dir, const EvidenceConfig& config)
+    : _dir(dir),
+      _config(config),
+      _pending(0),
+      _bytesOnDisk(0),
+      _encoded(0),
+      _dropped(0),
+      _failed(0),
+      _evicted(0),
+      _encodeNanos(0) {
+    _config.jpeg_quality = std::min(100, std::max(1, _config.jpeg_quality));
+    _config.thumbnail_width = std::max(16, _config.thumbnail_width);
+    _config.max_pending = std::max<size_t>(1, _config.max_pending);
+    _pool = std::make_unique<WorkStealingPool>(std::max(1, _config.encoder_threads));
+    scanExisting();
+}
+
+EvidenceEncoder::~EvidenceEncoder() {
+    flush();
+}
+
+std::string EvidenceEncoder::submit(const FrameHandle& frame, const cv::Rect& face, const std::string& filename) {
+    if (frame.empty()) {
+        return "";
+    }
+    Job job;
+    job.frame = frame;
+    job.face = face;
+    return enqueue(std::move(job), filename);
+}
+
+std::string EvidenceEncoder::submit(const cv::Mat& image, const cv::Rect& face, const std::string& filename) {
+    if (image.empty()) {
+        return "";
+    }
+    Job job;
+    job.image = image.clone();
+    job.face = face;
+    return enqueue(std::move(job), filename);
+}
+
+std::string EvidenceEncoder::enqueue(Job job, const std::string& filename) {
+    // 编码跟不上时丢弃，不让积压的帧占住帧缓冲和内存
+    if (_pending.fetch_add(1) >= _config.max_pending) {
+        _pending--;
+        _dropped++;
+        std::cerr << "证据图像编码积压，丢弃: " << filename << std::endl;
+        return "";
+    }
+
+    job.path = _dir + "/" + filename;
+    std::string path = job.path;
+    _pool->submit([this, job] {
+        // 编码中途抛出异常时同样要归还排队名额，否则计数只增不减，之后的证据全部被丢弃
+        struct PendingRelease {
+            std::atomic<size_t>& pending;
+            ~PendingRelease() { pending--; }
+        } release{_pending};
+        encode(job);
+    });
+    return path;
+}
+
+void EvidenceEncoder::flush() {
+    if (_pool) {
+        _pool->waitIdle();
+    }
+}
+
+EvidenceStats EvidenceEncoder::getStats() const {
+    EvidenceStats stats;
+    stats.encoded = _encoded;
+    stats.dropped = _dropped;
+    stats.failed = _failed;
+    stats.evicted = _evicted;
+    {
+        std::lock_guard<std::mutex> lock(_filesMutex);
+        stats.bytes_on_disk = _bytesOnDisk;
+    }
+    if (stats.encoded > 0) {
+        stats.avg_encode_ms = _encodeNanos / 1e6 / stats.encoded;
+    }
+    return stats;
+}
+
+const EvidenceConfig& EvidenceEncoder::getConfig() const {
+    return _config;
+}
+
+EvidenceMode EvidenceEncoder::stringToMode(const std::string& mode_str) {
+    if (mode_str == "face_roi") {
+        return EvidenceMode::FACE_ROI;
+    } else if (mode_str == "thumbnail") {
+        return EvidenceMode::THUMBNAIL;
+    } else {
+        return EvidenceMode::FULL;
+    }
+}
+
+std::string EvidenceEncoder::modeToString(EvidenceMode mode) {
+    switch (mode) {
+        case EvidenceMode::FACE_ROI:
+            return "face_roi";
+        case EvidenceMode::THUMBNAIL:
+            return "thumbnail";
+        default:
+            return "full";
+    }
+}
+
+void EvidenceEncoder::encode(const Job& job) {
+    auto start = std::chrono::steady_clock::now();
+
+    // 每个编码线程复用自己的缩放和编码缓冲
+    thread_local cv::Mat scratch;
+    thread_local std::vector<uchar> buffer;
+
+    const cv::Mat& image = job.frame.empty() ? job.image : job.frame.image();
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, _config.jpeg_quality};
+
+    try {
+        // 缩放同样可能抛出异常（如内存不足），与编码一起按失败处理
+        cv::Mat region = selectRegion(image, job.face, scratch);
+        if (!cv::imencode(".jpg", region, buffer, params)) {
+            _failed++;
+            std::cerr << "证据图像编码失败: " << job.path << std::endl;
+            return;
+        }
+        std::ofstream file(job.path, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+            _failed++;
+            std::cerr << "证据图像写入失败: " << job.path << std::endl;
+            return;
+        }
+    } catch (const std::exception& e) {
+        _failed++;
+        std::cerr << "保存证据图像失败: " << e.what() << std::endl;
+        return;
+    }
+
+    _encoded++;
+    _encodeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    account(job.path, buffer.size());
+}
+
+cv::Mat EvidenceEncoder::selectRegion(const cv::Mat& image, const cv::Rect& face, cv::Mat& scratch) const {
+    EvidenceMode mode = _config.mode;
+
+    if (mode == EvidenceMode::FACE_ROI) {
+        if (face.area() > 0) {
+            // 人脸框向外扩展，保留手部和手机、水杯等上下文；只取子区域，不复制像素
+            int dx = static_cast<int>(face.width * _config.roi_margin);
+            int dy = static_cast<int>(face.height * _config.roi_margin);
+            cv::Rect roi(face.x - dx, face.y - dy, face.width + 2 * dx, face.height + 2 * dy);
+            roi &= cv::Rect(0, 0, image.cols, image.rows);
+            if (roi.area() > 0) {
+                return image(roi);
+            }
+        }
+        mode = EvidenceMode::THUMBNAIL;
+    }
+
+    if (mode == EvidenceMode::THUMBNAIL && image.cols > _config.thumbnail_width) {
+        double factor = static_cast<double>(_config.thumbnail_width) / image.cols;
+        cv::resize(image, scratch, cv::Size(), factor, factor, cv::INTER_AREA);
+        return scratch;
+    }
+
+    return image;
+}
+
+void EvidenceEncoder::account(const std::string& path, uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(_filesMutex);
+    _files.emplace_back(path, bytes);
+    _bytesOnDisk += bytes;
+
+    if (_config.max_disk_bytes == 0) {
+        return;
+    }
+
+    // 超出配额时删除最旧的证据，至少保留刚写入的这一张
+    while (_bytesOnDisk > _config.max_disk_bytes && _files.size() > 1) {
+        auto oldest = _files.front();
+        _files.pop_front();
+        _bytesOnDisk -= std::min(_bytesOnDisk, oldest.second);
+        std::error_code ec;
+        fs::remove(oldest.first, ec);
+        if (ec) {
+            std::cerr << "删除旧证据图像失败: " << oldest.first << " - " << ec.message() << std::endl;
+        }
+        _evicted++;
+    }
+}
+
+void EvidenceEncoder::scanExisting() {
+    std::error_code ec;
+    if (!fs::is_directory(_dir, ec)) {
+        return;
+    }
+
+    // 按修改时间从旧到新排列，之前运行留下的证据同样计入配额
+    std::vector<std::pair<fs::file_time_type, std::pair<std::string, uint64_t>>> existing;
+    for (const auto& entry : fs::directory_iterator(_dir, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".jpg") {
+            continue;
+        }
+        existing.push_back({entry.last_write_time(ec), {entry.path().string(), entry.file_size(ec)}});
+    }
+    std::sort(existing.begin(), existing.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    std::lock_guard<std::mutex> lock(_filesMutex);
+    for (const auto& item : existing) {
+        _files.push_back(item.second);
+        _bytesOnDisk += item.second.second;
+    }
+}
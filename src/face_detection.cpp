@@ -0,0 +1,304 @@
+#include "../include/face_detection.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+void FaceDetector::detect(const cv::Mat& frame, std::vector<dlib::rectangle>& faces) {
+    _prepared.reset(frame);
+    detect(_prepared, faces);
+}
+
+std::vector<dlib::rectangle> FaceDetector::detect(const cv::Mat& frame) {
+    std::vector<dlib::rectangle> faces;
+    detect(frame, faces);
+    return faces;
+}
+
+void FaceDetector::setScale(double scale) {
+    _scale = std::min(1.0, std::max(0.1, scale));
+}
+
+double FaceDetector::getScale() const {
+    return _scale;
+}
+
+std::unique_ptr<FaceDetector> FaceDetector::create(const FaceDetectorConfig& config, double scale) {
+    if (config.backend == FaceDetectorBackend::HOG && config.hog_threads != 1) {
+        return std::make_unique<ParallelHogDetector>(scale, config.hog_threads);
+    }
+    if (config.backend == FaceDetectorBackend::DNN) {
+        auto detector = std::make_unique<DnnFaceDetector>(config, scale);
+        if (detector->isLoaded()) {
+            return detector;
+        }
+        std::cerr << "无法使用DNN人脸检测器，改用HOG检测器" << std::endl;
+    }
+    return std::make_unique<ScaledFaceDetector>(scale);
+}
+
+FaceDetectorBackend FaceDetector::stringToBackend(const std::string& backend_str) {
+    if (backend_str == "dnn") {
+        return FaceDetectorBackend::DNN;
+    } else {
+        return FaceDetectorBackend::HOG;
+    }
+}
+
+std::string FaceDetector::backendToString(FaceDetectorBackend backend) {
+    switch (backend) {
+        case FaceDetectorBackend::DNN:
+            return "dnn";
+        case FaceDetectorBackend::HOG:
+            return "hog";
+        default:
+            return "hog";
+    }
+}
+
+dlib::rectangle FaceDetector::scaleRectangle(const dlib::rectangle& rect, double factor) {
+    return dlib::rectangle(
+        static_cast<long>(std::lround(rect.left() * factor)),
+        static_cast<long>(std::lround(rect.top() * factor)),
+        static_cast<long>(std::lround((rect.right() + 1) * factor)) - 1,
+        static_cast<long>(std::lround((rect.bottom() + 1) * factor)) - 1);
+}
+
+// ---------------- HOG ----------------
+
+ScaledFaceDetector::ScaledFaceDetector(double scale)
+    : _detector(dlib::get_frontal_face_detector()) {
+    setScale(scale);
+}
+
+std::string ScaledFaceDetector::describe() const {
+    return "HOG (dlib)";
+}
+
+void ScaledFaceDetector::detect(PreparedFrame& frame, std::vector<dlib::rectangle>& faces) {
+    faces.clear();
+    if (frame.empty()) {
+        return;
+    }
+
+    // 检测结果写入复用的_detections，与返回std::vector<rectangle>的重载顺序一致
+    double factor = 1.0;
+    if (_scale >= 1.0 && frame.channels() == 3) {
+        // 不缩放时直接在原图上检测，结果与原来的全分辨率检测完全一致
+        scan(dlib::cv_image<dlib::bgr_pixel>(frame.image()), _detections);
+    } else if (_scale >= 1.0) {
+        scan(dlib::cv_image<unsigned char>(frame.gray()), _detections);
+    } else {
+        // 在缩小的灰度图上检测（HOG只需要梯度信息），再把人脸框映射回原始分辨率
+        scan(dlib::cv_image<unsigned char>(frame.downscaledGray(_scale)), _detections);
+        factor = 1.0 / _scale;
+    }
+
+    for (const auto& detection : _detections) {
+        faces.push_back(factor == 1.0 ? detection.rect : scaleRectangle(detection.rect, factor));
+    }
+}
+
+void ScaledFaceDetector::scan(const dlib::cv_image<dlib::bgr_pixel>& image,
+                              std::vector<dlib::rect_detection>& detections) {
+    _detector(image, detections);
+}
+
+void ScaledFaceDetector::scan(const dlib::cv_image<unsigned char>& image,
+                              std::vector<dlib::rect_detection>& detections) {
+    _detector(image, detections);
+}
+
+// ---------------- 并行HOG ----------------
+
+ParallelHogDetector::ParallelHogDetector(double scale, int thread_count)
+    : ScaledFaceDetector(scale),
+      _pool(std::make_unique<WorkStealingPool>(thread_count)) {
+    // 与 dlib::object_detector 相同：权重向量的最后一维是阈值，其余部分分解为可分离的滤波器组
+    const Scanner& scanner = _detector.get_scanner();
+    for (unsigned long i = 0; i < _detector.num_detectors(); ++i) {
+        _filters.push_back(scanner.build_fhog_filterbank(_detector.get_w(i)));
+        _thresholds.push_back(_detector.get_w(i)(scanner.get_num_dimensions()));
+    }
+}
+
+std::string ParallelHogDetector::describe() const {
+    return "HOG (dlib, 并行 " + std::to_string(_pool->size()) + " 线程)";
+}
+
+void ParallelHogDetector::scan(const dlib::cv_image<dlib::bgr_pixel>& image,
+                               std::vector<dlib::rect_detection>& detections) {
+    scanPyramid(image, _colorLevels, detections);
+}
+
+void ParallelHogDetector::scan(const dlib::cv_image<unsigned char>& image,
+                               std::vector<dlib::rect_detection>& detections) {
+    scanPyramid(image, _grayLevels, detections);
+}
+
+template <typename Pixel, typename Image>
+void ParallelHogDetector::scanPyramid(const Image& image, std::vector<std::unique_ptr<dlib::array2d<Pixel>>>& levels,
+                                      std::vector<dlib::rect_detection>& detections) {
+    const Scanner& base = _detector.get_scanner();
+    Scanner::pyramid_type pyr;
+
+    // 层数的计算与 scan_fhog_pyramid 相同：缩小到小于最小层尺寸或达到最大层数为止
+    unsigned long level_count = 0;
+    dlib::rectangle rect = dlib::get_rect(image);
+    do {
+        rect = pyr.rect_down(rect);
+        ++level_count;
+    } while (rect.width() >= base.get_min_pyramid_layer_width() &&
+             rect.height() >= base.get_min_pyramid_layer_height() &&
+             level_count < base.get_max_pyramid_levels());
+
+    // 各层图像依次缩小（与dlib一样在原像素类型上缩小），扫描器和缓冲只在层数增加时创建
+    while (levels.size() < level_count) {
+        levels.push_back(std::make_unique<dlib::array2d<Pixel>>());
+    }
+    for (unsigned long k = 1; k < level_count; ++k) {
+        if (k == 1) {
+            pyr(image, *levels[k]);
+        } else {
+            pyr(*levels[k - 1], *levels[k]);
+        }
+    }
+    while (_scanners.size() < level_count) {
+        _scanners.push_back(base);
+        _scanners.back().set_max_pyramid_levels(1);
+    }
+    const size_t filter_count = _filters.size();
+    if (_candidates.size() < level_count * filter_count) {
+        _candidates.resize(level_count * filter_count);
+    }
+
+    // 每层先提取HOG特征，再把除第一个以外的滤波器提交为独立任务（放入本线程队列，空闲线程可以窃取）
+    for (unsigned long k = 0; k < level_count; ++k) {
+        _pool->submit([this, k, filter_count, &image, &levels] {
+            Scanner& scanner = _scanners[k];
+            if (k == 0) {
+                scanner.load(image);
+            } else {
+                scanner.load(*levels[k]);
+            }
+            for (size_t f = 1; f < filter_count; ++f) {
+                _pool->submit([this, k, f, filter_count] {
+                    _scanners[k].detect(_filters[f], _candidates[k * filter_count + f], _thresholds[f]);
+                });
+            }
+            scanner.detect(_filters[0], _candidates[k * filter_count], _thresholds[0]);
+        });
+    }
+    _pool->waitIdle();
+
+    // 汇总候选框并映射回输入图像坐标，与 object_detector 相同地排序并做非极大值抑制
+    _merged.clear();
+    for (size_t f = 0; f < filter_count; ++f) {
+        for (unsigned long k = 0; k < level_count; ++k) {
+            for (const auto& candidate : _candidates[k * filter_count + f]) {
+                dlib::rect_detection detection;
+                detection.detection_confidence = candidate.first - _thresholds[f];
+                detection.weight_index = f;
+                detection.rect = pyr.rect_up(candidate.second, k);
+                _merged.push_back(detection);
+            }
+        }
+    }
+    // 串行检测中各滤波器的候选框已按置信度排序，这里各层分别扫描，汇总后总要重新排序
+    std::sort(_merged.rbegin(), _merged.rend());
+    const auto& overlaps = _detector.get_overlap_tester();
+    detections.clear();
+    for (const auto& detection : _merged) {
+        bool suppressed = false;
+        for (const auto& kept : detections) {
+            if (overlaps(kept.rect, detection.rect)) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (!suppressed) {
+            detections.push_back(detection);
+        }
+    }
+}
+
+// ---------------- DNN (YuNet) ----------------
+
+DnnFaceDetector::DnnFaceDetector(const FaceDetectorConfig& config, double scale)
+    : _config(config),
+      _inputSize(0, 0) {
+    setScale(scale);
+#if DMS_HAVE_YUNET
+    try {
+        // 输入尺寸在第一帧时按实际分辨率设置
+        _detector = cv::FaceDetectorYN::create(_config.dnn_model, "", cv::Size(320, 320),
+                                               static_cast<float>(_config.score_threshold),
+                                               static_cast<float>(_config.nms_threshold), 5000,
+                                               cv::dnn::DNN_BACKEND_OPENCV, cv::dnn::DNN_TARGET_CPU);
+    } catch (const cv::Exception& e) {
+        std::cerr << "无法加载DNN人脸检测模型 " << _config.dnn_model << ": " << e.what() << std::endl;
+        _detector.release();
+    }
+    if (_detector && _config.dnn_threads > 0) {
+        cv::setNumThreads(_config.dnn_threads);
+    }
+#else
+    std::cerr << "当前OpenCV版本不支持cv::FaceDetectorYN（需要4.5.4及以上的objdetect和dnn模块）" << std::endl;
+#endif
+}
+
+bool DnnFaceDetector::isLoaded() const {
+#if DMS_HAVE_YUNET
+    return !_detector.empty();
+#else
+    return false;
+#endif
+}
+
+std::string DnnFaceDetector::describe() const {
+    return "DNN (YuNet " + _config.dnn_model + ", " + std::to_string(_config.dnn_threads) + " 线程)";
+}
+
+void DnnFaceDetector::detect(PreparedFrame& frame, std::vector<dlib::rectangle>& faces) {
+    faces.clear();
+#if DMS_HAVE_YUNET
+    if (frame.empty() || !_detector) {
+        return;
+    }
+
+    // YuNet需要3通道输入；缩小后检测，再把人脸框映射回原始分辨率
+    const cv::Mat* input = nullptr;
+    double factor = _scale < 1.0 ? 1.0 / _scale : 1.0;
+    if (frame.channels() == 3) {
+        input = &frame.downscaledImage(_scale);
+    } else {
+        cv::cvtColor(frame.downscaledGray(_scale), _color, cv::COLOR_GRAY2BGR);
+        input = &_color;
+    }
+    if (input->size() != _inputSize) {
+        _inputSize = input->size();
+        _detector->setInputSize(_inputSize);
+    }
+    _detector->detect(*input, _output);
+
+    // 每行: x, y, w, h, 5个关键点坐标, 置信度
+    _scored.clear();
+    for (int i = 0; i < _output.rows; ++i) {
+        const float* row = _output.ptr<float>(i);
+        double side = (row[2] + row[3]) * 0.5 * _config.box_scale * factor;
+        double cx = (row[0] + row[2] * 0.5) * factor;
+        double cy = (row[1] + row[3] * 0.5) * factor;
+        long left = static_cast<long>(std::lround(cx - side * 0.5));
+        long top = static_cast<long>(std::lround(cy - side * 0.5));
+        long size = std::max(1L, static_cast<long>(std::lround(side)));
+        _scored.emplace_back(row[14], dlib::rectangle(left, top, left + size - 1, top + size - 1));
+    }
+    std::sort(_scored.begin(), _scored.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    for (const auto& scored : _scored) {
+        faces.push_back(scored.second);
+    }
+#else
+    (void)frame;
+#endif
+}
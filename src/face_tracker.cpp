@@ -0,0 +1,207 @@
+#include "../include/face_tracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+FaceTracker::FaceTracker(const TrackingConfig& config)
+    : _config(config),
+      _tracking(false),
+      _calibrated(false),
+      _framesSinceDetection(0),
+      _confidence(0.0),
+      _offsetX(0.0),
+      _offsetY(0.0),
+      _scaleX(1.0),
+      _scaleY(1.0) {
+}
+
+void FaceTracker::setConfig(const TrackingConfig& config) {
+    _config = config;
+    lost();
+}
+
+const TrackingConfig& FaceTracker::getConfig() const {
+    return _config;
+}
+
+void FaceTracker::setDriverRoiConfig(const DriverRoiConfig& config) {
+    _driverRoi.setConfig(config);
+    lost();
+}
+
+const DriverRoi& FaceTracker::getDriverRoi() const {
+    return _driverRoi;
+}
+
+bool FaceTracker::locate(PreparedFrame& frame, FaceDetector& detector, dlib::rectangle& face, bool& detector_invoked) {
+    detector_invoked = false;
+    if (!needsDetection() && track(frame, face)) {
+        return true;
+    }
+
+    // 相关滤波模式之后总要用到整帧灰度图，先生成，检测区域的灰度图直接从中截取
+    if (_config.mode == TrackingMode::CORRELATION) {
+        frame.gray();
+    }
+
+    // 只在驾驶员区域内完整检测（可在缩小的图像上检测，人脸框已映射回原始分辨率）
+    detector.detect(_driverRoi.crop(frame), _faces);
+    detector_invoked = true;
+    if (!_driverRoi.select(_faces, face)) {
+        lost();
+        return false;
+    }
+
+    reset(frame, face);
+    return true;
+}
+
+bool FaceTracker::needsDetection() const {
+    if (_config.mode == TrackingMode::OFF || !_tracking) {
+        return true;
+    }
+    // 到达检测间隔时强制完整检测，纠正跟踪的累积漂移
+    return _framesSinceDetection + 1 >= _config.redetect_interval;
+}
+
+void FaceTracker::reset(PreparedFrame& frame, const dlib::rectangle& face) {
+    _tracking = _config.mode != TrackingMode::OFF;
+    _calibrated = false;
+    _framesSinceDetection = 0;
+    _confidence = std::numeric_limits<double>::max();
+    _currentBox = face;
+    _nextBox = face;
+
+    if (_config.mode == TrackingMode::CORRELATION) {
+        // 相关滤波器只需要灰度，与检测器共用本帧的灰度图
+        _correlationTracker.start_track(dlib::cv_image<unsigned char>(frame.gray()), dlib::drectangle(face));
+    }
+}
+
+bool FaceTracker::track(PreparedFrame& frame, dlib::rectangle& face) {
+    if (!_tracking) {
+        return false;
+    }
+    _framesSinceDetection++;
+
+    if (_config.mode == TrackingMode::CORRELATION) {
+        _confidence = _correlationTracker.update(dlib::cv_image<unsigned char>(frame.gray()));
+        if (_confidence < _config.min_psr) {
+            // 跟踪置信度过低，本帧改为完整检测
+            lost();
+            return false;
+        }
+        dlib::drectangle position = _correlationTracker.get_position();
+        _currentBox = dlib::rectangle(
+            static_cast<long>(std::lround(position.left())),
+            static_cast<long>(std::lround(position.top())),
+            static_cast<long>(std::lround(position.right())),
+            static_cast<long>(std::lround(position.bottom())));
+    } else {
+        _currentBox = _nextBox;
+    }
+
+    face = _currentBox;
+    return true;
+}
+
+void FaceTracker::update(const dlib::full_object_detection& shape) {
+    if (!_tracking || shape.num_parts() == 0) {
+        return;
+    }
+
+    dlib::rectangle bounds = landmarkBounds(shape);
+    if (bounds.width() < 2 || bounds.height() < 2) {
+        lost();
+        return;
+    }
+
+    if (!_calibrated) {
+        // 在完整检测的帧上记录检测框相对特征点外接矩形的关系，
+        // 之后推算的人脸框与检测器输出的框保持一致的尺度和位置
+        _offsetX = static_cast<double>(_currentBox.left() - bounds.left()) / bounds.width();
+        _offsetY = static_cast<double>(_currentBox.top() - bounds.top()) / bounds.height();
+        _scaleX = static_cast<double>(_currentBox.width()) / bounds.width();
+        _scaleY = static_cast<double>(_currentBox.height()) / bounds.height();
+        _calibrated = true;
+        _nextBox = _currentBox;
+        return;
+    }
+
+    dlib::rectangle implied = boxFromLandmarks(shape);
+
+    if (_config.mode == TrackingMode::LANDMARKS) {
+        // 输入框与特征点推算的框不一致，说明人脸移动过快或已经丢失
+        _confidence = intersectionOverUnion(_currentBox, implied);
+        if (_confidence < _config.min_iou) {
+            lost();
+            return;
+        }
+    }
+
+    _nextBox = implied;
+}
+
+void FaceTracker::lost() {
+    _tracking = false;
+    _calibrated = false;
+    _framesSinceDetection = 0;
+}
+
+double FaceTracker::getConfidence() const {
+    return _confidence;
+}
+
+TrackingMode FaceTracker::stringToMode(const std::string& mode_str) {
+    if (mode_str == "landmarks") {
+        return TrackingMode::LANDMARKS;
+    } else if (mode_str == "correlation") {
+        return TrackingMode::CORRELATION;
+    } else {
+        return TrackingMode::OFF;
+    }
+}
+
+std::string FaceTracker::modeToString(TrackingMode mode) {
+    switch (mode) {
+        case TrackingMode::LANDMARKS:
+            return "landmarks";
+        case TrackingMode::CORRELATION:
+            return "correlation";
+        default:
+            return "off";
+    }
+}
+
+dlib::rectangle FaceTracker::landmarkBounds(const dlib::full_object_detection& shape) {
+    long left = shape.part(0).x();
+    long right = left;
+    long top = shape.part(0).y();
+    long bottom = top;
+    for (unsigned long i = 1; i < shape.num_parts(); ++i) {
+        left = std::min(left, shape.part(i).x());
+        right = std::max(right, shape.part(i).x());
+        top = std::min(top, shape.part(i).y());
+        bottom = std::max(bottom, shape.part(i).y());
+    }
+    return dlib::rectangle(left, top, right, bottom);
+}
+
+dlib::rectangle FaceTracker::boxFromLandmarks(const dlib::full_object_detection& shape) const {
+    dlib::rectangle bounds = landmarkBounds(shape);
+    double left = bounds.left() + _offsetX * bounds.width();
+    double top = bounds.top() + _offsetY * bounds.height();
+    double width = _scaleX * bounds.width();
+    double height = _scaleY * bounds.height();
+    return dlib::rectangle(
+        static_cast<long>(std::lround(left)),
+        static_cast<long>(std::lround(top)),
+        static_cast<long>(std::lround(left + width)) - 1,
+        static_cast<long>(std::lround(top + height)) - 1);
+}
+
+double FaceTracker::intersectionOverUnion(const dlib::rectangle& a, const dlib::rectangle& b) {
+    double inter = a.intersect(b).area();
+    double uni = static_cast<double>(a.area()) + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0;
+}
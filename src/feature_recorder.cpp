@@ -0,0 +1,401 @@
+#include "../include/feature_recorder.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+// 使用C++17的文件系统库
+namespace fs = std::filesystem;
+
+namespace {
+
+// 文件格式
+constexpr char kFileMagic[8] = {'D', 'M', 'S', 'F', 'E', 'A', 'T', '1'};
+constexpr char kBlockMagic[4] = {'F', 'B', 'L', 'K'};
+constexpr uint32_t kFileVersion = 1;
+constexpr uint32_t kRatioScale = 10000;   // EAR/MAR量化倍数
+constexpr uint32_t kAngleScale = 100;     // 侧倾角量化倍数
+constexpr uint32_t kMaxBlockBytes = 64u << 20;
+
+void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// zigzag变换后按7位一组的变长整数编码
+void putVarint(std::vector<uint8_t>& out, int64_t value) {
+    uint64_t v = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, int64_t& value) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            value = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 差分编码一列
+template <typename Getter>
+void encodeColumn(std::vector<uint8_t>& out, size_t rows, Getter get) {
+    int64_t previous = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        int64_t value = get(i);
+        putVarint(out, value - previous);
+        previous = value;
+    }
+}
+
+// 解码一列
+template <typename Setter>
+bool decodeColumn(const uint8_t*& p, const uint8_t* end, size_t rows, Setter set) {
+    int64_t value = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        int64_t delta = 0;
+        if (!getVarint(p, end, delta)) {
+            return false;
+        }
+        value += delta;
+        set(value);
+    }
+    return true;
+}
+
+int64_t quantize(float value, uint32_t scale) {
+    return static_cast<int64_t>(std::lround(static_cast<double>(value) * scale));
+}
+
+} // namespace
+
+void FeatureColumns::append(const FeatureSample& sample) {
+    timestamp_ms.push_back(sample.timestamp_ms);
+    sequence.push_back(sample.sequence);
+    has_face.push_back(sample.has_face ? 1 : 0);
+    ear.push_back(sample.ear);
+    mar.push_back(sample.mar);
+    head_roll.push_back(sample.head_roll);
+    face_x.push_back(sample.face_x);
+    face_y.push_back(sample.face_y);
+    face_w.push_back(sample.face_w);
+    face_h.push_back(sample.face_h);
+    behavior.push_back(static_cast<uint8_t>(sample.behavior));
+}
+
+void FeatureColumns::clear() {
+    timestamp_ms.clear();
+    sequence.clear();
+    has_face.clear();
+    ear.clear();
+    mar.clear();
+    head_roll.clear();
+    face_x.clear();
+    face_y.clear();
+    face_w.clear();
+    face_h.clear();
+    behavior.clear();
+}
+
+FeatureRecorder::FeatureRecorder(const FeatureRecorderConfig& config, const std::string& name)
+    : _config(config),
+      _name(name),
+      _running(false),
+      _file(nullptr),
+      _rowsRecorded(0),
+      _rowsDropped(0),
+      _blocksWritten(0),
+      _bytesWritten(0) {
+    _config.block_rows = std::max<size_t>(1, _config.block_rows);
+    _config.queue_capacity = std::max<size_t>(2, _config.queue_capacity);
+}
+
+FeatureRecorder::~FeatureRecorder() {
+    stop();
+}
+
+bool FeatureRecorder::start() {
+    if (_running) {
+        return false;
+    }
+
+    try {
+        fs::create_directories(_config.dir);
+    } catch (const std::exception& e) {
+        std::cerr << "创建特征目录失败: " << _config.dir << " - " << e.what() << std::endl;
+        return false;
+    }
+
+    // 文件名：features_名称_日期_时间.dfc
+    std::string safe_name = _name.empty() ? "stream" : _name;
+    std::replace_if(safe_name.begin(), safe_name.end(), [](char c) {
+        return c == '/' || c == '\\' || c == ' ' || c == ':';
+    }, '_');
+    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::stringstream ss;
+    ss << _config.dir << "/features_" << safe_name << "_"
+       << std::put_time(std::localtime(&now), "%Y-%m-%d_%H-%M-%S") << ".dfc";
+    _path = ss.str();
+
+    _file = std::fopen(_path.c_str(), "wb");
+    if (!_file) {
+        std::cerr << "无法创建特征文件: " << _path << std::endl;
+        return false;
+    }
+
+    // 文件头：魔数, 版本, 量化倍数, 视频流名称
+    std::vector<uint8_t> header(kFileMagic, kFileMagic + sizeof(kFileMagic));
+    putU32(header, kFileVersion);
+    putU32(header, kRatioScale);
+    putU32(header, kAngleScale);
+    putU32(header, static_cast<uint32_t>(_name.size()));
+    header.insert(header.end(), _name.begin(), _name.end());
+    std::fwrite(header.data(), 1, header.size(), _file);
+    _bytesWritten += header.size();
+
+    _queue = std::make_unique<SpscQueue<FeatureSample>>(_config.queue_capacity);
+    _block.clear();
+    _running = true;
+    _writeThread = std::thread(&FeatureRecorder::writeLoop, this);
+
+    std::cout << "每帧特征记录到: " << _path << std::endl;
+    return true;
+}
+
+void FeatureRecorder::stop() {
+    if (!_running) {
+        return;
+    }
+
+    _running = false;
+    if (_writeThread.joinable()) {
+        _writeThread.join();
+    }
+    if (_file) {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+void FeatureRecorder::record(const FeatureSample& sample) {
+    if (!_running) {
+        return;
+    }
+    FeatureSample copy = sample;
+    if (!_queue->tryPush(std::move(copy))) {
+        _rowsDropped++;
+    }
+}
+
+FeatureSample FeatureRecorder::makeSample(uint64_t sequence, bool has_face, const dlib::rectangle& face,
+                                          const FrameFeatures& features, DriverBehavior behavior) {
+    FeatureSample sample;
+    sample.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    sample.sequence = sequence;
+    sample.has_face = has_face;
+    sample.behavior = behavior;
+    if (has_face) {
+        sample.ear = static_cast<float>(features.ear);
+        sample.mar = static_cast<float>(features.mar);
+        sample.head_roll = static_cast<float>(features.head_roll);
+        sample.face_x = static_cast<int32_t>(face.left());
+        sample.face_y = static_cast<int32_t>(face.top());
+        sample.face_w = static_cast<int32_t>(face.width());
+        sample.face_h = static_cast<int32_t>(face.height());
+    }
+    return sample;
+}
+
+FeatureRecorderStats FeatureRecorder::getStats() const {
+    FeatureRecorderStats stats;
+    stats.rows_recorded = _rowsRecorded;
+    stats.rows_dropped = _rowsDropped;
+    stats.blocks_written = _blocksWritten;
+    stats.bytes_written = _bytesWritten;
+    return stats;
+}
+
+std::string FeatureRecorder::getPath() const {
+    return _path;
+}
+
+void FeatureRecorder::writeLoop() {
+    FeatureSample sample;
+    while (true) {
+        bool running = _running;
+        bool got = false;
+        while (_queue->tryPop(sample)) {
+            got = true;
+            _block.append(sample);
+            if (_block.size() >= _config.block_rows) {
+                writeBlock();
+            }
+        }
+        if (!running) {
+            break;
+        }
+        if (!got) {
+            // 每秒只有几十行，轮询间隔远小于队列填满的时间
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    // 停止时写出不满一块的剩余行
+    writeBlock();
+    std::fflush(_file);
+}
+
+bool FeatureRecorder::writeBlock() {
+    size_t rows = _block.size();
+    if (rows == 0 || !_file) {
+        return true;
+    }
+
+    // 块头：魔数, 行数, 负载长度；负载为各列的差分编码
+    _encoded.assign(kBlockMagic, kBlockMagic + sizeof(kBlockMagic));
+    putU32(_encoded, static_cast<uint32_t>(rows));
+    putU32(_encoded, 0);
+    size_t payload_start = _encoded.size();
+
+    const FeatureColumns& b = _block;
+    encodeColumn(_encoded, rows, [&b](size_t i) { return b.timestamp_ms[i]; });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.sequence[i]); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.has_face[i]); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return quantize(b.ear[i], kRatioScale); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return quantize(b.mar[i], kRatioScale); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return quantize(b.head_roll[i], kAngleScale); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.face_x[i]); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.face_y[i]); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.face_w[i]); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.face_h[i]); });
+    encodeColumn(_encoded, rows, [&b](size_t i) { return static_cast<int64_t>(b.behavior[i]); });
+
+    uint32_t payload_size = static_cast<uint32_t>(_encoded.size() - payload_start);
+    for (int i = 0; i < 4; ++i) {
+        _encoded[payload_start - 4 + i] = static_cast<uint8_t>(payload_size >> (8 * i));
+    }
+
+    _block.clear();
+    if (std::fwrite(_encoded.data(), 1, _encoded.size(), _file) != _encoded.size()) {
+        std::cerr << "写入特征文件失败: " << _path << std::endl;
+        return false;
+    }
+    // 每块flush一次，异常退出时最多丢失一块
+    std::fflush(_file);
+    _rowsRecorded += rows;
+    _blocksWritten++;
+    _bytesWritten += _encoded.size();
+    return true;
+}
+
+bool FeatureLogReader::read(const std::string& path, FeatureColumns& columns, std::string* name) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "无法打开特征文件: " << path << std::endl;
+        return false;
+    }
+
+    uint8_t header[sizeof(kFileMagic) + 16];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, kFileMagic, sizeof(kFileMagic)) != 0 ||
+        getU32(header + 8) != kFileVersion) {
+        std::cerr << "无效的特征文件: " << path << std::endl;
+        return false;
+    }
+    double ratio_scale = getU32(header + 12);
+    double angle_scale = getU32(header + 16);
+    uint32_t name_size = getU32(header + 20);
+    if (ratio_scale <= 0 || angle_scale <= 0 || name_size > 4096) {
+        std::cerr << "无效的特征文件: " << path << std::endl;
+        return false;
+    }
+    std::string stream_name(name_size, '\0');
+    if (!in.read(&stream_name[0], name_size)) {
+        return false;
+    }
+    if (name) {
+        *name = stream_name;
+    }
+
+    std::vector<uint8_t> payload;
+    uint8_t block_header[12];
+    while (in.read(reinterpret_cast<char*>(block_header), sizeof(block_header))) {
+        if (std::memcmp(block_header, kBlockMagic, sizeof(kBlockMagic)) != 0) {
+            std::cerr << "特征文件数据块损坏，停止读取: " << path << std::endl;
+            break;
+        }
+        uint32_t rows = getU32(block_header + 4);
+        uint32_t size = getU32(block_header + 8);
+        if (size > kMaxBlockBytes) {
+            break;
+        }
+        payload.resize(size);
+        if (!in.read(reinterpret_cast<char*>(payload.data()), size)) {
+            break;   // 末尾不完整的块
+        }
+
+        const uint8_t* p = payload.data();
+        const uint8_t* end = p + payload.size();
+        FeatureColumns& c = columns;
+        auto ratio = [ratio_scale](int64_t v) { return static_cast<float>(v / ratio_scale); };
+        auto angle = [angle_scale](int64_t v) { return static_cast<float>(v / angle_scale); };
+        bool ok =
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.timestamp_ms.push_back(v); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.sequence.push_back(static_cast<uint64_t>(v)); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.has_face.push_back(static_cast<uint8_t>(v)); }) &&
+            decodeColumn(p, end, rows, [&c, &ratio](int64_t v) { c.ear.push_back(ratio(v)); }) &&
+            decodeColumn(p, end, rows, [&c, &ratio](int64_t v) { c.mar.push_back(ratio(v)); }) &&
+            decodeColumn(p, end, rows, [&c, &angle](int64_t v) { c.head_roll.push_back(angle(v)); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.face_x.push_back(static_cast<int32_t>(v)); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.face_y.push_back(static_cast<int32_t>(v)); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.face_w.push_back(static_cast<int32_t>(v)); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.face_h.push_back(static_cast<int32_t>(v)); }) &&
+            decodeColumn(p, end, rows, [&c](int64_t v) { c.behavior.push_back(static_cast<uint8_t>(v)); });
+        if (!ok) {
+            std::cerr << "特征文件数据块损坏，停止读取: " << path << std::endl;
+            break;
+        }
+    }
+
+    // 损坏的块可能只解码了部分列，按最短的列对齐
+    size_t rows = std::min({columns.timestamp_ms.size(), columns.sequence.size(), columns.has_face.size(),
+                            columns.ear.size(), columns.mar.size(), columns.head_roll.size(),
+                            columns.face_x.size(), columns.face_y.size(), columns.face_w.size(),
+                            columns.face_h.size(), columns.behavior.size()});
+    columns.timestamp_ms.resize(rows);
+    columns.sequence.resize(rows);
+    columns.has_face.resize(rows);
+    columns.ear.resize(rows);
+    columns.mar.resize(rows);
+    columns.head_roll.resize(rows);
+    columns.face_x.resize(rows);
+    columns.face_y.resize(rows);
+    columns.face_w.resize(rows);
+    columns.face_h.resize(rows);
+    columns.behavior.resize(rows);
+    return true;
+}
@@ -0,0 +1,65 @@
+#include "../include/frame_annotator.hpp"
+#include "../include/driver_monitor.hpp"
+#include <algorithm>
+#include <string>
+
+void FrameAnnotator::annotate(cv::Mat& frame, bool has_face, const dlib::rectangle& face,
+                              const dlib::full_object_detection& shape, DriverBehavior behavior) {
+    if (frame.empty()) {
+        return;
+    }
+
+    if (has_face) {
+        // 在图像上绘制人脸特征点
+        for (unsigned long i = 0; i < shape.num_parts(); ++i) {
+            cv::circle(frame, cv::Point(shape.part(i).x(), shape.part(i).y()), 2, cv::Scalar(0, 255, 0), -1);
+        }
+
+        // 绘制人脸框
+        cv::rectangle(frame,
+                      cv::Point(face.left(), face.top()),
+                      cv::Point(face.right(), face.bottom()),
+                      cv::Scalar(0, 255, 0), 2);
+    }
+
+    // 在图像上显示当前行为和提示信息（只复制文字像素）
+    const LabelOverlay& label = overlay(behavior, frame);
+    cv::Rect roi(0, 0, frame.cols, std::min(kLabelHeight, frame.rows));
+    cv::Mat target = frame(roi);
+    label.image(roi).copyTo(target, label.mask(roi));
+}
+
+const FrameAnnotator::LabelOverlay& FrameAnnotator::overlay(DriverBehavior behavior, const cv::Mat& frame) {
+    size_t index = std::min(static_cast<size_t>(behavior), kBehaviorCount - 1);
+    LabelOverlay& label = _overlays[index];
+    if (label.image.cols == frame.cols && label.image.type() == frame.type()) {
+        return label;
+    }
+
+    // 与原来直接在帧上绘制的位置、字体和颜色相同
+    label.image = cv::Mat::zeros(kLabelHeight, frame.cols, frame.type());
+    cv::putText(label.image,
+                "行为: " + DriverMonitor::behaviorToString(behavior),
+                cv::Point(10, 30),
+                cv::FONT_HERSHEY_SIMPLEX,
+                0.7,
+                cv::Scalar(0, 0, 255),
+                2);
+    cv::putText(label.image,
+                "提示: " + DriverMonitor::getBehaviorMessage(behavior),
+                cv::Point(10, 60),
+                cv::FONT_HERSHEY_SIMPLEX,
+                0.5,
+                cv::Scalar(0, 0, 255),
+                1);
+
+    // 掩码：文字像素（任一通道非零）
+    cv::Mat gray;
+    if (label.image.channels() == 3) {
+        cv::cvtColor(label.image, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = label.image;
+    }
+    cv::threshold(gray, label.mask, 0, 255, cv::THRESH_BINARY);
+    return label;
+}
@@ -0,0 +1,182 @@
+#include "../include/frame_pool.hpp"
+#include <iostream>
+
+FrameHandle::FrameHandle(FrameBuffer* buffer)
+    : _buffer(buffer) {
+}
+
+FrameHandle::FrameHandle(const FrameHandle& other)
+    : _buffer(other._buffer) {
+    if (_buffer) {
+        _buffer->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameHandle::FrameHandle(FrameHandle&& other) noexcept
+    : _buffer(other._buffer) {
+    other._buffer = nullptr;
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) {
+    if (this != &other) {
+        if (other._buffer) {
+            other._buffer->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        reset();
+        _buffer = other._buffer;
+    }
+    return *this;
+}
+
+FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        _buffer = other._buffer;
+        other._buffer = nullptr;
+    }
+    return *this;
+}
+
+FrameHandle::~FrameHandle() {
+    reset();
+}
+
+bool FrameHandle::empty() const {
+    return !_buffer || _buffer->image.empty();
+}
+
+const cv::Mat& FrameHandle::image() const {
+    static const cv::Mat empty_image;
+    return _buffer ? _buffer->image : empty_image;
+}
+
+cv::Mat& FrameHandle::mutableImage() {
+    return _buffer->image;
+}
+
+int FrameHandle::useCount() const {
+    return _buffer ? _buffer->refs.load(std::memory_order_relaxed) : 0;
+}
+
+void FrameHandle::reset() {
+    if (!_buffer) {
+        return;
+    }
+    // 最后一个引用释放时，之前所有持有者的写入都已完成
+    if (_buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        FramePool::recycle(_buffer);
+    }
+    _buffer = nullptr;
+}
+
+FramePool::FramePool(size_t capacity, int width, int height, int type)
+    : _core(std::make_shared<FramePoolCore>()),
+      _width(width),
+      _height(height),
+      _type(type),
+      _acquisitions(0),
+      _poolMisses(0),
+      _bytesCopied(0) {
+    if (capacity == 0) {
+        capacity = 1;
+    }
+    _core->buffers.reserve(capacity * 2);
+    _core->free.reserve(capacity * 2);
+    for (size_t i = 0; i < capacity; ++i) {
+        FrameBuffer* buffer = allocate();
+        _core->buffers.push_back(buffer);
+        _core->free.push_back(buffer);
+    }
+}
+
+FramePool::~FramePool() {
+    // 只释放空闲列表中的缓冲；仍有句柄引用（包括引用计数刚归零、正在归还）的缓冲
+    // 由最后一个句柄在同一把锁下看到closed后释放
+    std::lock_guard<std::mutex> lock(_core->mutex);
+    _core->closed = true;
+    for (FrameBuffer* buffer : _core->free) {
+        delete buffer;
+    }
+    _core->free.clear();
+    _core->buffers.clear();
+}
+
+FrameHandle FramePool::acquire() {
+    _acquisitions++;
+
+    FrameBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_core->mutex);
+        if (!_core->free.empty()) {
+            buffer = _core->free.back();
+            _core->free.pop_back();
+        } else {
+            buffer = allocate();
+            _core->buffers.push_back(buffer);
+            _core->free.reserve(_core->buffers.size());
+            _poolMisses++;
+        }
+    }
+
+    buffer->refs.store(1, std::memory_order_relaxed);
+    return FrameHandle(buffer);
+}
+
+FrameHandle FramePool::copyOf(const cv::Mat& image) {
+    FrameHandle handle = acquire();
+    image.copyTo(handle.mutableImage());
+    recordCopy(image.total() * image.elemSize());
+    return handle;
+}
+
+void FramePool::recordCopy(size_t bytes) {
+    _bytesCopied += bytes;
+}
+
+FramePoolStats FramePool::getStats() const {
+    FramePoolStats stats;
+    {
+        std::lock_guard<std::mutex> lock(_core->mutex);
+        stats.capacity = _core->buffers.size();
+        stats.in_use = _core->buffers.size() - _core->free.size();
+    }
+    stats.acquisitions = _acquisitions;
+    stats.pool_misses = _poolMisses;
+    stats.bytes_copied = _bytesCopied;
+    return stats;
+}
+
+void FramePool::recycle(FrameBuffer* buffer) {
+    // 先取得共享状态的引用：缓冲被释放后锁仍然有效
+    std::shared_ptr<FramePoolCore> core = buffer->core;
+    std::lock_guard<std::mutex> lock(core->mutex);
+    if (core->closed) {
+        delete buffer;
+    } else {
+        core->free.push_back(buffer);
+    }
+}
+
+FrameBuffer* FramePool::allocate() {
+    FrameBuffer* buffer = new FrameBuffer();
+    if (_width > 0 && _height > 0) {
+        buffer->image.create(_height, _width, _type);
+    }
+    buffer->core = _core;
+    return buffer;
+}
+
+void FramePool::adoptFormat(const cv::Mat& image) {
+    std::lock_guard<std::mutex> lock(_core->mutex);
+    if (image.cols == _width && image.rows == _height && image.type() == _type) {
+        return;
+    }
+    _width = image.cols;
+    _height = image.rows;
+    _type = image.type();
+
+    // 正在使用的缓冲等下次读入时再调整
+    for (FrameBuffer* buffer : _core->free) {
+        buffer->image.create(_height, _width, _type);
+    }
+}
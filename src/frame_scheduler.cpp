@@ -0,0 +1,113 @@
+#include "../include/frame_scheduler.hpp"
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+FrameScheduler::FrameScheduler(double target_fps)
+    : _targetFps(0.0),
+      _period(Clock::duration::zero()),
+      _started(false),
+      _framesScheduled(0),
+      _framesSkipped(0),
+      _latenessMean(0.0),
+      _latenessM2(0.0),
+      _maxLateness(0.0),
+      _framesCaptured(0) {
+    setTargetFps(target_fps);
+}
+
+void FrameScheduler::setTargetFps(double target_fps) {
+    // 运行中可能由采集线程修改（配置热加载），与getStats互斥
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _targetFps = target_fps > 0 ? target_fps : 0.0;
+    if (_targetFps > 0) {
+        _period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / _targetFps));
+    } else {
+        _period = Clock::duration::zero();
+    }
+}
+
+double FrameScheduler::getTargetFps() const {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    return _targetFps;
+}
+
+void FrameScheduler::reset() {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _startTime = Clock::now();
+    _nextDeadline = _startTime;
+    _started = true;
+    _framesScheduled = 0;
+    _framesSkipped = 0;
+    _latenessMean = 0.0;
+    _latenessM2 = 0.0;
+    _maxLateness = 0.0;
+    _framesCaptured = 0;
+}
+
+int FrameScheduler::waitNextFrame() {
+    if (!_started) {
+        reset();
+    }
+
+    int skipped = 0;
+    double lateness_ms = 0.0;
+
+    if (_period > Clock::duration::zero()) {
+        // 未到截止时间则睡眠到截止时间
+        if (Clock::now() < _nextDeadline) {
+            std::this_thread::sleep_until(_nextDeadline);
+        }
+
+        Clock::time_point now = Clock::now();
+        lateness_ms = std::chrono::duration<double, std::milli>(now - _nextDeadline).count();
+
+        // 已经错过一个或多个完整周期：跳过这些周期，而不是连续补帧
+        if (now - _nextDeadline >= _period) {
+            skipped = static_cast<int>((now - _nextDeadline) / _period);
+            _nextDeadline += _period * skipped;
+            lateness_ms = std::chrono::duration<double, std::milli>(now - _nextDeadline).count();
+        }
+        _nextDeadline += _period;
+    }
+
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _framesScheduled++;
+    _framesSkipped += skipped;
+
+    double delta = lateness_ms - _latenessMean;
+    _latenessMean += delta / _framesScheduled;
+    _latenessM2 += delta * (lateness_ms - _latenessMean);
+    _maxLateness = std::max(_maxLateness, lateness_ms);
+
+    return skipped;
+}
+
+void FrameScheduler::frameCaptured() {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _lastCapture = Clock::now();
+    if (_framesCaptured++ == 0) {
+        _firstCapture = _lastCapture;
+    }
+}
+
+SchedulerStats FrameScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    SchedulerStats stats;
+    stats.frames_scheduled = _framesScheduled;
+    stats.frames_skipped = _framesSkipped;
+    stats.frames_captured = _framesCaptured;
+    stats.target_fps = _targetFps;
+    stats.max_lateness_ms = _maxLateness;
+
+    // 只统计成功采集的帧，帧源卡住时实际帧率随之下降
+    double elapsed = std::chrono::duration<double>(_lastCapture - _firstCapture).count();
+    if (_framesCaptured > 1 && elapsed > 0) {
+        stats.achieved_fps = (_framesCaptured - 1) / elapsed;
+    }
+    if (_framesScheduled > 1) {
+        stats.jitter_ms = std::sqrt(_latenessM2 / (_framesScheduled - 1));
+    }
+    return stats;
+}
@@ -0,0 +1,326 @@
+#include "../include/frame_source.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+// 使用C++17的文件系统库
+namespace fs = std::filesystem;
+
+std::unique_ptr<FrameSource> FrameSource::create(const FrameSourceConfig& config) {
+    switch (config.type) {
+        case FrameSourceType::CAMERA:
+            return std::make_unique<CameraFrameSource>(config);
+        case FrameSourceType::VIDEO_FILE:
+            return std::make_unique<VideoFileFrameSource>(config);
+        case FrameSourceType::IMAGE_SEQUENCE:
+            return std::make_unique<ImageSequenceFrameSource>(config);
+        case FrameSourceType::SYNTHETIC:
+            return std::make_unique<SyntheticFrameSource>(config);
+        default:
+            return nullptr;
+    }
+}
+
+FrameSourceType FrameSource::stringToType(const std::string& type_str) {
+    if (type_str == "video") {
+        return FrameSourceType::VIDEO_FILE;
+    } else if (type_str == "images") {
+        return FrameSourceType::IMAGE_SEQUENCE;
+    } else if (type_str == "synthetic") {
+        return FrameSourceType::SYNTHETIC;
+    } else {
+        return FrameSourceType::CAMERA;
+    }
+}
+
+std::string FrameSource::typeToString(FrameSourceType type) {
+    switch (type) {
+        case FrameSourceType::CAMERA:
+            return "camera";
+        case FrameSourceType::VIDEO_FILE:
+            return "video";
+        case FrameSourceType::IMAGE_SEQUENCE:
+            return "images";
+        case FrameSourceType::SYNTHETIC:
+            return "synthetic";
+        default:
+            return "camera";
+    }
+}
+
+void FrameSource::skip(int frames) {
+    // 默认实现：读取并丢弃
+    cv::Mat discarded;
+    for (int i = 0; i < frames && read(discarded); ++i) {
+    }
+}
+
+// ---------------- 摄像头 ----------------
+
+CameraFrameSource::CameraFrameSource(const FrameSourceConfig& config)
+    : _config(config) {
+}
+
+CameraFrameSource::~CameraFrameSource() {
+    release();
+}
+
+bool CameraFrameSource::open() {
+    _camera.open(_config.device_id);
+    if (!_camera.isOpened()) {
+        std::cerr << "无法打开摄像头 ID: " << _config.device_id << std::endl;
+        return false;
+    }
+
+    // 设置摄像头参数
+    _camera.set(cv::CAP_PROP_FRAME_WIDTH, _config.width);
+    _camera.set(cv::CAP_PROP_FRAME_HEIGHT, _config.height);
+    _camera.set(cv::CAP_PROP_FPS, _config.fps);
+    
+    // 只保留最新的一帧缓冲，避免读取到驱动中积压的旧帧
+    _camera.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    return true;
+}
+
+bool CameraFrameSource::read(cv::Mat& frame) {
+    return _camera.read(frame);
+}
+
+void CameraFrameSource::skip(int frames) {
+    // 摄像头按自身帧率出帧且只缓冲最新一帧，错过的帧已经被驱动丢弃，
+    // 这里再grab只会阻塞等待新帧，因此什么也不做
+    (void)frames;
+}
+
+void CameraFrameSource::release() {
+    if (_camera.isOpened()) {
+        _camera.release();
+    }
+}
+
+bool CameraFrameSource::isOpened() const {
+    return _camera.isOpened();
+}
+
+std::string CameraFrameSource::describe() const {
+    return "摄像头 ID: " + std::to_string(_config.device_id);
+}
+
+// ---------------- 视频文件 ----------------
+
+VideoFileFrameSource::VideoFileFrameSource(const FrameSourceConfig& config)
+    : _config(config),
+      _exhausted(false) {
+}
+
+VideoFileFrameSource::~VideoFileFrameSource() {
+    release();
+}
+
+bool VideoFileFrameSource::open() {
+    _video.open(_config.path);
+    if (!_video.isOpened()) {
+        std::cerr << "无法打开视频文件: " << _config.path << std::endl;
+        return false;
+    }
+    _exhausted = false;
+    return true;
+}
+
+bool VideoFileFrameSource::read(cv::Mat& frame) {
+    if (_exhausted) {
+        return false;
+    }
+
+    if (_video.read(frame)) {
+        return true;
+    }
+
+    // 视频读完后按配置决定是否从头循环
+    if (_config.loop && _video.set(cv::CAP_PROP_POS_FRAMES, 0) && _video.read(frame)) {
+        return true;
+    }
+
+    _exhausted = true;
+    return false;
+}
+
+void VideoFileFrameSource::skip(int frames) {
+    // 只grab不解码到输出图像，跳帧开销更小
+    for (int i = 0; i < frames && !_exhausted; ++i) {
+        if (!_video.grab()) {
+            if (!_config.loop || !_video.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+                _exhausted = true;
+            }
+        }
+    }
+}
+
+void VideoFileFrameSource::release() {
+    if (_video.isOpened()) {
+        _video.release();
+    }
+}
+
+bool VideoFileFrameSource::isOpened() const {
+    return _video.isOpened();
+}
+
+std::string VideoFileFrameSource::describe() const {
+    return "视频文件: " + _config.path;
+}
+
+// ---------------- 图像目录 ----------------
+
+ImageSequenceFrameSource::ImageSequenceFrameSource(const FrameSourceConfig& config)
+    : _config(config),
+      _index(0),
+      _opened(false),
+      _exhausted(false) {
+}
+
+bool ImageSequenceFrameSource::open() {
+    _files.clear();
+    try {
+        for (const auto& entry : fs::directory_iterator(_config.path)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp") {
+                _files.push_back(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "无法读取图像目录: " << _config.path << " - " << e.what() << std::endl;
+        return false;
+    }
+
+    if (_files.empty()) {
+        std::cerr << "图像目录中没有图像文件: " << _config.path << std::endl;
+        return false;
+    }
+
+    // 按文件名排序，保证回放顺序确定
+    std::sort(_files.begin(), _files.end());
+    _index = 0;
+    _opened = true;
+    _exhausted = false;
+    return true;
+}
+
+bool ImageSequenceFrameSource::read(cv::Mat& frame) {
+    if (!_opened || _exhausted) {
+        return false;
+    }
+
+    // 循环回放时最多连续尝试一整轮：目录中没有一个文件能解码时结束，而不是一直重试
+    size_t failures = 0;
+    while ((_index < _files.size() || (_config.loop && !_files.empty())) && failures < _files.size()) {
+        if (_index >= _files.size()) {
+            _index = 0;
+        }
+        // 先读入复用的文件缓冲再解码到frame，尺寸一致时解码直接写入frame已有的内存
+        if (readFile(_files[_index++]) && !cv::imdecode(_fileBuffer, cv::IMREAD_COLOR, &frame).empty()) {
+            return true;
+        }
+        std::cerr << "无法读取图像: " << _files[_index - 1] << std::endl;
+        failures++;
+    }
+
+    _exhausted = true;
+    return false;
+}
+
+bool ImageSequenceFrameSource::readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    _fileBuffer.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(_fileBuffer.data()), size));
+}
+
+void ImageSequenceFrameSource::release() {
+    _files.clear();
+    _fileBuffer.clear();
+    _fileBuffer.shrink_to_fit();
+    _opened = false;
+}
+
+bool ImageSequenceFrameSource::isOpened() const {
+    return _opened;
+}
+
+std::string ImageSequenceFrameSource::describe() const {
+    return "图像目录: " + _config.path + " (" + std::to_string(_files.size()) + " 张)";
+}
+
+// ---------------- 合成帧 ----------------
+
+SyntheticFrameSource::SyntheticFrameSource(const FrameSourceConfig& config)
+    : _config(config),
+      _frameIndex(0),
+      _opened(false),
+      _exhausted(false) {
+}
+
+bool SyntheticFrameSource::open() {
+    // 固定种子的噪声背景，保证每次运行生成的帧完全相同
+    _background.create(_config.height, _config.width, CV_8UC3);
+    cv::RNG rng(12345);
+    rng.fill(_background, cv::RNG::UNIFORM, cv::Scalar(40, 40, 40), cv::Scalar(90, 90, 90));
+
+    _frameIndex = 0;
+    _opened = true;
+    _exhausted = false;
+    return true;
+}
+
+bool SyntheticFrameSource::read(cv::Mat& frame) {
+    if (!_opened || _exhausted) {
+        return false;
+    }
+
+    if (_config.synthetic_frames > 0 && _frameIndex >= _config.synthetic_frames) {
+        if (!_config.loop) {
+            _exhausted = true;
+            return false;
+        }
+        _frameIndex = 0;
+    }
+
+    // 在背景上绘制一个缓慢移动的"头部"椭圆，模拟驾驶员轻微晃动
+    _background.copyTo(frame);
+    double phase = _frameIndex * 0.05;
+    int cx = _config.width / 2 + static_cast<int>(std::sin(phase) * _config.width * 0.05);
+    int cy = _config.height / 2 + static_cast<int>(std::cos(phase * 0.7) * _config.height * 0.03);
+    int radius = std::min(_config.width, _config.height) / 5;
+    cv::circle(frame, cv::Point(cx, cy), radius, cv::Scalar(140, 170, 200), -1);
+    cv::circle(frame, cv::Point(cx - radius / 3, cy - radius / 4), radius / 8, cv::Scalar(30, 30, 30), -1);
+    cv::circle(frame, cv::Point(cx + radius / 3, cy - radius / 4), radius / 8, cv::Scalar(30, 30, 30), -1);
+
+    ++_frameIndex;
+    return true;
+}
+
+void SyntheticFrameSource::release() {
+    _background.release();
+    _opened = false;
+}
+
+bool SyntheticFrameSource::isOpened() const {
+    return _opened;
+}
+
+std::string SyntheticFrameSource::describe() const {
+    return "合成帧 " + std::to_string(_config.width) + "x" + std::to_string(_config.height);
+}
@@ -0,0 +1,58 @@
+#include "../include/landmark_features.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace landmark_index;
+
+void LandmarkFeatureKernel::load(const dlib::full_object_detection& shape, LandmarkBuffer& buffer) {
+    const int parts = static_cast<int>(std::min<unsigned long>(shape.num_parts(), kNumLandmarks));
+    for (int i = 0; i < parts; ++i) {
+        const dlib::point& p = shape.part(i);
+        buffer.x[i] = static_cast<float>(p.x());
+        buffer.y[i] = static_cast<float>(p.y());
+    }
+    for (int i = parts; i < kNumLandmarks; ++i) {
+        buffer.x[i] = 0.0f;
+        buffer.y[i] = 0.0f;
+    }
+}
+
+LandmarkFeatures LandmarkFeatureKernel::compute(const LandmarkBuffer& buffer) {
+    // 按索引表取出所有点对的坐标差
+    alignas(32) float dx[kPairCount];
+    alignas(32) float dy[kPairCount];
+    for (int i = 0; i < kPairCount; ++i) {
+        dx[i] = buffer.x[kPairFrom[i]] - buffer.x[kPairTo[i]];
+        dy[i] = buffer.y[kPairFrom[i]] - buffer.y[kPairTo[i]];
+    }
+
+    // 一次求出全部距离
+    alignas(32) float dist[kPairCount];
+    for (int i = 0; i < kPairCount; ++i) {
+        dist[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+    }
+
+    // EAR = (||p2-p6|| + ||p3-p5||) / (2 * ||p1-p4||)，MAR同理；宽度过小时为0（与原实现一致）
+    LandmarkFeatures features;
+    features.ear_left = dist[LEFT_EYE_H] < 0.1f ? 0.0f
+        : (dist[LEFT_EYE_V1] + dist[LEFT_EYE_V2]) / (2.0f * dist[LEFT_EYE_H]);
+    features.ear_right = dist[RIGHT_EYE_H] < 0.1f ? 0.0f
+        : (dist[RIGHT_EYE_V1] + dist[RIGHT_EYE_V2]) / (2.0f * dist[RIGHT_EYE_H]);
+    features.ear = (features.ear_left + features.ear_right) * 0.5f;
+    features.mar = dist[MOUTH_H] < 0.1f ? 0.0f
+        : (dist[MOUTH_V_OUTER] + dist[MOUTH_V_INNER]) / (2.0f * dist[MOUTH_H]);
+
+    // 侧倾角：右外眼角相对左外眼角
+    const int left = kPairFrom[EYE_CORNERS];
+    const int right = kPairTo[EYE_CORNERS];
+    features.head_roll = std::atan2(buffer.y[right] - buffer.y[left], buffer.x[right] - buffer.x[left]) *
+                         static_cast<float>(180.0 / M_PI);
+    features.face_size = dist[EYE_CORNERS];
+    return features;
+}
+
+LandmarkFeatures LandmarkFeatureKernel::compute(const dlib::full_object_detection& shape) {
+    LandmarkBuffer buffer;
+    load(shape, buffer);
+    return compute(buffer);
+}
@@ -0,0 +1,269 @@
+#include "../include/landmark_predictor.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <dlib/opencv.h>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 每个线程复用的临时缓冲
+struct PredictScratch {
+    std::vector<float> shape;
+    std::vector<int16_t> pixels;
+    std::vector<const float*> leaves;
+};
+
+thread_local PredictScratch t_scratch;
+
+// float阈值换成等价的int16阈值（两像素之差在 [-255, 255] 之间）
+int16_t quantizeThreshold(float thresh) {
+    if (std::isnan(thresh)) {
+        return 255;     // d > NaN 恒为假
+    }
+    float t = std::floor(thresh);
+    return static_cast<int16_t>(std::min(255.0f, std::max(-256.0f, t)));
+}
+
+// shape[i] += leaves[0][i] + leaves[1][i] + ...（按树的顺序逐棵相加，与dlib的累加顺序一致）
+// 每段形状坐标留在寄存器里累加完全部回归树再写回
+void accumulateLeaves(float* shape, const float* const* leaves, size_t tree_count, size_t length) {
+    size_t i = 0;
+#if defined(__AVX__)
+    for (; i + 8 <= length; i += 8) {
+        __m256 acc = _mm256_loadu_ps(shape + i);
+        for (size_t t = 0; t < tree_count; ++t) {
+            acc = _mm256_add_ps(acc, _mm256_loadu_ps(leaves[t] + i));
+        }
+        _mm256_storeu_ps(shape + i, acc);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 4 <= length; i += 4) {
+        __m128 acc = _mm_loadu_ps(shape + i);
+        for (size_t t = 0; t < tree_count; ++t) {
+            acc = _mm_add_ps(acc, _mm_loadu_ps(leaves[t] + i));
+        }
+        _mm_storeu_ps(shape + i, acc);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= length; i += 4) {
+        float32x4_t acc = vld1q_f32(shape + i);
+        for (size_t t = 0; t < tree_count; ++t) {
+            acc = vaddq_f32(acc, vld1q_f32(leaves[t] + i));
+        }
+        vst1q_f32(shape + i, acc);
+    }
+#endif
+    for (; i < length; ++i) {
+        float acc = shape[i];
+        for (size_t t = 0; t < tree_count; ++t) {
+            acc += leaves[t][i];
+        }
+        shape[i] = acc;
+    }
+}
+
+// 与dlib一致：浮点坐标四舍五入到像素
+long roundToPixel(double v) {
+    return static_cast<long>(std::floor(v + 0.5));
+}
+
+} // namespace
+
+FlatShapePredictor::FlatShapePredictor(std::shared_ptr<const FlatShapeModel> model)
+    : _model(std::move(model)),
+      _landmarks(_model->numLandmarks()),
+      _cascades(_model->numCascades()),
+      _trees(_model->treesPerCascade()),
+      _pixels(_model->pixelsPerCascade()),
+      _depth(_model->treeDepth()),
+      _splitsPerTree(_model->splitsPerTree()),
+      _centeredNorm(0.0) {
+    // 平均形状（映射时已校验各段范围和编号）
+    const float* initial = _model->initialShape();
+    _initialShape.assign(initial, initial + 2 * _landmarks);
+    double mean_x = 0.0, mean_y = 0.0;
+    for (uint32_t i = 0; i < _landmarks; ++i) {
+        mean_x += initial[2 * i];
+        mean_y += initial[2 * i + 1];
+    }
+    mean_x /= _landmarks;
+    mean_y /= _landmarks;
+    _centeredShape.resize(2 * _landmarks);
+    for (uint32_t i = 0; i < _landmarks; ++i) {
+        _centeredShape[2 * i] = initial[2 * i] - mean_x;
+        _centeredShape[2 * i + 1] = initial[2 * i + 1] - mean_y;
+        _centeredNorm += _centeredShape[2 * i] * _centeredShape[2 * i] +
+                         _centeredShape[2 * i + 1] * _centeredShape[2 * i + 1];
+    }
+
+    // 采样点拆成结构数组
+    const size_t pixel_count = size_t(_cascades) * _pixels;
+    _anchors.resize(pixel_count);
+    _deltaX.resize(pixel_count);
+    _deltaY.resize(pixel_count);
+    for (uint32_t c = 0; c < _cascades; ++c) {
+        const uint32_t* anchors = _model->anchors(c);
+        const float* deltas = _model->deltas(c);
+        for (uint32_t p = 0; p < _pixels; ++p) {
+            size_t k = size_t(c) * _pixels + p;
+            _anchors[k] = static_cast<uint16_t>(anchors[p]);
+            _deltaX[k] = deltas[2 * p];
+            _deltaY[k] = deltas[2 * p + 1];
+        }
+    }
+
+    // 分裂节点拆成结构数组，同一棵树的节点连续存放
+    const size_t split_count = size_t(_cascades) * _trees * _splitsPerTree;
+    _splitIdx1.resize(split_count);
+    _splitIdx2.resize(split_count);
+    _splitThresh.resize(split_count);
+    const FlatSplit* splits = _model->splits(0, 0);
+    for (size_t i = 0; i < split_count; ++i) {
+        _splitIdx1[i] = static_cast<uint16_t>(splits[i].idx1);
+        _splitIdx2[i] = static_cast<uint16_t>(splits[i].idx2);
+        _splitThresh[i] = quantizeThreshold(splits[i].thresh);
+    }
+}
+
+void FlatShapePredictor::samplePixels(const cv::Mat& image, const dlib::rectangle& face, uint32_t cascade,
+                                      const float* shape, int16_t* pixels) const {
+    // 当前形状相对平均形状的相似变换（只用到旋转和缩放部分）：
+    // 最小化 sum |sR*x_i - y_i|^2，sR = [a -b; b a]，a、b 分别为去中心化坐标的点积和叉积之和除以平方和
+    float m00 = 1.0f, m01 = 0.0f, m10 = 0.0f, m11 = 1.0f;
+    if (_landmarks > 1 && _centeredNorm > 0.0) {
+        double mean_x = 0.0, mean_y = 0.0;
+        for (uint32_t i = 0; i < _landmarks; ++i) {
+            mean_x += shape[2 * i];
+            mean_y += shape[2 * i + 1];
+        }
+        mean_x /= _landmarks;
+        mean_y /= _landmarks;
+        double dot = 0.0, cross = 0.0;
+        for (uint32_t i = 0; i < _landmarks; ++i) {
+            double fx = _centeredShape[2 * i];
+            double fy = _centeredShape[2 * i + 1];
+            double tx = shape[2 * i] - mean_x;
+            double ty = shape[2 * i + 1] - mean_y;
+            dot += fx * tx + fy * ty;
+            cross += fx * ty - fy * tx;
+        }
+        m00 = m11 = static_cast<float>(dot / _centeredNorm);
+        m10 = static_cast<float>(cross / _centeredNorm);
+        m01 = -m10;
+    }
+
+    // 归一化坐标到图像坐标：人脸框左上角为(0,0)、右下角为(1,1)
+    const double left = static_cast<double>(face.left());
+    const double top = static_cast<double>(face.top());
+    const double width = static_cast<double>(face.right() - face.left());
+    const double height = static_cast<double>(face.bottom() - face.top());
+    const long cols = image.cols;
+    const long rows = image.rows;
+    const bool color = image.channels() == 3;
+
+    const size_t base = size_t(cascade) * _pixels;
+    const uint16_t* anchors = _anchors.data() + base;
+    const float* delta_x = _deltaX.data() + base;
+    const float* delta_y = _deltaY.data() + base;
+    for (uint32_t p = 0; p < _pixels; ++p) {
+        const uint32_t anchor = anchors[p];
+        float sx = (m00 * delta_x[p] + m01 * delta_y[p]) + shape[2 * anchor];
+        float sy = (m10 * delta_x[p] + m11 * delta_y[p]) + shape[2 * anchor + 1];
+        long x = roundToPixel(left + width * sx);
+        long y = roundToPixel(top + height * sy);
+        if (x < 0 || y < 0 || x >= cols || y >= rows) {
+            pixels[p] = 0;
+        } else if (color) {
+            // dlib对BGR像素取三个通道的平均值作为灰度
+            const uint8_t* px = image.ptr<uint8_t>(static_cast<int>(y)) + 3 * x;
+            pixels[p] = static_cast<int16_t>((static_cast<unsigned>(px[0]) + px[1] + px[2]) / 3);
+        } else {
+            pixels[p] = image.ptr<uint8_t>(static_cast<int>(y))[x];
+        }
+    }
+}
+
+void FlatShapePredictor::predict(const cv::Mat& image, const dlib::rectangle& face,
+                                 dlib::full_object_detection& shape) const {
+    PredictScratch& scratch = t_scratch;
+    const size_t length = 2 * size_t(_landmarks);
+    scratch.shape.assign(_initialShape.begin(), _initialShape.end());
+    scratch.pixels.resize(_pixels);
+    scratch.leaves.resize(_trees);
+    float* current = scratch.shape.data();
+    int16_t* pixels = scratch.pixels.data();
+
+    for (uint32_t c = 0; c < _cascades; ++c) {
+        // 本层全部采样像素一次算完
+        samplePixels(image, face, c, current, pixels);
+
+        // 逐棵树走到叶子：节点i的左右子节点为 2i+1 / 2i+2，像素差大于阈值时走左子树
+        const size_t cascade_base = size_t(c) * _trees * _splitsPerTree;
+        for (uint32_t t = 0; t < _trees; ++t) {
+            const size_t tree_base = cascade_base + size_t(t) * _splitsPerTree;
+            const uint16_t* idx1 = _splitIdx1.data() + tree_base;
+            const uint16_t* idx2 = _splitIdx2.data() + tree_base;
+            const int16_t* thresh = _splitThresh.data() + tree_base;
+            uint32_t node = 0;
+            for (uint32_t d = 0; d < _depth; ++d) {
+                int diff = pixels[idx1[node]] - pixels[idx2[node]];
+                node = 2 * node + 1 + static_cast<uint32_t>(diff <= thresh[node]);
+            }
+            scratch.leaves[t] = _model->leaves(c, t) + size_t(node - _splitsPerTree) * length;
+        }
+
+        accumulateLeaves(current, scratch.leaves.data(), _trees, length);
+    }
+
+    // 归一化形状映射回图像坐标
+    if (shape.num_parts() != _landmarks) {
+        shape = dlib::full_object_detection(face, std::vector<dlib::point>(_landmarks));
+    }
+    shape.get_rect() = face;
+    const double left = static_cast<double>(face.left());
+    const double top = static_cast<double>(face.top());
+    const double width = static_cast<double>(face.right() - face.left());
+    const double height = static_cast<double>(face.bottom() - face.top());
+    for (uint32_t i = 0; i < _landmarks; ++i) {
+        shape.part(i) = dlib::point(roundToPixel(left + width * current[2 * i]),
+                                    roundToPixel(top + height * current[2 * i + 1]));
+    }
+}
+
+dlib::full_object_detection FlatShapePredictor::operator()(const cv::Mat& image, const dlib::rectangle& face) const {
+    dlib::full_object_detection shape;
+    predict(image, face, shape);
+    return shape;
+}
+
+bool LandmarkPredictor::load(const ShapeModelConfig& config, ShapeModelLoadInfo& info) {
+    _flat.reset();
+    _engine = LandmarkEngine::DLIB;
+    if (config.engine == LandmarkEngine::FLAT) {
+        std::shared_ptr<const FlatShapeModel> model = FlatShapeModel::load(config, info);
+        if (model) {
+            _flat = std::make_unique<FlatShapePredictor>(std::move(model));
+            _engine = LandmarkEngine::FLAT;
+            return true;
+        }
+        std::cerr << "无法使用展开模型推理引擎，改用dlib实现" << std::endl;
+    }
+    return FlatShapeModel::loadPredictor(config, _dlib, info);
+}
+
+void LandmarkPredictor::predict(const cv::Mat& image, const dlib::rectangle& face,
+                                dlib::full_object_detection& shape) const {
+    if (_flat) {
+        _flat->predict(image, face, shape);
+    } else if (image.channels() == 3) {
+        shape = _dlib(dlib::cv_image<dlib::bgr_pixel>(image), face);
+    } else {
+        shape = _dlib(dlib::cv_image<unsigned char>(image), face);
+    }
+}
@@ -4,9 +4,17 @@
 #include <chrono>
 #include <thread>
 #include <csignal>
+#include <algorithm>
+#include <vector>
+#include <functional>
 #include "../include/driver_monitor.hpp"
+#include "../include/monitor_engine.hpp"
 #include "../include/config_reader.hpp"
+#include "../include/dms_config.hpp"
+#include "../include/config_watcher.hpp"
 #include "../include/event_logger.hpp"
+#include "../include/event_dispatcher.hpp"
+#include "../include/clip_recorder.hpp"
 
 // 全局变量，用于信号处理
 std::atomic<bool> g_running(true);
@@ -17,24 +25,197 @@ void signalHandler(int signum) {
     g_running = false;
 }
 
-// 行为检测回调函数
-void behaviorCallback(std::shared_ptr<EventLogger> logger, DriverBehavior behavior, const std::string& message, const cv::Mat& frame) {
+// 注册事件订阅者：事件记录和控制台输出各在自己的线程上处理，不阻塞检测
+// clips为空时不录制事件片段
+void subscribeEventSinks(EventDispatcher& dispatcher, const DmsConfig& config,
+                         std::shared_ptr<EventLogger> logger, std::shared_ptr<ClipRecorder> clips,
+                         std::vector<std::string> stream_names) {
+    const SubscriberConfig& subscriber_config = config.dispatch;
+    
+    // 多路监测时提示信息以视频流名称开头
+    auto prefix = [stream_names](int stream_id) -> std::string {
+        if (stream_id < 0 || stream_id >= static_cast<int>(stream_names.size())) {
+            return "";
+        }
+        return "[" + stream_names[stream_id] + "] ";
+    };
+    
     // 记录事件
-    if (behavior != DriverBehavior::NORMAL) {
-        logger->logEvent(behavior, message, frame);
-    }
+    dispatcher.subscribe("event_logger", [logger, clips, prefix](const MonitorEvent& event) {
+        if (event.behavior != DriverBehavior::NORMAL) {
+            // 片段在后台等事件后的帧缓存齐全后写出，这里只拿到路径
+            std::string clip_path = clips ? clips->requestClip(event) : "";
+            MonitorEvent logged = event;
+            logged.message = prefix(event.stream_id) + event.message;
+            logger->logEvent(logged, clip_path);
+        }
+    }, subscriber_config);
     
     // 在控制台输出检测结果
-    std::cout << "检测到行为: " << DriverMonitor::behaviorToString(behavior) << std::endl;
-    std::cout << "提示信息: " << message << std::endl;
+    dispatcher.subscribe("console", [prefix](const MonitorEvent& event) {
+        std::cout << prefix(event.stream_id) << "检测到行为: " << DriverMonitor::behaviorName(event.behavior) << std::endl;
+        std::cout << prefix(event.stream_id) << "提示信息: " << event.message << std::endl;
+    }, subscriber_config);
+}
+
+// 输出各事件订阅者和证据图像的统计
+void printDispatchStats(const EventDispatcher& dispatcher, std::shared_ptr<EventLogger> logger) {
+    for (const auto& stats : dispatcher.getStats()) {
+        std::cout << "事件订阅者 " << stats.name << ": 处理 " << stats.delivered
+                  << " 丢弃 " << stats.dropped
+                  << " 最大积压 " << stats.max_depth << std::endl;
+    }
+    
+    // 各行为的累计次数（事件缓存只保留最近的事件，计数不受影响）
+    auto totals = logger->getEventRing().getTotals();
+    std::cout << "行为统计:";
+    for (size_t i = 0; i < totals.size(); ++i) {
+        if (totals[i] > 0) {
+            std::cout << " " << DriverMonitor::behaviorName(static_cast<DriverBehavior>(i)) << " " << totals[i];
+        }
+    }
+    std::cout << std::endl;
+    
+    logger->flush();
+    EvidenceStats evidence = logger->getEvidenceStats();
+    std::cout << "证据图像: 保存 " << evidence.encoded
+              << " 丢弃 " << evidence.dropped
+              << " 失败 " << evidence.failed
+              << " 超出配额删除 " << evidence.evicted
+              << " 占用 " << evidence.bytes_on_disk / 1024 << " KB"
+              << " 平均编码耗时 " << evidence.avg_encode_ms << " ms" << std::endl;
+    
+    EventStoreStats store = logger->getEventStoreStats();
+    std::cout << "事件存储: 写入 " << store.records
+              << " 条 " << store.bytes / 1024 << " KB"
+              << " 段文件 " << store.segments
+              << " fsync " << store.syncs << " 次" << std::endl;
+}
+
+// 输出启动耗时
+void printStartupStats(const StartupStats& startup) {
+    std::cout << "启动: 模型加载 " << startup.model_load_ms << " ms"
+              << (startup.model_from_cache ? "（展开缓存）" : "")
+              << " 帧源打开 " << startup.source_open_ms << " ms"
+              << " 首次检测 ";
+    if (startup.first_detection_ms >= 0) {
+        std::cout << startup.first_detection_ms << " ms" << std::endl;
+    } else {
+        std::cout << "未完成" << std::endl;
+    }
+}
+
+// 输出配置热加载统计
+void printReloadStats(const ConfigWatcher* watcher) {
+    if (!watcher) {
+        return;
+    }
+    ConfigReloadStats stats = watcher->getStats();
+    std::cout << "配置热加载: 生效 " << stats.applied << " 次 拒绝 " << stats.rejected << " 次" << std::endl;
+}
+
+// 启动配置文件监视，校验通过的新快照通过apply发布给运行中的模块；未启用热加载时返回空指针
+std::unique_ptr<ConfigWatcher> startConfigWatcher(std::shared_ptr<ConfigReader> reader,
+                                                  std::shared_ptr<const DmsConfig> config,
+                                                  std::function<void(std::shared_ptr<const DmsConfig>)> apply) {
+    if (!config->reload.enabled) {
+        return nullptr;
+    }
+    auto watcher = std::make_unique<ConfigWatcher>(reader, config);
+    // 回调只在监视线程上调用，previous记录上一次发布的快照
+    bool started = watcher->start([previous = config, apply](std::shared_ptr<const DmsConfig> next) mutable {
+        // 模型和帧源已在启动时创建，不在运行中重新加载；只在本次修改了模型路径时提示
+        if (next->model.path != previous->model.path || next->model.cachePath() != previous->model.cachePath()) {
+            std::cerr << "面部特征点模型路径的修改需要重启后生效" << std::endl;
+        }
+        previous = next;
+        apply(next);
+    });
+    if (!started) {
+        return nullptr;
+    }
+    return watcher;
+}
+
+// 多路监测：所有视频流共享模型，在线程池上并行处理，无界面运行
+int runEngine(std::shared_ptr<ConfigReader> reader, std::shared_ptr<const DmsConfig> config,
+              std::shared_ptr<EventLogger> logger) {
+    const std::vector<FrameSourceConfig>& streams = config->streams;
+    MonitorEngine engine;
+    if (!engine.initialize(config->model, config->engineConfig())) {
+        std::cerr << "初始化多路监测引擎失败" << std::endl;
+        return 1;
+    }
+    for (const auto& stream : streams) {
+        if (engine.addStream(stream.name, FrameSource::create(stream)) < 0) {
+            return 1;
+        }
+    }
+    
+    // 回调只发布事件，记录和输出在订阅者线程上完成
+    EventDispatcher dispatcher;
+    std::vector<std::string> names;
+    for (const auto& stream : streams) {
+        names.push_back(stream.name);
+    }
+    subscribeEventSinks(dispatcher, *config, logger, nullptr, names);
+    engine.start([&dispatcher](const MonitorEvent& event) {
+        dispatcher.publish(event);
+    });
+    
+    // 配置热加载：阈值、帧率、检测缩放比例和输出目录在运行中生效
+    std::unique_ptr<ConfigWatcher> watcher = startConfigWatcher(reader, config,
+        [&engine, logger](std::shared_ptr<const DmsConfig> next) {
+            engine.applyConfig(std::make_shared<const EngineConfig>(next->engineConfig()));
+            logger->applyConfig(next);
+        });
+    
+    std::cout << "多路驾驶行为监测已启动，按 Ctrl+C 退出程序" << std::endl;
+    while (g_running && !engine.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (watcher) {
+        watcher->stop();
+    }
+    engine.stop();
+    dispatcher.stop();
+    
+    // 输出各路统计
+    for (const auto& stats : engine.getStats()) {
+        std::cout << "[" << stats.name << "] 采集帧数: " << stats.frames_captured
+                  << " 处理帧数: " << stats.frames_processed
+                  << " 丢弃帧数: " << stats.frames_dropped
+                  << " 平均帧率: " << stats.fps << " fps"
+                  << " 完整人脸检测次数: " << stats.detector_invocations;
+        if (stats.frames_reused > 0) {
+            std::cout << " 运动门控复用帧数: " << stats.frames_reused;
+        }
+        if (stats.features_dropped > 0) {
+            std::cout << " 特征记录丢弃: " << stats.features_dropped;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "用时: " << engine.getElapsedSeconds() << " 秒" << std::endl;
+    printStartupStats(engine.getStartupStats());
+    printDispatchStats(dispatcher, logger);
+    printReloadStats(watcher.get());
+    std::cout << "驾驶行为监测系统已退出" << std::endl;
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
     try {
         // 检查命令行参数
+        // 用法: driver_monitor_system [config.json] [--headless]
         std::string config_file = "config/config.json";
-        if (argc > 1) {
-            config_file = argv[1];
+        bool headless = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--headless") {
+                headless = true;
+            } else {
+                config_file = arg;
+            }
         }
         
         std::cout << "使用配置文件: " << config_file << std::endl;
@@ -43,30 +224,80 @@ int main(int argc, char* argv[]) {
         std::signal(SIGINT, signalHandler);
         std::signal(SIGTERM, signalHandler);
         
-        // 加载配置
-        std::shared_ptr<ConfigReader> config = std::make_shared<ConfigReader>(config_file);
+        // 加载配置并编译为类型化快照：所有字段在这里校验一次，错误的配置在启动时就失败
+        std::shared_ptr<ConfigReader> reader = std::make_shared<ConfigReader>(config_file);
+        std::vector<std::string> errors;
+        std::shared_ptr<const DmsConfig> config = reader->compile(errors);
+        if (!config) {
+            std::cerr << "配置文件无效: " << config_file << std::endl;
+            for (const auto& error : errors) {
+                std::cerr << "  " << error << std::endl;
+            }
+            return 1;
+        }
         
         // 创建事件记录器
-        std::shared_ptr<EventLogger> logger = std::make_shared<EventLogger>(
-            config->getEventsDir(),
-            config->getImagesDir()
-        );
-        logger->setSaveImages(config->isSaveImages());
+        std::shared_ptr<EventLogger> logger = std::make_shared<EventLogger>(*config);
+        
+        // 配置了多路视频流时运行多路监测引擎
+        if (!config->streams.empty()) {
+            return runEngine(reader, config, logger);
+        }
         
         // 创建驾驶行为监测系统
         std::shared_ptr<DriverMonitor> monitor = std::make_shared<DriverMonitor>();
         
-        // 初始化摄像头
-        if (!monitor->initialize(config->getCameraDeviceId())) {
+        // 按配置快照初始化帧源、模型和各阶段参数
+        if (!monitor->initialize(*config)) {
             std::cerr << "初始化驾驶行为监测系统失败" << std::endl;
             return 1;
         }
         
-        // 创建窗口用于显示视频流
-        cv::namedWindow("驾驶行为监测系统", cv::WINDOW_AUTOSIZE);
+        // 创建窗口用于显示视频流（无界面模式下不创建）
+        if (!headless) {
+            cv::namedWindow("驾驶行为监测系统", cv::WINDOW_AUTOSIZE);
+        }
+        
+        // 事件前后视频片段：分发阶段每帧交给录制器，在后台压缩缓存
+        std::shared_ptr<ClipRecorder> clips;
+        if (config->clip.enabled) {
+            clips = std::make_shared<ClipRecorder>(config->clip);
+            if (clips->start()) {
+                monitor->setFrameObserver([clips](const FrameHandle& frame) {
+                    clips->onFrame(frame);
+                });
+            } else {
+                clips.reset();
+            }
+        }
+        
+        // 每帧特征：分类阶段放入队列，后台按列编码写入
+        std::shared_ptr<FeatureRecorder> features;
+        if (config->features.enabled) {
+            features = std::make_shared<FeatureRecorder>(
+                config->features, config->source.name.empty() ? "camera" : config->source.name);
+            if (features->start()) {
+                monitor->setFeatureRecorder(features);
+            } else {
+                features.reset();
+            }
+        }
+        
+        // 行为事件分发
+        EventDispatcher dispatcher;
+        subscribeEventSinks(dispatcher, *config, logger, clips, {});
         
-        // 启动驾驶行为监测
-        monitor->start(std::bind(behaviorCallback, logger, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        // 启动驾驶行为监测，回调只发布事件
+        monitor->start([&dispatcher](const MonitorEvent& event) {
+            dispatcher.publish(event);
+        });
+        
+        // 配置热加载：阈值、帧率、检测缩放比例和输出目录在运行中生效
+        std::unique_ptr<ConfigWatcher> watcher = startConfigWatcher(reader, config,
+            [monitor, logger](std::shared_ptr<const DmsConfig> next) {
+                monitor->applyConfig(next);
+                logger->applyConfig(next);
+            });
         
         std::cout << "驾驶行为监测系统已启动" << std::endl;
         std::cout << "可以检测的行为: 闭眼、打哈欠、喝水、打电话" << std::endl;
@@ -74,35 +305,73 @@ int main(int argc, char* argv[]) {
         
         // 主循环
         char key = 0;
-        while (g_running && key != 'q' && key != 'Q') {
-            // 获取当前帧
-            cv::Mat frame = monitor->getCurrentFrame();
+        while (headless && g_running && !monitor->isFinished()) {
+            // 无界面模式：只等待回放结束或退出信号
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        while (!headless && g_running && !monitor->isFinished() && key != 'q' && key != 'Q') {
+            // 获取当前帧（分发阶段已标注行为和提示信息，与监测线程共享缓冲，不复制）
+            FrameHandle frame = monitor->getCurrentFrame();
             
             if (!frame.empty()) {
-                // 获取当前行为
-                DriverBehavior behavior = monitor->getCurrentBehavior();
-                std::string behavior_str = DriverMonitor::behaviorToString(behavior);
-                std::string message = DriverMonitor::getBehaviorMessage(behavior);
-                
-                // 在图像上显示行为和提示信息
-                cv::putText(frame, "行为: " + behavior_str, cv::Point(10, 30), 
-                           cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 0, 255), 2);
-                cv::putText(frame, "提示: " + message, cv::Point(10, 60), 
-                           cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 255), 1);
-                
                 // 显示图像
-                cv::imshow("驾驶行为监测系统", frame);
+                cv::imshow("驾驶行为监测系统", frame.image());
             }
             
             // 等待按键
             key = cv::waitKey(30);
         }
         
-        // 停止驾驶行为监测
+        // 停止驾驶行为监测，再处理完剩余的事件和片段
+        if (watcher) {
+            watcher->stop();
+        }
         monitor->stop();
+        dispatcher.stop();
+        if (clips) {
+            clips->stop();
+            ClipStats clip_stats = clips->getStats();
+            std::cout << "事件片段: 写出 " << clip_stats.clips_written
+                      << " 失败 " << clip_stats.clips_failed
+                      << " 缓存帧数 " << clip_stats.buffer_frames
+                      << " 缓存占用 " << clip_stats.buffer_bytes / 1024 << " KB"
+                      << " 压缩跟不上丢帧 " << clip_stats.frames_dropped << std::endl;
+        }
+        if (features) {
+            features->stop();
+            FeatureRecorderStats feature_stats = features->getStats();
+            std::cout << "特征记录: " << feature_stats.rows_recorded << " 行"
+                      << " 丢弃 " << feature_stats.rows_dropped
+                      << " 文件大小 " << feature_stats.bytes_written / 1024 << " KB" << std::endl;
+        }
+        
+        // 输出吞吐量统计
+        MonitorStats stats = monitor->getStats();
+        std::cout << "采集帧数: " << stats.frames_captured
+                  << " 处理帧数: " << stats.frames_processed
+                  << " 丢弃帧数: " << stats.frames_dropped << std::endl;
+        std::cout << "用时: " << stats.elapsed_seconds << " 秒"
+                  << " 平均帧率: " << stats.fps << " fps"
+                  << " 平均延迟: " << stats.avg_latency_ms << " ms" << std::endl;
+        std::cout << "采集目标帧率: " << stats.scheduler.target_fps << " fps"
+                  << " 实际帧率: " << stats.scheduler.achieved_fps << " fps"
+                  << " 跳过帧数: " << stats.scheduler.frames_skipped
+                  << " 抖动: " << stats.scheduler.jitter_ms << " ms" << std::endl;
+        std::cout << "完整人脸检测次数: " << stats.detector_invocations
+                  << " (" << stats.detector_calls_per_second << " 次/秒)" << std::endl;
+        std::cout << "运动门控复用帧数: " << stats.frames_reused
+                  << " (跳过比例 " << stats.motion_skip_ratio * 100.0 << "%)" << std::endl;
+        std::cout << "帧缓冲: " << stats.frame_pool.capacity
+                  << " 缓冲用尽新分配: " << stats.frame_pool.pool_misses
+                  << " 平均每帧复制字节数: " << stats.bytes_copied_per_frame << std::endl;
+        printStartupStats(stats.startup);
+        printDispatchStats(dispatcher, logger);
+        printReloadStats(watcher.get());
         
         // 关闭窗口
-        cv::destroyAllWindows();
+        if (!headless) {
+            cv::destroyAllWindows();
+        }
         
         std::cout << "驾驶行为监测系统已退出" << std::endl;
         return 0;
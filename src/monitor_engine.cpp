@@ -0,0 +1,408 @@
+#include "../include/monitor_engine.hpp"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+MonitorEngine::MonitorEngine()
+    : _running(false),
+      _elapsedNanos(0),
+      _sourcesOpenedNanos(0),
+      _firstDetectionNanos(-1) {
+}
+
+MonitorEngine::~MonitorEngine() {
+    stop();
+    // 后台加载任务会写入成员，等它结束后再析构
+    if (_modelLoading.valid()) {
+        _modelLoading.wait();
+    }
+}
+
+bool MonitorEngine::initialize(const ShapeModelConfig& model, const EngineConfig& config) {
+    _config = config;
+    _initStartTime = std::chrono::steady_clock::now();
+    _sourcesOpenedNanos = 0;
+    _firstDetectionNanos = -1;
+    _landmarkPredictor.reset();
+
+    // 在后台加载共享的面部特征点预测模型（有展开缓存时直接映射缓存）
+    _modelLoading = std::async(std::launch::async, [this, model]() -> std::shared_ptr<const LandmarkPredictor> {
+        auto predictor = std::make_shared<LandmarkPredictor>();
+        if (!predictor->load(model, _modelInfo)) {
+            return nullptr;
+        }
+        return predictor;
+    });
+
+    // 创建线程池，并为每个工作线程准备一份人脸检测器
+    _pool = std::make_unique<WorkStealingPool>(_config.worker_threads);
+    // 各视频流已经在线程池上并行，检测器内部不再并行扫描
+    FaceDetectorConfig worker_detector = _config.detector;
+    worker_detector.hog_threads = 1;
+    _workerDetectors.clear();
+    for (int i = 0; i < _pool->size(); ++i) {
+        _workerDetectors.push_back(FaceDetector::create(worker_detector, _config.detection_scale));
+    }
+    _workerConfigVersions.assign(_workerDetectors.size(), _liveConfig.version());
+
+    std::cout << "多路监测引擎初始化成功，工作线程数: " << _pool->size()
+              << " 人脸检测: " << _workerDetectors[0]->describe() << std::endl;
+    return true;
+}
+
+int MonitorEngine::addStream(const std::string& name, std::unique_ptr<FrameSource> source) {
+    if (_running) {
+        std::cerr << "监测运行中，无法添加视频流" << std::endl;
+        return -1;
+    }
+    if (!source || !source->open()) {
+        std::cerr << "无法打开视频流: " << name << std::endl;
+        return -1;
+    }
+
+    auto stream = std::make_unique<StreamContext>();
+    stream->id = static_cast<int>(_streams.size());
+    stream->name = name;
+    stream->source = std::move(source);
+    stream->tracker.setConfig(_config.tracking);
+    stream->tracker.setDriverRoiConfig(_config.driver_roi);
+    stream->motion.setConfig(_config.motion_gate);
+    stream->analyzer = BehaviorAnalyzer(0x9E3779B9u * static_cast<uint32_t>(stream->id + 1), _config.thresholds);
+
+    std::cout << "添加视频流 [" << stream->id << "] " << name << ": " << stream->source->describe() << std::endl;
+    _streams.push_back(std::move(stream));
+    _sourcesOpenedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - _initStartTime).count();
+    return _streams.back()->id;
+}
+
+bool MonitorEngine::start(BehaviorCallback callback) {
+    if (_running) {
+        std::cout << "多路监测引擎已经在运行中" << std::endl;
+        return false;
+    }
+    if (!_pool || !waitForModel()) {
+        std::cerr << "多路监测引擎未初始化，无法启动" << std::endl;
+        return false;
+    }
+    if (_streams.empty()) {
+        std::cerr << "没有可用的视频流" << std::endl;
+        return false;
+    }
+
+    _callback = callback;
+    _startTime = std::chrono::steady_clock::now();
+    _elapsedNanos = 0;
+    _running = true;
+
+    for (auto& stream : _streams) {
+        stream->queue = std::make_unique<SpscQueue<FramePacket>>(_config.pipeline.queue_capacity);
+        stream->latest = std::make_unique<LatestSlot<FramePacket>>();
+        // 队列中的帧、采集中和处理中的帧各一块
+        stream->framePool = std::make_unique<FramePool>(_config.pipeline.queue_capacity + 2);
+        stream->captureDone = false;
+        stream->finished = false;
+        if (_config.features.enabled) {
+            stream->features = std::make_unique<FeatureRecorder>(_config.features, stream->name);
+            if (!stream->features->start()) {
+                stream->features.reset();
+            }
+        }
+        stream->captureThread = std::thread(&MonitorEngine::captureLoop, this, std::ref(*stream));
+    }
+
+    std::cout << "多路监测引擎已启动，视频流数: " << _streams.size() << std::endl;
+    return true;
+}
+
+void MonitorEngine::stop() {
+    if (!_running) {
+        return;
+    }
+
+    _running = false;
+
+    for (auto& stream : _streams) {
+        if (stream->captureThread.joinable()) {
+            stream->captureThread.join();
+        }
+    }
+
+    // 处理任务看到停止标志后不再重新提交，等待正在执行的任务结束
+    if (_pool) {
+        _pool->waitIdle();
+    }
+
+    for (auto& stream : _streams) {
+        stream->source->release();
+        if (stream->features) {
+            stream->features->stop();
+        }
+    }
+
+    std::cout << "多路监测引擎已停止" << std::endl;
+}
+
+bool MonitorEngine::isFinished() const {
+    for (const auto& stream : _streams) {
+        if (!stream->finished) {
+            return false;
+        }
+    }
+    return !_streams.empty();
+}
+
+size_t MonitorEngine::getStreamCount() const {
+    return _streams.size();
+}
+
+DriverBehavior MonitorEngine::getCurrentBehavior(int stream_id) const {
+    if (stream_id < 0 || stream_id >= static_cast<int>(_streams.size())) {
+        return DriverBehavior::UNKNOWN;
+    }
+    const StreamContext& stream = *_streams[stream_id];
+    std::lock_guard<std::mutex> lock(stream.behaviorMutex);
+    return stream.behavior;
+}
+
+std::vector<StreamStats> MonitorEngine::getStats() const {
+    std::vector<StreamStats> result;
+    double elapsed = getElapsedSeconds();
+    for (const auto& stream : _streams) {
+        StreamStats stats;
+        stats.stream_id = stream->id;
+        stats.name = stream->name;
+        stats.frames_captured = stream->framesCaptured;
+        stats.frames_processed = stream->framesProcessed;
+        stats.frames_dropped = stream->framesDropped;
+        stats.detector_invocations = stream->detectorInvocations;
+        stats.frames_reused = stream->framesReused;
+        if (stream->framePool) {
+            stats.bytes_copied = stream->framePool->getStats().bytes_copied;
+        }
+        if (stream->features) {
+            stats.features_dropped = stream->features->getStats().rows_dropped;
+        }
+        stats.fps = elapsed > 0 ? stats.frames_processed / elapsed : 0.0;
+        stats.behavior = getCurrentBehavior(stream->id);
+        stats.finished = stream->finished;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+double MonitorEngine::getElapsedSeconds() const {
+    return _elapsedNanos / 1e9;
+}
+
+StartupStats MonitorEngine::getStartupStats() const {
+    StartupStats stats;
+    if (_landmarkPredictor) {
+        stats.model_load_ms = _modelInfo.load_ms;
+        stats.model_from_cache = _modelInfo.from_cache;
+    }
+    stats.source_open_ms = _sourcesOpenedNanos / 1e6;
+    stats.init_ms = std::max(stats.model_load_ms, stats.source_open_ms);
+    int64_t first_detection = _firstDetectionNanos;
+    if (first_detection >= 0) {
+        stats.first_detection_ms = first_detection / 1e6;
+    }
+    return stats;
+}
+
+bool MonitorEngine::waitForModel() {
+    if (_landmarkPredictor) {
+        return true;
+    }
+    if (!_modelLoading.valid()) {
+        return false;
+    }
+    _landmarkPredictor = _modelLoading.get();
+    if (!_landmarkPredictor) {
+        return false;
+    }
+    std::cout << "面部特征点模型: " << _modelInfo.source
+              << (_modelInfo.from_cache ? "（展开缓存）" : "")
+              << " 推理引擎 " << FlatShapeModel::engineToString(_modelInfo.engine)
+              << " 加载耗时 " << _modelInfo.load_ms << " ms" << std::endl;
+    return true;
+}
+
+void MonitorEngine::captureLoop(StreamContext& stream) {
+    // 回放帧源的"尽可能快"模式不做帧率控制，用于吞吐量测试
+    const bool paced = !stream.source->isFreeRunning();
+    const bool blocking = _config.pipeline.drop_policy == FrameDropPolicy::BLOCK;
+    uint64_t sequence = 0;
+
+    stream.scheduler.setTargetFps(paced ? _config.target_fps : 0.0);
+    stream.scheduler.reset();
+
+    while (_running) {
+        // 配置热加载：调度器只由本路采集线程使用
+        if (auto config = _liveConfig.poll(stream.captureConfigVersion)) {
+            if (paced) {
+                stream.scheduler.setTargetFps(config->target_fps);
+            }
+        }
+
+        int skipped = stream.scheduler.waitNextFrame();
+        if (skipped > 0) {
+            stream.source->skip(skipped);
+        }
+
+        FramePacket packet;
+        packet.frame = stream.framePool->acquire();
+        if (!stream.framePool->read(packet.frame, [&stream](cv::Mat& image) { return stream.source->read(image); })) {
+            if (stream.source->isExhausted()) {
+                break;
+            }
+            if (!paced) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            }
+            continue;
+        }
+        packet.sequence = ++sequence;
+        packet.capture_time = std::chrono::steady_clock::now();
+        stream.framesCaptured++;
+        stream.scheduler.frameCaptured();
+
+        if (!blocking) {
+            // 处理任务还没取走上一帧时用这一帧替换它，丢弃的总是较旧的帧
+            if (stream.latest->publish(std::move(packet))) {
+                stream.framesDropped++;
+            }
+        } else {
+            while (!stream.queue->tryPush(std::move(packet))) {
+                if (!_running) {
+                    stream.framesDropped++;
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        scheduleStream(stream);
+    }
+
+    stream.captureDone = true;
+
+    // 确保处理任务能看到采集结束并标记该路视频流完成
+    scheduleStream(stream);
+}
+
+bool MonitorEngine::hasPendingFrame(const StreamContext& stream) {
+    return !stream.queue->empty() || !stream.latest->empty();
+}
+
+void MonitorEngine::scheduleStream(StreamContext& stream) {
+    if (!stream.scheduled.exchange(true)) {
+        _pool->submit([this, &stream] { processStream(stream); });
+    }
+}
+
+void MonitorEngine::processStream(StreamContext& stream) {
+    FramePacket packet;
+    bool got = _config.pipeline.drop_policy == FrameDropPolicy::DROP_OLDEST
+        ? stream.latest->take(packet)
+        : stream.queue->tryPop(packet);
+
+    if (got && _running) {
+        // 配置热加载：同一路视频流同一时刻只有一个处理任务，计数器不受影响
+        if (auto config = _liveConfig.poll(stream.processConfigVersion)) {
+            stream.analyzer.setThresholds(config->thresholds);
+        }
+
+        // 人脸定位和特征点
+        const cv::Mat& frame = packet.frame.image();
+        stream.prepared.reset(frame);
+        if (stream.motion.unchanged(stream.prepared)) {
+            // 人脸区域几乎没有变化：复用上一次的人脸框和特征点，计数器照常推进
+            packet.has_face = true;
+            packet.face = stream.lastFace;
+            stream.framesReused++;
+        } else {
+            bool detector_invoked = false;
+            packet.has_face = stream.tracker.locate(stream.prepared, workerDetector(), packet.face, detector_invoked);
+            if (detector_invoked) {
+                stream.detectorInvocations++;
+            }
+            if (packet.has_face) {
+                // 特征点直接写入本路视频流复用的lastShape，特征点数不变时flat引擎不分配
+                _landmarkPredictor->predict(frame, packet.face, stream.lastShape);
+                stream.tracker.update(stream.lastShape);
+                stream.motion.update(stream.prepared, packet.face, stream.lastShape);
+                stream.lastFace = packet.face;
+            } else {
+                stream.motion.reset();
+            }
+        }
+
+        packet.behavior = DriverBehavior::NORMAL;
+        if (packet.has_face) {
+            packet.behavior = stream.analyzer.analyze(frame, stream.lastShape);
+        }
+        if (stream.features) {
+            stream.features->record(FeatureRecorder::makeSample(
+                packet.sequence, packet.has_face, packet.face, stream.analyzer.getLastFeatures(), packet.behavior));
+        }
+
+        // 行为变化时回调
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> lock(stream.behaviorMutex);
+            if (stream.behavior != packet.behavior) {
+                stream.behavior = packet.behavior;
+                changed = true;
+            }
+        }
+        if (changed && _callback) {
+            _callback(DriverMonitor::makeEvent(stream.id, packet));
+        }
+
+        stream.framesProcessed++;
+        auto now = std::chrono::steady_clock::now();
+        _elapsedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _startTime).count();
+        if (_firstDetectionNanos < 0) {
+            // 任意一路视频流的第一帧结果
+            int64_t expected = -1;
+            int64_t first = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _initStartTime).count();
+            if (_firstDetectionNanos.compare_exchange_strong(expected, first)) {
+                std::cout << "首次检测完成: 启动后 " << first / 1e6 << " ms" << std::endl;
+            }
+        }
+    }
+
+    // 还有积压的帧则重新提交，让其他视频流的任务有机会插入执行
+    if (_running && hasPendingFrame(stream)) {
+        _pool->submit([this, &stream] { processStream(stream); });
+        return;
+    }
+
+    stream.scheduled = false;
+
+    // 清除标志后再检查一次，避免与采集线程的提交竞争而漏掉新帧
+    if (_running && hasPendingFrame(stream)) {
+        scheduleStream(stream);
+    } else if (stream.captureDone && !hasPendingFrame(stream)) {
+        stream.finished = true;
+    }
+}
+
+FaceDetector& MonitorEngine::workerDetector() {
+    int index = WorkStealingPool::currentWorkerIndex();
+    if (index < 0 || index >= static_cast<int>(_workerDetectors.size())) {
+        index = 0;
+    }
+
+    // 检测器每个工作线程一份，由所在线程应用新的缩放比例
+    if (auto config = _liveConfig.poll(_workerConfigVersions[index])) {
+        _workerDetectors[index]->setScale(config->detection_scale);
+    }
+    return *_workerDetectors[index];
+}
+
+void MonitorEngine::applyConfig(std::shared_ptr<const EngineConfig> config) {
+    if (config) {
+        _liveConfig.publish(std::move(config));
+    }
+}
@@ -0,0 +1,141 @@
+#include "../include/motion_gate.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+MotionGate::MotionGate(const MotionGateConfig& config)
+    : _config(config),
+      _valid(false),
+      _skipped(0),
+      _lastDifference(0.0) {
+}
+
+void MotionGate::setConfig(const MotionGateConfig& config) {
+    _config = config;
+    reset();
+}
+
+const MotionGateConfig& MotionGate::getConfig() const {
+    return _config;
+}
+
+bool MotionGate::unchanged(PreparedFrame& frame) {
+    if (!_config.enabled || !_valid || frame.empty()) {
+        return false;
+    }
+    if (_skipped >= _config.max_skip_frames) {
+        // 连续复用达到上限，本帧强制完整推理
+        return false;
+    }
+
+    if (!thumbnail(frame, _faceRoi, _current)) {
+        return false;
+    }
+    _lastDifference = static_cast<double>(sumAbsDiff(_current, _faceRef, kThumbnailPixels)) / kThumbnailPixels;
+    if (_lastDifference >= _config.face_threshold) {
+        return false;
+    }
+
+    if (!thumbnail(frame, _eyeRoi, _current)) {
+        return false;
+    }
+    double eye_difference = static_cast<double>(sumAbsDiff(_current, _eyeRef, kThumbnailPixels)) / kThumbnailPixels;
+    if (eye_difference >= _config.eye_threshold) {
+        return false;
+    }
+
+    _skipped++;
+    return true;
+}
+
+void MotionGate::update(PreparedFrame& frame, const dlib::rectangle& face, const dlib::full_object_detection& shape) {
+    _skipped = 0;
+    if (!_config.enabled) {
+        return;
+    }
+    _faceRoi = face;
+    _eyeRoi = eyeRegion(face, shape);
+    _valid = thumbnail(frame, _faceRoi, _faceRef) && thumbnail(frame, _eyeRoi, _eyeRef);
+}
+
+void MotionGate::reset() {
+    _valid = false;
+    _skipped = 0;
+}
+
+double MotionGate::getLastDifference() const {
+    return _lastDifference;
+}
+
+uint32_t MotionGate::sumAbsDiff(const uint8_t* a, const uint8_t* b, size_t length) {
+    size_t i = 0;
+    uint32_t sum = 0;
+#if defined(__SSE2__)
+    // psadbw: 每16字节得到两个64位部分和
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sum = static_cast<uint32_t>(_mm_cvtsi128_si32(acc)) +
+          static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#elif defined(__ARM_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+    }
+    sum = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+    for (; i < length; ++i) {
+        sum += static_cast<uint32_t>(std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    }
+    return sum;
+}
+
+bool MotionGate::thumbnail(PreparedFrame& frame, const dlib::rectangle& roi, uint8_t* out) {
+    const cv::Size frame_size = frame.size();
+    cv::Rect rect(static_cast<int>(roi.left()), static_cast<int>(roi.top()),
+                  static_cast<int>(roi.width()), static_cast<int>(roi.height()));
+    rect &= cv::Rect(0, 0, frame_size.width, frame_size.height);
+    if (rect.width < 2 || rect.height < 2) {
+        return false;
+    }
+
+    // 缩略图直接写入调用方的缓冲。完整推理之后（update）检测器和跟踪器已生成本帧灰度图，直接复用；
+    // 推理之前（unchanged）还没有灰度图，只处理区域内的像素：先缩小再转灰度
+    cv::Mat thumb(kThumbnailSize, kThumbnailSize, CV_8UC1, out);
+    const cv::Size size(kThumbnailSize, kThumbnailSize);
+    if (frame.hasGray()) {
+        cv::resize(frame.gray()(rect), thumb, size, 0, 0, cv::INTER_AREA);
+    } else {
+        cv::resize(frame.image()(rect), _small, size, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(_small, thumb, cv::COLOR_BGR2GRAY);
+    }
+    return true;
+}
+
+dlib::rectangle MotionGate::eyeRegion(const dlib::rectangle& face, const dlib::full_object_detection& shape) {
+    if (shape.num_parts() < 48) {
+        return dlib::rectangle(face.left(), face.top(), face.right(), face.top() + face.height() / 2);
+    }
+    long left = shape.part(36).x();
+    long right = left;
+    long top = shape.part(36).y();
+    long bottom = top;
+    for (unsigned long i = 37; i < 48; ++i) {
+        left = std::min(left, shape.part(i).x());
+        right = std::max(right, shape.part(i).x());
+        top = std::min(top, shape.part(i).y());
+        bottom = std::max(bottom, shape.part(i).y());
+    }
+    // 眼睛的特征点很扁，上下各扩展眼部宽度的15%，把眼睑和眉毛下缘包含进来
+    long pad_x = (right - left) / 10;
+    long pad_y = std::max(2L, (right - left) * 15 / 100);
+    return dlib::rectangle(left - pad_x, top - pad_y, right + pad_x, bottom + pad_y);
+}
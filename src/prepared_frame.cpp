@@ -0,0 +1,80 @@
+#include "../include/prepared_frame.hpp"
+#include <algorithm>
+
+void PreparedFrame::reset(const cv::Mat& image) {
+    _image = image;
+    _parent = nullptr;
+    _grayValid = false;
+    for (auto& cached : _levels) {
+        cached.valid = false;
+    }
+    _conversions = 0;
+}
+
+void PreparedFrame::reset(PreparedFrame& parent, const cv::Rect& roi) {
+    reset(parent.image()(roi));
+    _parent = &parent;
+    _roi = roi;
+}
+
+const cv::Mat& PreparedFrame::gray() {
+    if (_image.channels() != 3) {
+        return _image;
+    }
+    if (!_grayValid) {
+        if (_parent && _parent->_grayValid) {
+            _gray = _parent->_gray(_roi);
+        } else {
+            cv::cvtColor(_image, _grayBuffer, cv::COLOR_BGR2GRAY);
+            _gray = _grayBuffer;
+            _conversions++;
+        }
+        _grayValid = true;
+    }
+    return _gray;
+}
+
+const cv::Mat& PreparedFrame::downscaledGray(double scale) {
+    if (scale >= 1.0) {
+        return gray();
+    }
+    Level& cached = level(scale, false);
+    if (!cached.valid) {
+        cv::resize(gray(), cached.image, cv::Size(), scale, scale, cv::INTER_AREA);
+        cached.valid = true;
+        _conversions++;
+    }
+    return cached.image;
+}
+
+const cv::Mat& PreparedFrame::downscaledImage(double scale) {
+    if (_image.channels() != 3) {
+        return downscaledGray(scale);
+    }
+    if (scale >= 1.0) {
+        return _image;
+    }
+    Level& cached = level(scale, true);
+    if (!cached.valid) {
+        cv::resize(_image, cached.image, cv::Size(), scale, scale, cv::INTER_AREA);
+        cached.valid = true;
+        _conversions++;
+    }
+    return cached.image;
+}
+
+PreparedFrame::Level& PreparedFrame::level(double scale, bool color) {
+    for (auto& cached : _levels) {
+        if (cached.scale == scale && cached.color == color) {
+            return cached;
+        }
+    }
+    // 本帧未使用且比例不同的缓存来自修改前的缩放比例，释放掉，避免每次修改比例都多留一块缓冲
+    _levels.erase(std::remove_if(_levels.begin(), _levels.end(), [scale](const Level& cached) {
+        return !cached.valid && cached.scale != scale;
+    }), _levels.end());
+    _levels.emplace_back();
+    _levels.back().scale = scale;
+    _levels.back().color = color;
+    return _levels.back();
+}
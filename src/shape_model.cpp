@@ -0,0 +1,640 @@
+#include "../include/shape_model.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cstddef>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 使用C++17的文件系统库
+namespace fs = std::filesystem;
+
+namespace {
+
+// 缓存文件格式
+constexpr char kFlatMagic[8] = {'D', 'M', 'S', 'E', 'R', 'T', '0', '1'};
+constexpr uint32_t kFlatVersion = 2;
+constexpr uint64_t kSectionAlign = 64;    // 各段按缓存行对齐，映射后可直接做向量化读取
+constexpr uint32_t kMaxTreeDepth = 16;
+constexpr uint32_t kMaxLandmarks = 4096;     // 以下上限只用于拒绝损坏的文件头，保证各段大小的计算不溢出
+constexpr uint32_t kMaxCascades = 1024;
+constexpr uint32_t kMaxTrees = 1u << 16;
+constexpr uint32_t kMaxPixels = 1u << 16;
+
+// dlib模型中的各部分（与 dlib::shape_predictor 的序列化顺序一致）
+struct ShapeModelParts {
+    dlib::matrix<float, 0, 1> initial_shape;
+    std::vector<std::vector<dlib::impl::regression_tree>> forests;
+    std::vector<std::vector<unsigned long>> anchor_idx;
+    std::vector<std::vector<dlib::vector<float, 2>>> deltas;
+};
+
+// 内容校验和：按64位字做4路交错的乘法-移位混合（与xxHash64的轮函数相同），尾部按字节处理。
+// 100MB的模型在页缓存中几十毫秒即可算完，能发现写了一半或被并发写混的缓存
+uint64_t contentChecksum(const uint8_t* data, size_t size) {
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    auto round = [](uint64_t acc, uint64_t word) {
+        acc += word * kPrime2;
+        acc = (acc << 31) | (acc >> 33);
+        return acc * kPrime1;
+    };
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, data + i + 8 * k, sizeof(word));
+            lanes[k] = round(lanes[k], word);
+        }
+    }
+    uint64_t hash = size;
+    for (int k = 0; k < 4; ++k) {
+        hash = round(hash ^ lanes[k], lanes[k]);
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * kPrime1;
+    }
+    return hash ^ (hash >> 29);
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSectionAlign - 1) / kSectionAlign * kSectionAlign;
+}
+
+int64_t fileMtime(const std::string& path, std::error_code& ec) {
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// 按 dlib::shape_predictor 的格式逐项解析模型文件
+bool readParts(const std::string& path, ShapeModelParts& parts, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "无法打开 " + path;
+        return false;
+    }
+    try {
+        int version = 0;
+        dlib::deserialize(version, in);
+        if (version != 1) {
+            error = "不支持的模型版本 " + std::to_string(version);
+            return false;
+        }
+        dlib::deserialize(parts.initial_shape, in);
+        dlib::deserialize(parts.forests, in);
+        dlib::deserialize(parts.anchor_idx, in);
+        dlib::deserialize(parts.deltas, in);
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+// 计算各段偏移，模型结构不规整（各树深度不同等）时返回false
+bool layoutHeader(const ShapeModelParts& parts, FlatShapeModelHeader& header, std::string& error) {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kFlatMagic, sizeof(kFlatMagic));
+    header.version = kFlatVersion;
+    header.header_bytes = sizeof(FlatShapeModelHeader);
+
+    const uint32_t L = static_cast<uint32_t>(parts.initial_shape.size() / 2);
+    const uint32_t C = static_cast<uint32_t>(parts.forests.size());
+    if (L == 0 || C == 0 || parts.forests[0].empty() || parts.forests[0][0].leaf_values.empty() ||
+        parts.anchor_idx.size() != C || parts.deltas.size() != C) {
+        error = "模型为空或各部分数量不一致";
+        return false;
+    }
+    const uint32_t T = static_cast<uint32_t>(parts.forests[0].size());
+    const uint32_t P = static_cast<uint32_t>(parts.anchor_idx[0].size());
+    const size_t leaves = parts.forests[0][0].leaf_values.size();
+    uint32_t depth = 0;
+    while ((size_t(1) << depth) < leaves) {
+        ++depth;
+    }
+    if ((size_t(1) << depth) != leaves || depth == 0 || depth > kMaxTreeDepth) {
+        error = "回归树叶子数不是2的幂: " + std::to_string(leaves);
+        return false;
+    }
+
+    // 展开要求每一层、每一棵树结构相同（dlib训练出的模型都满足）
+    for (uint32_t c = 0; c < C; ++c) {
+        if (parts.forests[c].size() != T || parts.anchor_idx[c].size() != P || parts.deltas[c].size() != P) {
+            error = "第 " + std::to_string(c) + " 层的回归树数或采样像素数与第0层不同";
+            return false;
+        }
+        for (const auto& tree : parts.forests[c]) {
+            if (tree.splits.size() != leaves - 1 || tree.leaf_values.size() != leaves) {
+                error = "第 " + std::to_string(c) + " 层存在深度不同的回归树";
+                return false;
+            }
+            for (const auto& leaf : tree.leaf_values) {
+                if (leaf.size() != 2 * L) {
+                    error = "叶子上的形状增量长度与特征点数不符";
+                    return false;
+                }
+            }
+        }
+    }
+
+    header.num_landmarks = L;
+    header.num_cascades = C;
+    header.trees_per_cascade = T;
+    header.tree_depth = depth;
+    header.pixels_per_cascade = P;
+
+    uint64_t offset = alignUp(sizeof(FlatShapeModelHeader));
+    header.initial_shape_offset = offset;
+    offset = alignUp(offset + uint64_t(2) * L * sizeof(float));
+    header.anchors_offset = offset;
+    offset = alignUp(offset + uint64_t(C) * P * sizeof(uint32_t));
+    header.deltas_offset = offset;
+    offset = alignUp(offset + uint64_t(C) * P * 2 * sizeof(float));
+    header.splits_offset = offset;
+    offset = alignUp(offset + uint64_t(C) * T * (leaves - 1) * sizeof(FlatSplit));
+    header.leaves_offset = offset;
+    offset = offset + uint64_t(C) * T * leaves * 2 * L * sizeof(float);
+    header.file_bytes = offset;
+    return true;
+}
+
+void writePadding(std::ofstream& out, uint64_t target) {
+    static const char zeros[kSectionAlign] = {0};
+    uint64_t position = static_cast<uint64_t>(out.tellp());
+    if (target > position) {
+        out.write(zeros, static_cast<std::streamsize>(target - position));
+    }
+}
+
+// 映射临时文件，计算文件头之后内容的校验和并写入文件头
+bool writeChecksum(const std::string& path, uint64_t header_bytes, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        error = "无法打开 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    void* address = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) >= header_bytes) {
+        address = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (address == MAP_FAILED) {
+        error = "无法映射 " + path;
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    uint64_t checksum = contentChecksum(static_cast<const uint8_t*>(address) + header_bytes, size - header_bytes);
+    munmap(address, size);
+
+    const off_t offset = static_cast<off_t>(offsetof(FlatShapeModelHeader, checksum));
+    bool ok = pwrite(fd, &checksum, sizeof(checksum), offset) == static_cast<ssize_t>(sizeof(checksum));
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        error = "写入校验和失败: " + path;
+    }
+    return ok;
+}
+
+bool writeFlat(const ShapeModelParts& parts, const FlatShapeModelHeader& header,
+               const std::string& path, std::string& error) {
+    // 先写临时文件再改名：其他进程可能正映射着旧的缓存。临时文件名唯一，
+    // 多个进程同时发现缓存过期时各自写自己的文件，最后改名的完整文件生效
+    std::string temp = path + ".tmp.XXXXXX";
+    int temp_fd = mkstemp(&temp[0]);
+    if (temp_fd < 0) {
+        error = "无法创建临时文件 " + temp + ": " + std::strerror(errno);
+        return false;
+    }
+    // mkstemp创建的文件只有属主可读，缓存需要其他进程（可能是其他用户）也能映射
+    fchmod(temp_fd, 0644);
+    ::close(temp_fd);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "无法创建 " + temp;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        writePadding(out, header.initial_shape_offset);
+        for (long i = 0; i < parts.initial_shape.size(); ++i) {
+            float v = parts.initial_shape(i);
+            out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+
+        writePadding(out, header.anchors_offset);
+        for (const auto& anchors : parts.anchor_idx) {
+            for (unsigned long anchor : anchors) {
+                uint32_t v = static_cast<uint32_t>(anchor);
+                out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+            }
+        }
+
+        writePadding(out, header.deltas_offset);
+        for (const auto& deltas : parts.deltas) {
+            for (const auto& delta : deltas) {
+                float v[2] = {delta.x(), delta.y()};
+                out.write(reinterpret_cast<const char*>(v), sizeof(v));
+            }
+        }
+
+        writePadding(out, header.splits_offset);
+        for (const auto& forest : parts.forests) {
+            for (const auto& tree : forest) {
+                for (const auto& split : tree.splits) {
+                    FlatSplit v = {static_cast<uint32_t>(split.idx1), static_cast<uint32_t>(split.idx2), split.thresh};
+                    out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+                }
+            }
+        }
+
+        writePadding(out, header.leaves_offset);
+        for (const auto& forest : parts.forests) {
+            for (const auto& tree : forest) {
+                for (const auto& leaf : tree.leaf_values) {
+                    out.write(reinterpret_cast<const char*>(&leaf(0)),
+                              static_cast<std::streamsize>(leaf.size() * sizeof(float)));
+                }
+            }
+        }
+
+        out.flush();
+        if (!out) {
+            error = "写入 " + temp + " 失败";
+            out.close();
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+
+    // 回读写好的内容计算校验和，写回文件头
+    std::error_code ec;
+    if (!writeChecksum(temp, header.header_bytes, error)) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    fs::rename(temp, path, ec);
+    if (ec) {
+        error = "无法改名为 " + path + ": " + ec.message();
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// 由采样点的锚点和偏移还原平均形状坐标系下的像素位置（dlib预测器的构造函数会重新编码为锚点和偏移）
+template <typename AnchorAt, typename DeltaAt>
+void buildPixelCoordinates(const dlib::matrix<float, 0, 1>& initial_shape, size_t cascades, size_t pixels,
+                           AnchorAt anchor_at, DeltaAt delta_at,
+                           std::vector<std::vector<dlib::vector<float, 2>>>& coordinates) {
+    coordinates.assign(cascades, std::vector<dlib::vector<float, 2>>(pixels));
+    for (size_t c = 0; c < cascades; ++c) {
+        for (size_t p = 0; p < pixels; ++p) {
+            size_t anchor = anchor_at(c, p);
+            dlib::vector<float, 2> delta = delta_at(c, p);
+            coordinates[c][p] = dlib::vector<float, 2>(initial_shape(2 * anchor) + delta.x(),
+                                                       initial_shape(2 * anchor + 1) + delta.y());
+        }
+    }
+}
+
+void partsToPredictor(ShapeModelParts& parts, dlib::shape_predictor& predictor) {
+    std::vector<std::vector<dlib::vector<float, 2>>> coordinates;
+    buildPixelCoordinates(parts.initial_shape, parts.forests.size(), parts.anchor_idx[0].size(),
+        [&parts](size_t c, size_t p) { return parts.anchor_idx[c][p]; },
+        [&parts](size_t c, size_t p) { return parts.deltas[c][p]; },
+        coordinates);
+    predictor = dlib::shape_predictor(parts.initial_shape, parts.forests, coordinates);
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+std::string ShapeModelConfig::cachePath() const {
+    return cache_path.empty() ? path + ".flat" : cache_path;
+}
+
+FlatShapeModel::FlatShapeModel(const uint8_t* data, size_t size)
+    : _data(data),
+      _size(size),
+      _header(reinterpret_cast<const FlatShapeModelHeader*>(data)) {
+}
+
+FlatShapeModel::~FlatShapeModel() {
+    if (_data) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+}
+
+std::shared_ptr<const FlatShapeModel> FlatShapeModel::map(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "无法打开 " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FlatShapeModelHeader))) {
+        error = "文件过小: " + path;
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        error = "无法映射 " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    std::shared_ptr<FlatShapeModel> model(new FlatShapeModel(static_cast<const uint8_t*>(address), size));
+
+    // 校验文件头和各段范围，之后的访问不再检查边界
+    const FlatShapeModelHeader& h = *model->_header;
+    if (std::memcmp(h.magic, kFlatMagic, sizeof(kFlatMagic)) != 0) {
+        error = "不是展开的模型缓存: " + path;
+        return nullptr;
+    }
+    if (h.version != kFlatVersion || h.header_bytes != sizeof(FlatShapeModelHeader)) {
+        error = "模型缓存版本不符: " + std::to_string(h.version);
+        return nullptr;
+    }
+    if (h.num_landmarks == 0 || h.num_cascades == 0 || h.trees_per_cascade == 0 || h.pixels_per_cascade == 0 ||
+        h.tree_depth == 0 || h.tree_depth > kMaxTreeDepth || h.num_landmarks > kMaxLandmarks ||
+        h.num_cascades > kMaxCascades || h.trees_per_cascade > kMaxTrees || h.pixels_per_cascade > kMaxPixels ||
+        h.file_bytes != size) {
+        error = "模型缓存文件头无效或文件不完整: " + path;
+        return nullptr;
+    }
+    const uint64_t C = h.num_cascades;
+    const uint64_t T = h.trees_per_cascade;
+    const uint64_t P = h.pixels_per_cascade;
+    const uint64_t L = h.num_landmarks;
+    const uint64_t leaves = uint64_t(1) << h.tree_depth;
+    struct Section { uint64_t offset; uint64_t bytes; };
+    const Section sections[] = {
+        {h.initial_shape_offset, 2 * L * sizeof(float)},
+        {h.anchors_offset, C * P * sizeof(uint32_t)},
+        {h.deltas_offset, C * P * 2 * sizeof(float)},
+        {h.splits_offset, C * T * (leaves - 1) * sizeof(FlatSplit)},
+        {h.leaves_offset, C * T * leaves * 2 * L * sizeof(float)},
+    };
+    for (const Section& section : sections) {
+        if (section.offset % alignof(float) != 0 || section.offset < sizeof(FlatShapeModelHeader) ||
+            section.offset > size || section.bytes > size - section.offset) {
+            error = "模型缓存的数据段越界: " + path;
+            return nullptr;
+        }
+    }
+    // 内容校验：拒绝写了一半或被并发写混、但大小恰好正确的文件
+    if (contentChecksum(model->_data + h.header_bytes, size - h.header_bytes) != h.checksum) {
+        error = "模型缓存校验和不符: " + path;
+        return nullptr;
+    }
+    const uint32_t* anchors = model->anchors(0);
+    for (uint64_t i = 0; i < C * P; ++i) {
+        if (anchors[i] >= L) {
+            error = "模型缓存中的锚点越界: " + path;
+            return nullptr;
+        }
+    }
+    const FlatSplit* splits = model->splits(0, 0);
+    for (uint64_t i = 0; i < C * T * (leaves - 1); ++i) {
+        if (splits[i].idx1 >= P || splits[i].idx2 >= P) {
+            error = "模型缓存中的采样像素编号越界: " + path;
+            return nullptr;
+        }
+    }
+    return model;
+}
+
+bool FlatShapeModel::convert(const std::string& dat_path, const std::string& flat_path, std::string& error) {
+    ShapeModelParts parts;
+    if (!readParts(dat_path, parts, error)) {
+        return false;
+    }
+    FlatShapeModelHeader header;
+    if (!layoutHeader(parts, header, error)) {
+        return false;
+    }
+    std::error_code ec;
+    header.source_bytes = static_cast<uint64_t>(fs::file_size(dat_path, ec));
+    header.source_mtime = fileMtime(dat_path, ec);
+    return writeFlat(parts, header, flat_path, error);
+}
+
+namespace {
+
+// 生成缓存的dlib模型文件（不存在时表示只部署了缓存）
+struct SourceStamp {
+    bool exists = false;
+    uint64_t bytes = 0;
+    int64_t mtime = 0;
+};
+
+SourceStamp sourceStamp(const std::string& path) {
+    SourceStamp stamp;
+    std::error_code ec;
+    stamp.exists = fs::exists(path, ec);
+    if (stamp.exists) {
+        stamp.bytes = static_cast<uint64_t>(fs::file_size(path, ec));
+        stamp.mtime = fileMtime(path, ec);
+    }
+    return stamp;
+}
+
+// 缓存有效且由当前的dlib模型生成时映射缓存，否则返回空指针
+std::shared_ptr<const FlatShapeModel> mapCurrentCache(const ShapeModelConfig& config, const SourceStamp& source) {
+    const std::string cache_path = config.cachePath();
+    std::error_code ec;
+    if (!fs::exists(cache_path, ec)) {
+        return nullptr;
+    }
+    std::string error;
+    std::shared_ptr<const FlatShapeModel> model = FlatShapeModel::map(cache_path, error);
+    if (!model) {
+        std::cerr << "忽略无效的模型缓存: " << error << std::endl;
+        return nullptr;
+    }
+    // dlib模型存在时，缓存必须由同一个文件生成；只部署缓存时直接使用缓存
+    if (source.exists && (model->header().source_bytes != source.bytes ||
+                          model->header().source_mtime != source.mtime)) {
+        std::cout << "模型缓存已过期，重新从 " << config.path << " 生成" << std::endl;
+        return nullptr;
+    }
+    return model;
+}
+
+} // namespace
+
+bool FlatShapeModel::loadPredictor(const ShapeModelConfig& config, dlib::shape_predictor& predictor,
+                                   ShapeModelLoadInfo& info) {
+    auto start = std::chrono::steady_clock::now();
+    const std::string cache_path = config.cachePath();
+    info = ShapeModelLoadInfo();
+
+    SourceStamp stamp = sourceStamp(config.path);
+    if (std::shared_ptr<const FlatShapeModel> model = mapCurrentCache(config, stamp)) {
+        model->toPredictor(predictor);
+        info.from_cache = true;
+        info.source = cache_path;
+        info.load_ms = millisecondsSince(start);
+        return true;
+    }
+
+    // 解析dlib模型
+    ShapeModelParts parts;
+    std::string error;
+    if (!readParts(config.path, parts, error)) {
+        std::cerr << "无法加载面部特征点预测模型: " << error << std::endl;
+        std::cerr << "请确保 " << config.path << " 文件存在" << std::endl;
+        return false;
+    }
+    info.source = config.path;
+
+    if (config.build_cache) {
+        FlatShapeModelHeader header;
+        if (layoutHeader(parts, header, error)) {
+            header.source_bytes = stamp.bytes;
+            header.source_mtime = stamp.mtime;
+            info.cache_written = writeFlat(parts, header, cache_path, error);
+        }
+        if (info.cache_written) {
+            std::cout << "已生成模型缓存: " << cache_path << std::endl;
+        } else {
+            std::cerr << "无法生成模型缓存: " << error << std::endl;
+        }
+    }
+
+    partsToPredictor(parts, predictor);
+    info.load_ms = millisecondsSince(start);
+    return true;
+}
+
+std::shared_ptr<const FlatShapeModel> FlatShapeModel::load(const ShapeModelConfig& config, ShapeModelLoadInfo& info) {
+    auto start = std::chrono::steady_clock::now();
+    const std::string cache_path = config.cachePath();
+    info = ShapeModelLoadInfo();
+    info.engine = LandmarkEngine::FLAT;
+
+    std::shared_ptr<const FlatShapeModel> model = mapCurrentCache(config, sourceStamp(config.path));
+    if (model) {
+        info.from_cache = true;
+    } else {
+        if (!config.build_cache) {
+            std::cerr << "没有可用的模型缓存，且未开启 build_cache: " << cache_path << std::endl;
+            return nullptr;
+        }
+        std::string error;
+        if (!convert(config.path, cache_path, error)) {
+            std::cerr << "无法生成模型缓存: " << error << std::endl;
+            return nullptr;
+        }
+        std::cout << "已生成模型缓存: " << cache_path << std::endl;
+        info.cache_written = true;
+        model = map(cache_path, error);
+        if (!model) {
+            std::cerr << "生成的模型缓存无效: " << error << std::endl;
+            return nullptr;
+        }
+    }
+    info.source = cache_path;
+    info.load_ms = millisecondsSince(start);
+    return model;
+}
+
+LandmarkEngine FlatShapeModel::stringToEngine(const std::string& engine_str) {
+    if (engine_str == "flat") {
+        return LandmarkEngine::FLAT;
+    } else {
+        return LandmarkEngine::DLIB;
+    }
+}
+
+std::string FlatShapeModel::engineToString(LandmarkEngine engine) {
+    switch (engine) {
+        case LandmarkEngine::FLAT:
+            return "flat";
+        case LandmarkEngine::DLIB:
+            return "dlib";
+        default:
+            return "dlib";
+    }
+}
+
+void FlatShapeModel::toPredictor(dlib::shape_predictor& predictor) const {
+    const uint32_t L = numLandmarks();
+    const uint32_t C = numCascades();
+    const uint32_t T = treesPerCascade();
+    const uint32_t P = pixelsPerCascade();
+    const uint32_t split_count = splitsPerTree();
+    const uint32_t leaf_count = leavesPerTree();
+
+    dlib::matrix<float, 0, 1> initial_shape(2 * L);
+    std::memcpy(&initial_shape(0), initialShape(), sizeof(float) * 2 * L);
+
+    std::vector<std::vector<dlib::impl::regression_tree>> forests(C);
+    for (uint32_t c = 0; c < C; ++c) {
+        forests[c].resize(T);
+        for (uint32_t t = 0; t < T; ++t) {
+            dlib::impl::regression_tree& tree = forests[c][t];
+            const FlatSplit* flat_splits = splits(c, t);
+            tree.splits.resize(split_count);
+            for (uint32_t i = 0; i < split_count; ++i) {
+                tree.splits[i].idx1 = flat_splits[i].idx1;
+                tree.splits[i].idx2 = flat_splits[i].idx2;
+                tree.splits[i].thresh = flat_splits[i].thresh;
+            }
+            const float* flat_leaves = leaves(c, t);
+            tree.leaf_values.resize(leaf_count);
+            for (uint32_t i = 0; i < leaf_count; ++i) {
+                tree.leaf_values[i].set_size(2 * L);
+                std::memcpy(&tree.leaf_values[i](0), flat_leaves + size_t(i) * 2 * L, sizeof(float) * 2 * L);
+            }
+        }
+    }
+
+    std::vector<std::vector<dlib::vector<float, 2>>> coordinates;
+    buildPixelCoordinates(initial_shape, C, P,
+        [this](size_t c, size_t p) { return anchors(static_cast<uint32_t>(c))[p]; },
+        [this](size_t c, size_t p) {
+            const float* d = deltas(static_cast<uint32_t>(c)) + 2 * p;
+            return dlib::vector<float, 2>(d[0], d[1]);
+        },
+        coordinates);
+    predictor = dlib::shape_predictor(initial_shape, forests, coordinates);
+}
+
+const float* FlatShapeModel::initialShape() const {
+    return reinterpret_cast<const float*>(_data + _header->initial_shape_offset);
+}
+
+const uint32_t* FlatShapeModel::anchors(uint32_t cascade) const {
+    return reinterpret_cast<const uint32_t*>(_data + _header->anchors_offset) +
+           size_t(cascade) * _header->pixels_per_cascade;
+}
+
+const float* FlatShapeModel::deltas(uint32_t cascade) const {
+    return reinterpret_cast<const float*>(_data + _header->deltas_offset) +
+           size_t(cascade) * _header->pixels_per_cascade * 2;
+}
+
+const FlatSplit* FlatShapeModel::splits(uint32_t cascade, uint32_t tree) const {
+    return reinterpret_cast<const FlatSplit*>(_data + _header->splits_offset) +
+           (size_t(cascade) * _header->trees_per_cascade + tree) * splitsPerTree();
+}
+
+const float* FlatShapeModel::leaves(uint32_t cascade, uint32_t tree) const {
+    return reinterpret_cast<const float*>(_data + _header->leaves_offset) +
+           (size_t(cascade) * _header->trees_per_cascade + tree) * leavesPerTree() * 2 * _header->num_landmarks;
+}
@@ -0,0 +1,191 @@
+#include "../include/threshold_sweep.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 每个任务同时处理的EAR/MAR阈值个数
+constexpr size_t kLanes = 8;
+
+// 一组阈值（最多kLanes个）在所有序列上的累计
+// kBelow为true时特征低于阈值计数（闭眼），否则高于阈值计数（哈欠）
+template <bool kBelow>
+void sweepBlock(const std::vector<SweepSeries>& series,
+                const float* thresholds, size_t lanes,
+                const std::vector<int>& frame_counts,
+                SweepResult* results) {
+    const size_t k_count = frame_counts.size();
+    const size_t cells = kLanes * k_count;
+
+    // 阈值不足kLanes个时用无法触发的值填充，循环长度固定便于向量化
+    float thr[kLanes];
+    for (size_t l = 0; l < kLanes; ++l) {
+        thr[l] = l < lanes ? thresholds[l] : (kBelow ? -1e30f : 1e30f);
+    }
+    std::vector<uint32_t> need(frame_counts.begin(), frame_counts.end());
+
+    std::vector<uint64_t> alerts(cells, 0), flagged(cells, 0), tp(cells, 0), fp(cells, 0), fn(cells, 0);
+    std::vector<uint64_t> events_hit(cells, 0);
+    uint64_t labelled_events = 0;
+
+    // 单个序列内用32位计数，序列结束后累加到64位
+    std::vector<uint32_t> a32(cells), f32(cells), tp32(cells), fp32(cells), fn32(cells), prev(cells), run_hit(cells);
+
+    for (const SweepSeries& s : series) {
+        uint32_t counters[kLanes] = {0};
+        std::fill(a32.begin(), a32.end(), 0);
+        std::fill(f32.begin(), f32.end(), 0);
+        std::fill(tp32.begin(), tp32.end(), 0);
+        std::fill(fp32.begin(), fp32.end(), 0);
+        std::fill(fn32.begin(), fn32.end(), 0);
+        std::fill(prev.begin(), prev.end(), 0);
+        std::fill(run_hit.begin(), run_hit.end(), 0);
+        uint32_t prev_label = 0;
+
+        const size_t n = std::min({s.value.size(), s.has_face.size(), s.label.size()});
+        for (size_t i = 0; i < n; ++i) {
+            const float v = s.value[i];
+            const uint32_t face = s.has_face[i] ? 1u : 0u;
+            const uint32_t label = s.label[i] ? 1u : 0u;
+
+            // 与detectEyesClosed/detectYawning相同：满足条件计数加一，否则清零；没有人脸的帧保持不变
+            for (size_t l = 0; l < kLanes; ++l) {
+                uint32_t hit = kBelow ? (v < thr[l]) : (v > thr[l]);
+                uint32_t next = hit * (counters[l] + 1);
+                counters[l] = face ? next : counters[l];
+            }
+
+            for (size_t l = 0; l < kLanes; ++l) {
+                const uint32_t c = counters[l];
+                uint32_t* pa = &a32[l * k_count];
+                uint32_t* pf = &f32[l * k_count];
+                uint32_t* ptp = &tp32[l * k_count];
+                uint32_t* pfp = &fp32[l * k_count];
+                uint32_t* pfn = &fn32[l * k_count];
+                uint32_t* pprev = &prev[l * k_count];
+                uint32_t* prun = &run_hit[l * k_count];
+                for (size_t k = 0; k < k_count; ++k) {
+                    uint32_t flag = face & static_cast<uint32_t>(c >= need[k]);
+                    pa[k] += flag & (pprev[k] ^ 1u);
+                    pprev[k] = flag;
+                    pf[k] += flag;
+                    ptp[k] += flag & label;
+                    pfp[k] += flag & (label ^ 1u);
+                    pfn[k] += (flag ^ 1u) & label;
+                    prun[k] |= flag & label;
+                }
+            }
+
+            // 标注段结束：统计该段是否被检出
+            if (prev_label && !label) {
+                labelled_events++;
+                for (size_t c = 0; c < cells; ++c) {
+                    events_hit[c] += run_hit[c];
+                    run_hit[c] = 0;
+                }
+            }
+            prev_label = label;
+        }
+        if (prev_label) {
+            labelled_events++;
+            for (size_t c = 0; c < cells; ++c) {
+                events_hit[c] += run_hit[c];
+            }
+        }
+
+        for (size_t c = 0; c < cells; ++c) {
+            alerts[c] += a32[c];
+            flagged[c] += f32[c];
+            tp[c] += tp32[c];
+            fp[c] += fp32[c];
+            fn[c] += fn32[c];
+        }
+    }
+
+    for (size_t l = 0; l < lanes; ++l) {
+        for (size_t k = 0; k < k_count; ++k) {
+            size_t c = l * k_count + k;
+            SweepResult& r = results[l * k_count + k];
+            r.threshold = thresholds[l];
+            r.frames = frame_counts[k];
+            r.alerts = alerts[c];
+            r.flagged_frames = flagged[c];
+            r.true_positive = tp[c];
+            r.false_positive = fp[c];
+            r.false_negative = fn[c];
+            r.labelled_events = labelled_events;
+            r.detected_events = events_hit[c];
+        }
+    }
+}
+
+} // namespace
+
+double SweepResult::precision() const {
+    uint64_t predicted = true_positive + false_positive;
+    return predicted > 0 ? static_cast<double>(true_positive) / predicted : 0.0;
+}
+
+double SweepResult::recall() const {
+    uint64_t actual = true_positive + false_negative;
+    return actual > 0 ? static_cast<double>(true_positive) / actual : 0.0;
+}
+
+double SweepResult::f1() const {
+    double p = precision();
+    double r = recall();
+    return p + r > 0 ? 2.0 * p * r / (p + r) : 0.0;
+}
+
+double SweepResult::eventRecall() const {
+    return labelled_events > 0 ? static_cast<double>(detected_events) / labelled_events : 0.0;
+}
+
+std::vector<double> ThresholdSweep::range(double from, double to, double step) {
+    std::vector<double> values;
+    if (step <= 0) {
+        values.push_back(from);
+        return values;
+    }
+    // 按步数生成，避免浮点累加误差
+    long count = static_cast<long>(std::floor((to - from) / step + 1e-9)) + 1;
+    for (long i = 0; i < count; ++i) {
+        values.push_back(from + i * step);
+    }
+    return values;
+}
+
+std::vector<SweepResult> ThresholdSweep::run(SweepDetector detector,
+                                             const std::vector<SweepSeries>& series,
+                                             const std::vector<double>& thresholds,
+                                             const std::vector<int>& frame_counts,
+                                             WorkStealingPool& pool) {
+    std::vector<SweepResult> results(thresholds.size() * frame_counts.size());
+    if (results.empty()) {
+        return results;
+    }
+
+    // 特征以float存储，阈值同样按float比较
+    std::vector<float> thr(thresholds.begin(), thresholds.end());
+    const size_t k_count = frame_counts.size();
+
+    for (size_t first = 0; first < thr.size(); first += kLanes) {
+        size_t lanes = std::min(kLanes, thr.size() - first);
+        SweepResult* out = &results[first * k_count];
+        const float* block = &thr[first];
+        pool.submit([detector, &series, block, lanes, &frame_counts, out] {
+            if (detector == SweepDetector::EYES_CLOSED) {
+                sweepBlock<true>(series, block, lanes, frame_counts, out);
+            } else {
+                sweepBlock<false>(series, block, lanes, frame_counts, out);
+            }
+        });
+    }
+    pool.waitIdle();
+
+    // 输出原始的阈值（而不是转换为float后的值）
+    for (size_t i = 0; i < results.size(); ++i) {
+        results[i].threshold = thresholds[i / k_count];
+    }
+    return results;
+}
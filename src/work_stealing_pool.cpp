@@ -0,0 +1,145 @@
+#include "../include/work_stealing_pool.hpp"
+#include <iostream>
+#include <chrono>
+
+namespace {
+// 当前线程在所属线程池中的编号
+thread_local int t_workerIndex = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int thread_count)
+    : _stopping(false),
+      _nextQueue(0),
+      _stealCount(0),
+      _pendingTasks(0),
+      _queuedTasks(0) {
+    if (thread_count <= 0) {
+        thread_count = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (thread_count <= 0) {
+        thread_count = 1;
+    }
+
+    for (int i = 0; i < thread_count; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (int i = 0; i < thread_count; ++i) {
+        _workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    shutdown();
+}
+
+void WorkStealingPool::submit(Task task) {
+    // 工作线程内提交的任务放到自己的队列，外部提交的任务轮流分配
+    int index = t_workerIndex;
+    if (index < 0 || index >= static_cast<int>(_queues.size())) {
+        index = static_cast<int>(_nextQueue++ % _queues.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _pendingTasks++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+        _queuedTasks++;
+    }
+    {
+        // 持有等待锁再通知，避免工作线程检查条件后、进入等待前错过唤醒
+        std::lock_guard<std::mutex> lock(_idleMutex);
+    }
+    _workAvailable.notify_one();
+}
+
+void WorkStealingPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(_idleMutex);
+    _allIdle.wait(lock, [this] { return _pendingTasks == 0 || _stopping; });
+}
+
+void WorkStealingPool::shutdown() {
+    if (_stopping.exchange(true)) {
+        return;
+    }
+
+    _workAvailable.notify_all();
+    for (auto& worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    _workers.clear();
+    _allIdle.notify_all();
+}
+
+int WorkStealingPool::size() const {
+    return static_cast<int>(_queues.size());
+}
+
+int WorkStealingPool::currentWorkerIndex() {
+    return t_workerIndex;
+}
+
+uint64_t WorkStealingPool::getStealCount() const {
+    return _stealCount;
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    t_workerIndex = index;
+
+    while (!_stopping) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "线程池任务异常: " << e.what() << std::endl;
+            }
+
+            std::lock_guard<std::mutex> lock(_idleMutex);
+            if (--_pendingTasks == 0) {
+                _allIdle.notify_all();
+            }
+            continue;
+        }
+
+        // 没有任务可执行：等待新任务入队（带超时作为兜底）
+        std::unique_lock<std::mutex> lock(_idleMutex);
+        _workAvailable.wait_for(lock, std::chrono::milliseconds(5), [this] {
+            return _stopping || _queuedTasks > 0;
+        });
+    }
+
+    t_workerIndex = -1;
+}
+
+bool WorkStealingPool::popLocal(int index, Task& task) {
+    WorkerQueue& queue = *_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    _queuedTasks--;
+    return true;
+}
+
+bool WorkStealingPool::steal(int index, Task& task) {
+    const size_t count = _queues.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        WorkerQueue& victim = *_queues[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            _queuedTasks--;
+            _stealCount++;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,348 @@
+// 驾驶行为监测系统每帧堆分配检查
+//
+// 用法:
+//   dms_alloc_check [帧数] [--warmup N] [--model 模型文件 --video 视频文件或图像目录]
+//
+// 替换全局operator new/delete，统计主线程上的堆分配次数（cv::Mat的缓冲也经由operator new
+// 分配UMatData，同样会被计入）。按单路流水线（drop_oldest）的顺序逐帧执行本项目实现的部分：
+// 帧缓冲池读帧、最新帧交换槽和阶段之间的无锁队列、推理阶段的预处理缓存、运动门控和复用、
+// 特征点随帧传递（packet.shape）、行为分析、特征记录、标注和当前帧发布。各阶段持有的FramePacket
+// 与流水线一样跨帧复用。预热之后这些阶段每帧的分配次数必须为0，否则返回1。
+//
+// 不指定模型时用合成的特征点代替特征点定位。指定模型和视频时，用真实的人脸定位（HOG检测/
+// 相关滤波跟踪）和flat引擎的特征点定位：人脸定位在dlib内部分配内存，其次数只输出、不作判定；
+// flat引擎是本项目的实现，同样要求每帧无分配（模型无法展开、退回dlib实现时不作判定）
+//
+// 需要以 -DDMS_ALLOC_CHECK=ON 配置CMake才会构建
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <random>
+#include <filesystem>
+#include "../include/driver_monitor.hpp"
+#include "../include/frame_annotator.hpp"
+#include "../include/feature_recorder.hpp"
+#include "../include/landmark_predictor.hpp"
+#include "../include/motion_gate.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+thread_local bool t_counting = false;
+
+void* countedAlloc(std::size_t size, std::size_t alignment) {
+    if (t_counting) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    void* p = nullptr;
+    if (alignment > alignof(std::max_align_t)) {
+        size = (size + alignment - 1) / alignment * alignment;
+        p = std::aligned_alloc(alignment, size);
+    } else {
+        p = std::malloc(size);
+    }
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    void* p = countedAlloc(size, 0);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, 0);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* p = countedAlloc(size, static_cast<std::size_t>(alignment));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+// 各阶段的分配计数
+enum Stage {
+    STAGE_CAPTURE,      // 帧缓冲池读帧、最新帧交换槽
+    STAGE_INFERENCE,    // 预处理缓存、运动门控与复用、特征点随帧传递、推理队列
+    STAGE_LOCATE,       // 人脸定位（dlib，可选）
+    STAGE_LANDMARKS,    // 特征点定位（合成或flat引擎；退回dlib实现时不判定）
+    STAGE_CLASSIFY,     // 行为分析、特征记录、分类队列
+    STAGE_DISPATCH,     // 标注、当前帧发布、行为名称
+    STAGE_COUNT
+};
+
+const char* kStageNames[STAGE_COUNT] = {"采集", "推理(门控与传递)", "人脸定位(dlib)", "特征点定位", "分类", "标注与分发"};
+
+// 只统计本线程、只统计被测代码
+class StageCounter {
+public:
+    explicit StageCounter(uint64_t& total) : _total(total), _start(g_allocations.load()) {
+        t_counting = true;
+    }
+    ~StageCounter() {
+        t_counting = false;
+        _total += g_allocations.load() - _start;
+    }
+
+private:
+    uint64_t& _total;
+    uint64_t _start;
+};
+
+// 合成的68点特征点（随机抖动，特征值覆盖睁眼、闭眼、张嘴等情况）
+std::vector<dlib::full_object_detection> makeShapes(size_t count, const dlib::rectangle& face) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> offset(-40, 40);
+    std::vector<dlib::full_object_detection> shapes;
+    for (size_t n = 0; n < count; ++n) {
+        std::vector<dlib::point> parts;
+        for (int i = 0; i < landmark_index::kNumLandmarks; ++i) {
+            parts.emplace_back(320 + offset(rng), 240 + offset(rng));
+        }
+        shapes.emplace_back(face, parts);
+    }
+    return shapes;
+}
+
+std::vector<cv::Mat> loadFrames(const std::string& path, size_t max_frames) {
+    std::vector<cv::Mat> frames;
+    FrameSourceConfig config;
+    config.type = fs::is_directory(path) ? FrameSourceType::IMAGE_SEQUENCE : FrameSourceType::VIDEO_FILE;
+    config.path = path;
+    config.as_fast_as_possible = true;
+    std::unique_ptr<FrameSource> source = FrameSource::create(config);
+    if (!source || !source->open()) {
+        return frames;
+    }
+    cv::Mat frame;
+    while (frames.size() < max_frames && source->read(frame)) {
+        frames.push_back(frame.clone());
+    }
+    return frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t frame_count = 300;
+    size_t warmup = 30;
+    std::string model_path;
+    std::string video_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--warmup" && i + 1 < argc) {
+            warmup = static_cast<size_t>(std::max(0, std::stoi(argv[++i])));
+        } else if (arg == "--model" && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if (arg == "--video" && i + 1 < argc) {
+            video_path = argv[++i];
+        } else if (arg.rfind("--", 0) != 0) {
+            frame_count = static_cast<size_t>(std::max(1, std::stoi(arg)));
+        } else {
+            std::cerr << "用法: dms_alloc_check [帧数] [--warmup N] [--model 模型文件 --video 视频文件或图像目录]" << std::endl;
+            return 1;
+        }
+    }
+    const bool real_inference = !model_path.empty() && !video_path.empty();
+
+    // 输入在计数之前准备好
+    std::vector<cv::Mat> frames;
+    LandmarkPredictor predictor;
+    bool landmarks_checked = true;
+    const std::string cache_path = (fs::temp_directory_path() / "dms_alloc_check.flat").string();
+    if (real_inference) {
+        ShapeModelConfig model_config;
+        model_config.path = model_path;
+        model_config.cache_path = cache_path;
+        model_config.engine = LandmarkEngine::FLAT;
+        ShapeModelLoadInfo model_info;
+        if (!predictor.load(model_config, model_info)) {
+            std::cerr << "无法加载面部特征点预测模型: " << model_path << std::endl;
+            return 1;
+        }
+        landmarks_checked = predictor.engine() == LandmarkEngine::FLAT;
+        frames = loadFrames(video_path, 200);
+        if (frames.empty()) {
+            std::cerr << "无法读取测试数据: " << video_path << std::endl;
+            return 1;
+        }
+    } else {
+        frames.push_back(cv::Mat(480, 640, CV_8UC3, cv::Scalar(90, 90, 90)));
+    }
+    const dlib::rectangle synthetic_face(220, 140, 420, 340);
+    std::vector<dlib::full_object_detection> shapes = makeShapes(64, synthetic_face);
+
+    // 流水线各阶段持有的对象（与DriverMonitor一样，各阶段的FramePacket跨帧复用）
+    FramePool pool(8, frames[0].cols, frames[0].rows, frames[0].type());
+    LatestSlot<FramePacket> latest_frame;
+    SpscQueue<FramePacket> inference_queue(4);
+    SpscQueue<FramePacket> classify_queue(4);
+    FramePacket inferring;
+    FramePacket classifying;
+    FramePacket dispatching;
+    ScaledFaceDetector detector(1.0);
+    FaceTracker tracker;
+    PreparedFrame prepared;
+    MotionGateConfig gate_config;
+    gate_config.enabled = true;
+    MotionGate gate(gate_config);
+    dlib::rectangle last_face;
+    dlib::full_object_detection last_shape;
+    BehaviorAnalyzer analyzer(1);
+    FrameAnnotator annotator;
+    FrameHandle current;
+    uint64_t frames_reused = 0;
+
+    FeatureRecorderConfig feature_config;
+    feature_config.enabled = true;
+    feature_config.dir = (fs::temp_directory_path() / "dms_alloc_check").string();
+    FeatureRecorder features(feature_config, "alloc_check");
+    features.start();
+
+    uint64_t warm[STAGE_COUNT] = {0};
+    uint64_t steady[STAGE_COUNT] = {0};
+    for (size_t n = 0; n < warmup + frame_count; ++n) {
+        uint64_t* counts = n < warmup ? warm : steady;
+        const cv::Mat& input = frames[n % frames.size()];
+
+        {
+            StageCounter counter(counts[STAGE_CAPTURE]);
+            FramePacket packet;
+            packet.frame = pool.acquire();
+            pool.read(packet.frame, [&input](cv::Mat& image) {
+                input.copyTo(image);
+                return true;
+            });
+            packet.sequence = n + 1;
+            packet.capture_time = std::chrono::steady_clock::now();
+            latest_frame.publish(std::move(packet));
+        }
+
+        // 推理阶段：与DriverMonitor::inferenceStage相同的顺序，dlib部分单独计数
+        bool reused = false;
+        {
+            StageCounter counter(counts[STAGE_INFERENCE]);
+            latest_frame.take(inferring);
+            prepared.reset(inferring.frame.image());
+            reused = gate.unchanged(prepared);
+            if (reused) {
+                inferring.has_face = true;
+                inferring.face = last_face;
+                inferring.shape = last_shape;
+                frames_reused++;
+            }
+        }
+        if (!reused) {
+            if (real_inference) {
+                StageCounter counter(counts[STAGE_LOCATE]);
+                bool invoked = false;
+                inferring.has_face = tracker.locate(prepared, detector, inferring.face, invoked);
+            } else {
+                inferring.has_face = true;
+                inferring.face = synthetic_face;
+            }
+            if (inferring.has_face) {
+                {
+                    StageCounter counter(counts[STAGE_LANDMARKS]);
+                    if (real_inference) {
+                        predictor.predict(inferring.frame.image(), inferring.face, last_shape);
+                    } else {
+                        last_shape = shapes[n % shapes.size()];
+                    }
+                }
+                StageCounter counter(counts[STAGE_INFERENCE]);
+                tracker.update(last_shape);
+                gate.update(prepared, inferring.face, last_shape);
+                last_face = inferring.face;
+                inferring.shape = last_shape;
+            } else {
+                gate.reset();
+            }
+        }
+        {
+            StageCounter counter(counts[STAGE_INFERENCE]);
+            inference_queue.tryPush(std::move(inferring));
+        }
+
+        {
+            StageCounter counter(counts[STAGE_CLASSIFY]);
+            inference_queue.tryPop(classifying);
+            classifying.behavior = DriverBehavior::NORMAL;
+            if (classifying.has_face) {
+                classifying.behavior = analyzer.analyze(classifying.frame.image(), classifying.shape);
+            }
+            features.record(FeatureRecorder::makeSample(
+                classifying.sequence, classifying.has_face, classifying.face, analyzer.getLastFeatures(),
+                classifying.behavior));
+            classify_queue.tryPush(std::move(classifying));
+        }
+
+        {
+            StageCounter counter(counts[STAGE_DISPATCH]);
+            classify_queue.tryPop(dispatching);
+            annotator.annotate(dispatching.frame.mutableImage(), dispatching.has_face, dispatching.face,
+                               dispatching.shape, dispatching.behavior);
+            current = dispatching.frame;
+            std::string_view name = DriverMonitor::behaviorName(dispatching.behavior);
+            (void)name;
+        }
+    }
+    features.stop();
+    fs::remove_all(feature_config.dir);
+    std::error_code ec;
+    fs::remove(cache_path, ec);
+
+    std::cout << "预热帧数: " << warmup << " 检查帧数: " << frame_count
+              << (real_inference ? "（真实人脸定位和特征点）" : "（合成特征点）")
+              << " 运动门控复用: " << frames_reused << " 帧" << std::endl;
+    std::cout << std::left << std::setw(24) << "阶段" << std::setw(14) << "预热分配" << "每帧分配(稳定后)" << std::endl;
+    bool ok = true;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        bool checked = s != STAGE_LOCATE && (s != STAGE_LANDMARKS || landmarks_checked);
+        if (!checked && !real_inference) {
+            continue;
+        }
+        double per_frame = static_cast<double>(steady[s]) / frame_count;
+        std::cout << std::left << std::setw(24) << kStageNames[s] << std::setw(14) << warm[s]
+                  << std::fixed << std::setprecision(2) << per_frame
+                  << (checked ? (steady[s] == 0 ? "  通过" : "  失败") : "  (不判定)") << std::endl;
+        if (checked && steady[s] != 0) {
+            ok = false;
+        }
+    }
+    std::cout << (ok ? "稳定状态下每帧无堆分配" : "稳定状态下仍有堆分配") << std::endl;
+    return ok ? 0 : 1;
+}
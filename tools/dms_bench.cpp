@@ -0,0 +1,584 @@
+// 驾驶行为监测系统性能基准工具
+//
+// 用法:
+//   dms_bench scale <模型文件> <视频文件或图像目录> [缩放比例...]
+//   dms_bench features [特征点组数] [轮数]
+//   dms_bench landmarks <模型文件> [视频文件或图像目录]
+//   dms_bench detectors <视频文件或图像目录> [YuNet模型文件] [DNN线程数] [缩放比例]
+//   dms_bench hog <视频文件或图像目录> [线程数] [缩放比例]
+//
+// scale:    以全分辨率检测+特征点定位的结果为基准，比较不同检测缩放比例下的
+//           检测耗时、帧率、人脸检出率以及特征点误差（按眼角距离归一化的平均误差）
+// features: 比较逐点计算（每帧构造std::vector、double精度pow/sqrt）和特征点几何特征内核
+//           计算EAR/MAR/侧倾角的耗时，并检查两者结果的最大差异
+// landmarks: 在同一组人脸框上比较dlib::shape_predictor和展开模型推理引擎(FlatShapePredictor)的
+//           每张人脸耗时和特征点差异（指定视频时用全分辨率检测到的人脸，否则用随机纹理上的随机人脸框），
+//           平均差异超过0.5像素时返回1
+// detectors: 在同一段录制数据上比较各人脸检测后端（HOG、DNN）的每帧检测耗时（平均和P95）、
+//           检出率，以及与HOG检测结果的一致率（首个人脸框IoU不低于0.5）
+// hog:      比较串行HOG检测和并行多尺度HOG检测的单帧延迟，并检查两者逐帧输出的人脸框完全相同，
+//           有不同时返回1
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <algorithm>
+#include "../include/frame_source.hpp"
+#include "../include/face_detection.hpp"
+#include "../include/behavior_analyzer.hpp"
+#include "../include/landmark_features.hpp"
+#include "../include/landmark_predictor.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 根据路径自动选择回放帧源（目录为图像序列，否则为视频文件）
+std::unique_ptr<FrameSource> openReplaySource(const std::string& path) {
+    FrameSourceConfig config;
+    config.type = fs::is_directory(path) ? FrameSourceType::IMAGE_SEQUENCE : FrameSourceType::VIDEO_FILE;
+    config.path = path;
+    config.as_fast_as_possible = true;
+    std::unique_ptr<FrameSource> source = FrameSource::create(config);
+    if (!source || !source->open()) {
+        return nullptr;
+    }
+    return source;
+}
+
+// 读取全部帧到内存，保证各组测试使用完全相同的输入且不计入解码耗时
+std::vector<cv::Mat> loadFrames(const std::string& path, size_t max_frames = 600) {
+    std::vector<cv::Mat> frames;
+    std::unique_ptr<FrameSource> source = openReplaySource(path);
+    if (!source) {
+        return frames;
+    }
+    cv::Mat frame;
+    while (frames.size() < max_frames && source->read(frame)) {
+        frames.push_back(frame.clone());
+    }
+    return frames;
+}
+
+// 特征点误差：平均点距离 / 两外眼角距离
+double normalizedLandmarkError(const dlib::full_object_detection& shape,
+                               const dlib::full_object_detection& reference) {
+    double dx = reference.part(36).x() - reference.part(45).x();
+    double dy = reference.part(36).y() - reference.part(45).y();
+    double interocular = std::sqrt(dx * dx + dy * dy);
+    if (interocular < 1.0 || shape.num_parts() != reference.num_parts()) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (unsigned long i = 0; i < shape.num_parts(); ++i) {
+        double ex = shape.part(i).x() - reference.part(i).x();
+        double ey = shape.part(i).y() - reference.part(i).y();
+        sum += std::sqrt(ex * ex + ey * ey);
+    }
+    return sum / shape.num_parts() / interocular;
+}
+
+int runScaleBenchmark(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "用法: dms_bench scale <模型文件> <视频文件或图像目录> [缩放比例...]" << std::endl;
+        return 1;
+    }
+
+    dlib::shape_predictor predictor;
+    try {
+        dlib::deserialize(argv[2]) >> predictor;
+    } catch (const std::exception& e) {
+        std::cerr << "无法加载面部特征点预测模型: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames = loadFrames(argv[3]);
+    if (frames.empty()) {
+        std::cerr << "无法读取测试数据: " << argv[3] << std::endl;
+        return 1;
+    }
+
+    std::vector<double> scales;
+    for (int i = 4; i < argc; ++i) {
+        scales.push_back(std::stod(argv[i]));
+    }
+    if (scales.empty()) {
+        scales = {1.0, 0.75, 0.5, 0.4, 0.33, 0.25};
+    }
+
+    // 基准：全分辨率检测和特征点定位
+    ScaledFaceDetector reference_detector(1.0);
+    std::vector<bool> reference_found(frames.size(), false);
+    std::vector<dlib::full_object_detection> reference_shapes(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        std::vector<dlib::rectangle> faces = reference_detector.detect(frames[i]);
+        if (!faces.empty()) {
+            reference_found[i] = true;
+            reference_shapes[i] = predictor(dlib::cv_image<dlib::bgr_pixel>(frames[i]), faces[0]);
+        }
+    }
+
+    std::cout << "测试帧数: " << frames.size() << std::endl;
+    std::cout << std::left
+              << std::setw(8) << "scale"
+              << std::setw(14) << "detect_ms"
+              << std::setw(14) << "total_ms"
+              << std::setw(12) << "fps"
+              << std::setw(12) << "recall"
+              << std::setw(12) << "nme(%)" << std::endl;
+
+    for (double scale : scales) {
+        ScaledFaceDetector detector(scale);
+        double detect_ms = 0.0;
+        double total_ms = 0.0;
+        size_t matched = 0;
+        size_t reference_total = 0;
+        double error_sum = 0.0;
+
+        for (size_t i = 0; i < frames.size(); ++i) {
+            auto start = Clock::now();
+            std::vector<dlib::rectangle> faces = detector.detect(frames[i]);
+            detect_ms += elapsedMs(start);
+
+            dlib::full_object_detection shape;
+            if (!faces.empty()) {
+                shape = predictor(dlib::cv_image<dlib::bgr_pixel>(frames[i]), faces[0]);
+            }
+            total_ms += elapsedMs(start);
+
+            if (reference_found[i]) {
+                reference_total++;
+                if (!faces.empty()) {
+                    matched++;
+                    error_sum += normalizedLandmarkError(shape, reference_shapes[i]);
+                }
+            }
+        }
+
+        double n = static_cast<double>(frames.size());
+        std::cout << std::left << std::fixed << std::setprecision(3)
+                  << std::setw(8) << detector.getScale()
+                  << std::setw(14) << detect_ms / n
+                  << std::setw(14) << total_ms / n
+                  << std::setw(12) << (total_ms > 0 ? n * 1000.0 / total_ms : 0.0)
+                  << std::setw(12) << (reference_total > 0 ? static_cast<double>(matched) / reference_total : 0.0)
+                  << std::setw(12) << (matched > 0 ? error_sum / matched * 100.0 : 0.0)
+                  << std::endl;
+    }
+    return 0;
+}
+
+// 生成随机抖动的68点特征点（在一张示意人脸的位置附近，坐标为整数像素）
+std::vector<dlib::full_object_detection> makeSyntheticShapes(size_t count) {
+    std::mt19937 rng(12345);
+    std::normal_distribution<double> jitter(0.0, 3.0);
+    std::uniform_real_distribution<double> roll(-0.4, 0.4);
+    std::uniform_real_distribution<double> size(60.0, 200.0);
+
+    // 示意人脸（单位尺寸，原点在人脸中心）：下颌、眉毛、鼻子、眼睛、嘴
+    std::vector<std::pair<double, double>> base(landmark_index::kNumLandmarks);
+    for (int i = 0; i <= 16; ++i) {
+        double t = M_PI * i / 16.0;
+        base[i] = {-std::cos(t), 0.2 + 0.8 * std::sin(t)};
+    }
+    for (int i = 17; i <= 26; ++i) {
+        base[i] = {-0.8 + 0.16 * (i - 17) + (i >= 22 ? 0.12 : 0.0), -0.5};
+    }
+    for (int i = 27; i <= 35; ++i) {
+        base[i] = i <= 30 ? std::make_pair(0.0, -0.3 + 0.12 * (i - 27)) : std::make_pair(-0.2 + 0.1 * (i - 31), 0.15);
+    }
+    const double eye[6][2] = {{-0.3, 0}, {-0.15, -0.08}, {0.0, -0.08}, {0.15, 0}, {0.0, 0.08}, {-0.15, 0.08}};
+    for (int i = 0; i < 6; ++i) {
+        base[36 + i] = {eye[i][0] - 0.35, eye[i][1] - 0.25};
+        base[42 + i] = {eye[i][0] + 0.35, eye[i][1] - 0.25};
+    }
+    for (int i = 48; i < 68; ++i) {
+        double t = 2.0 * M_PI * (i < 60 ? i - 48 : i - 60) / (i < 60 ? 12.0 : 8.0);
+        double r = i < 60 ? 1.0 : 0.7;
+        base[i] = {-0.4 * r * std::cos(t), 0.5 - 0.12 * r * std::sin(t)};
+    }
+
+    std::vector<dlib::full_object_detection> shapes;
+    shapes.reserve(count);
+    for (size_t n = 0; n < count; ++n) {
+        double s = size(rng);
+        double a = roll(rng);
+        double open = 0.3 + 1.5 * (n % 7) / 6.0;   // 眼睛和嘴的张开程度
+        std::vector<dlib::point> parts;
+        for (int i = 0; i < landmark_index::kNumLandmarks; ++i) {
+            double x = base[i].first;
+            double y = base[i].second;
+            if (i >= 36) {
+                double cy = i < 48 ? -0.25 : 0.5;
+                y = cy + (y - cy) * open;
+            }
+            double px = 320 + s * (x * std::cos(a) - y * std::sin(a)) + jitter(rng);
+            double py = 240 + s * (x * std::sin(a) + y * std::cos(a)) + jitter(rng);
+            parts.emplace_back(static_cast<long>(std::lround(px)), static_cast<long>(std::lround(py)));
+        }
+        shapes.emplace_back(dlib::rectangle(0, 0, 639, 479), parts);
+    }
+    return shapes;
+}
+
+// 原有的逐点计算方式：每帧构造两个std::vector，逐个距离用double的pow/sqrt
+LandmarkFeatures referenceFeatures(const dlib::full_object_detection& shape) {
+    std::vector<dlib::point> left_eye;
+    for (int i = 36; i <= 41; ++i) {
+        left_eye.push_back(shape.part(i));
+    }
+    std::vector<dlib::point> right_eye;
+    for (int i = 42; i <= 47; ++i) {
+        right_eye.push_back(shape.part(i));
+    }
+
+    LandmarkFeatures features;
+    features.ear_left = static_cast<float>(BehaviorAnalyzer::calculateEAR(left_eye));
+    features.ear_right = static_cast<float>(BehaviorAnalyzer::calculateEAR(right_eye));
+    features.ear = (features.ear_left + features.ear_right) / 2.0f;
+    features.mar = static_cast<float>(BehaviorAnalyzer::calculateMAR(shape));
+    dlib::point l = shape.part(36);
+    dlib::point r = shape.part(45);
+    features.head_roll = static_cast<float>(std::atan2(r.y() - l.y(), r.x() - l.x()) * 180.0 / M_PI);
+    return features;
+}
+
+int runFeatureBenchmark(int argc, char* argv[]) {
+    size_t count = argc > 2 ? static_cast<size_t>(std::max(1, std::stoi(argv[2]))) : 4096;
+    int rounds = argc > 3 ? std::max(1, std::stoi(argv[3])) : 200;
+    std::vector<dlib::full_object_detection> shapes = makeSyntheticShapes(count);
+
+    // 结果一致性
+    double max_ear = 0.0, max_mar = 0.0, max_roll = 0.0;
+    for (const auto& shape : shapes) {
+        LandmarkFeatures a = referenceFeatures(shape);
+        LandmarkFeatures b = LandmarkFeatureKernel::compute(shape);
+        max_ear = std::max(max_ear, static_cast<double>(std::abs(a.ear - b.ear)));
+        max_mar = std::max(max_mar, static_cast<double>(std::abs(a.mar - b.mar)));
+        max_roll = std::max(max_roll, static_cast<double>(std::abs(a.head_roll - b.head_roll)));
+    }
+
+    // 累加结果防止计算被优化掉
+    volatile float sink = 0.0f;
+    auto measure = [&](auto&& compute) {
+        float sum = 0.0f;
+        auto start = Clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (const auto& shape : shapes) {
+                LandmarkFeatures f = compute(shape);
+                sum += f.ear + f.mar + f.head_roll;
+            }
+        }
+        double ms = elapsedMs(start);
+        sink = sink + sum;
+        return ms * 1e6 / (static_cast<double>(rounds) * shapes.size());
+    };
+
+    double reference_ns = measure([](const dlib::full_object_detection& shape) {
+        return referenceFeatures(shape);
+    });
+    double kernel_ns = measure([](const dlib::full_object_detection& shape) {
+        return LandmarkFeatureKernel::compute(shape);
+    });
+
+    // 特征点已在结构数组中时只计算距离和特征
+    std::vector<LandmarkBuffer> buffers(shapes.size());
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        LandmarkFeatureKernel::load(shapes[i], buffers[i]);
+    }
+    float sum = 0.0f;
+    auto start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& buffer : buffers) {
+            LandmarkFeatures f = LandmarkFeatureKernel::compute(buffer);
+            sum += f.ear + f.mar + f.head_roll;
+        }
+    }
+    double compute_ns = elapsedMs(start) * 1e6 / (static_cast<double>(rounds) * buffers.size());
+    sink = sink + sum;
+
+    std::cout << "特征点组数: " << shapes.size() << " 轮数: " << rounds << std::endl;
+    std::cout << std::left << std::fixed << std::setprecision(1)
+              << std::setw(28) << "逐点计算(原实现)" << reference_ns << " ns/帧" << std::endl
+              << std::setw(28) << "特征内核(含复制)" << kernel_ns << " ns/帧"
+              << "  加速 " << std::setprecision(2) << (kernel_ns > 0 ? reference_ns / kernel_ns : 0.0) << "x" << std::endl
+              << std::setprecision(1)
+              << std::setw(28) << "特征内核(仅计算)" << compute_ns << " ns/帧" << std::endl;
+    std::cout << std::scientific << std::setprecision(2)
+              << "最大差异: ear " << max_ear << " mar " << max_mar << " roll " << max_roll << " 度" << std::endl;
+    return 0;
+}
+
+int runLandmarkBenchmark(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "用法: dms_bench landmarks <模型文件> [视频文件或图像目录]" << std::endl;
+        return 1;
+    }
+
+    dlib::shape_predictor reference;
+    try {
+        dlib::deserialize(argv[2]) >> reference;
+    } catch (const std::exception& e) {
+        std::cerr << "无法加载面部特征点预测模型: " << e.what() << std::endl;
+        return 1;
+    }
+    ShapeModelConfig config;
+    config.path = argv[2];
+    ShapeModelLoadInfo info;
+    std::shared_ptr<const FlatShapeModel> model = FlatShapeModel::load(config, info);
+    if (!model) {
+        return 1;
+    }
+    FlatShapePredictor flat(model);
+
+    // 测试集：每项为一帧图像和其中的一个人脸框
+    std::vector<cv::Mat> frames;
+    std::vector<std::pair<size_t, dlib::rectangle>> faces;
+    if (argc > 3) {
+        frames = loadFrames(argv[3]);
+        ScaledFaceDetector detector(1.0);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            std::vector<dlib::rectangle> found = detector.detect(frames[i]);
+            if (!found.empty()) {
+                faces.emplace_back(i, found[0]);
+            }
+        }
+    } else {
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> position(0, 320);
+        std::uniform_int_distribution<int> size(80, 220);
+        for (int i = 0; i < 200; ++i) {
+            cv::Mat image(480, 640, CV_8UC3);
+            cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+            cv::GaussianBlur(image, image, cv::Size(7, 7), 2.0);
+            frames.push_back(image);
+            long left = position(rng);
+            long top = position(rng) / 2;
+            long side = size(rng);
+            faces.emplace_back(frames.size() - 1, dlib::rectangle(left, top, left + side, top + side));
+        }
+    }
+    if (faces.empty()) {
+        std::cerr << "测试数据中没有检测到人脸" << std::endl;
+        return 1;
+    }
+
+    // 结果差异
+    std::vector<dlib::full_object_detection> reference_shapes(faces.size());
+    double max_diff = 0.0, diff_sum = 0.0;
+    size_t point_count = 0, exact = 0;
+    dlib::full_object_detection shape;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        const cv::Mat& image = frames[faces[i].first];
+        reference_shapes[i] = reference(dlib::cv_image<dlib::bgr_pixel>(image), faces[i].second);
+        flat.predict(image, faces[i].second, shape);
+        for (unsigned long k = 0; k < shape.num_parts(); ++k) {
+            double dx = static_cast<double>(shape.part(k).x() - reference_shapes[i].part(k).x());
+            double dy = static_cast<double>(shape.part(k).y() - reference_shapes[i].part(k).y());
+            double d = std::sqrt(dx * dx + dy * dy);
+            max_diff = std::max(max_diff, d);
+            diff_sum += d;
+            exact += d == 0.0 ? 1 : 0;
+            point_count++;
+        }
+    }
+
+    // 耗时（每个人脸框重复多轮，取每张人脸的平均值）
+    const int rounds = 5;
+    volatile long sink = 0;
+    auto start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& face : faces) {
+            dlib::full_object_detection result = reference(dlib::cv_image<dlib::bgr_pixel>(frames[face.first]), face.second);
+            sink = sink + result.part(0).x();
+        }
+    }
+    double dlib_us = elapsedMs(start) * 1000.0 / (static_cast<double>(rounds) * faces.size());
+    start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& face : faces) {
+            flat.predict(frames[face.first], face.second, shape);
+            sink = sink + shape.part(0).x();
+        }
+    }
+    double flat_us = elapsedMs(start) * 1000.0 / (static_cast<double>(rounds) * faces.size());
+
+    double mean_diff = point_count > 0 ? diff_sum / point_count : 0.0;
+    std::cout << "人脸数: " << faces.size() << " 特征点: " << model->numLandmarks()
+              << " 级联层数: " << model->numCascades() << " 每层回归树: " << model->treesPerCascade() << std::endl;
+    std::cout << std::left << std::fixed << std::setprecision(1)
+              << std::setw(28) << "dlib::shape_predictor" << dlib_us << " us/人脸" << std::endl
+              << std::setw(28) << "FlatShapePredictor" << flat_us << " us/人脸"
+              << "  加速 " << std::setprecision(2) << (flat_us > 0 ? dlib_us / flat_us : 0.0) << "x" << std::endl;
+    std::cout << std::setprecision(3)
+              << "特征点差异: 平均 " << mean_diff << " 像素  最大 " << max_diff << " 像素  完全一致 "
+              << (point_count > 0 ? 100.0 * exact / point_count : 0.0) << "%" << std::endl;
+    return mean_diff <= 0.5 ? 0 : 1;
+}
+
+int runDetectorBenchmark(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "用法: dms_bench detectors <视频文件或图像目录> [YuNet模型文件] [DNN线程数] [缩放比例]" << std::endl;
+        return 1;
+    }
+    std::vector<cv::Mat> frames = loadFrames(argv[2]);
+    if (frames.empty()) {
+        std::cerr << "无法读取测试数据: " << argv[2] << std::endl;
+        return 1;
+    }
+
+    FaceDetectorConfig dnn_config;
+    dnn_config.backend = FaceDetectorBackend::DNN;
+    if (argc > 3) {
+        dnn_config.dnn_model = argv[3];
+    }
+    if (argc > 4) {
+        dnn_config.dnn_threads = std::max(1, std::stoi(argv[4]));
+    }
+    double scale = argc > 5 ? std::stod(argv[5]) : 1.0;
+
+    std::vector<std::unique_ptr<FaceDetector>> detectors;
+    detectors.push_back(std::make_unique<ScaledFaceDetector>(scale));
+    auto dnn = std::make_unique<DnnFaceDetector>(dnn_config, scale);
+    if (dnn->isLoaded()) {
+        detectors.push_back(std::move(dnn));
+    } else {
+        std::cerr << "DNN后端不可用，只测试HOG" << std::endl;
+    }
+
+    std::cout << "测试帧数: " << frames.size() << " 缩放比例: " << scale << std::endl;
+    std::cout << std::left
+              << std::setw(48) << "backend"
+              << std::setw(12) << "mean_ms"
+              << std::setw(12) << "p95_ms"
+              << std::setw(12) << "found"
+              << std::setw(12) << "agree_hog" << std::endl;
+
+    std::vector<std::vector<dlib::rectangle>> hog_faces;
+    std::vector<dlib::rectangle> faces;
+    for (size_t d = 0; d < detectors.size(); ++d) {
+        FaceDetector& detector = *detectors[d];
+        detector.detect(frames[0], faces);    // 预热（DNN第一次推理需要分配和初始化）
+        std::vector<double> latencies;
+        size_t found = 0, agree = 0, hog_found = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            auto start = Clock::now();
+            detector.detect(frames[i], faces);
+            latencies.push_back(elapsedMs(start));
+            found += faces.empty() ? 0 : 1;
+            if (d == 0) {
+                hog_faces.push_back(faces);
+            } else if (!hog_faces[i].empty()) {
+                hog_found++;
+                if (!faces.empty()) {
+                    const dlib::rectangle& a = faces[0];
+                    const dlib::rectangle& b = hog_faces[i][0];
+                    double inter = a.intersect(b).area();
+                    double iou = inter / (static_cast<double>(a.area()) + b.area() - inter);
+                    agree += iou >= 0.5 ? 1 : 0;
+                }
+            }
+        }
+        double mean = 0.0;
+        for (double ms : latencies) {
+            mean += ms;
+        }
+        mean /= latencies.size();
+        std::sort(latencies.begin(), latencies.end());
+        double p95 = latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)];
+        std::cout << std::left << std::fixed << std::setprecision(3)
+                  << std::setw(48) << detector.describe()
+                  << std::setw(12) << mean
+                  << std::setw(12) << p95
+                  << std::setw(12) << static_cast<double>(found) / frames.size()
+                  << std::setw(12) << (d == 0 ? 1.0 : (hog_found > 0 ? static_cast<double>(agree) / hog_found : 0.0))
+                  << std::endl;
+    }
+    return 0;
+}
+
+int runHogBenchmark(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "用法: dms_bench hog <视频文件或图像目录> [线程数] [缩放比例]" << std::endl;
+        return 1;
+    }
+    std::vector<cv::Mat> frames = loadFrames(argv[2]);
+    if (frames.empty()) {
+        std::cerr << "无法读取测试数据: " << argv[2] << std::endl;
+        return 1;
+    }
+    int threads = argc > 3 ? std::stoi(argv[3]) : 0;
+    double scale = argc > 4 ? std::stod(argv[4]) : 1.0;
+
+    ScaledFaceDetector serial(scale);
+    ParallelHogDetector parallel(scale, threads);
+    std::vector<dlib::rectangle> expected;
+    std::vector<dlib::rectangle> faces;
+    parallel.detect(frames[0], faces);    // 预热（创建各层扫描器和缓冲）
+
+    double serial_ms = 0.0, parallel_ms = 0.0;
+    size_t mismatched = 0;
+    for (const cv::Mat& frame : frames) {
+        auto start = Clock::now();
+        serial.detect(frame, expected);
+        serial_ms += elapsedMs(start);
+
+        start = Clock::now();
+        parallel.detect(frame, faces);
+        parallel_ms += elapsedMs(start);
+
+        if (faces != expected) {
+            mismatched++;
+        }
+    }
+
+    double n = static_cast<double>(frames.size());
+    std::cout << "测试帧数: " << frames.size() << " 缩放比例: " << serial.getScale() << std::endl;
+    std::cout << std::left << std::fixed << std::setprecision(3)
+              << std::setw(36) << serial.describe() << serial_ms / n << " ms/帧" << std::endl
+              << std::setw(36) << parallel.describe() << parallel_ms / n << " ms/帧"
+              << "  加速 " << std::setprecision(2) << (parallel_ms > 0 ? serial_ms / parallel_ms : 0.0) << "x" << std::endl;
+    std::cout << "结果不同的帧数: " << mismatched << std::endl;
+    return mismatched == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: dms_bench <scale|features|landmarks|detectors|hog> ..." << std::endl;
+        return 1;
+    }
+
+    std::string command = argv[1];
+    if (command == "scale") {
+        return runScaleBenchmark(argc, argv);
+    }
+    if (command == "features") {
+        return runFeatureBenchmark(argc, argv);
+    }
+    if (command == "landmarks") {
+        return runLandmarkBenchmark(argc, argv);
+    }
+    if (command == "detectors") {
+        return runDetectorBenchmark(argc, argv);
+    }
+    if (command == "hog") {
+        return runHogBenchmark(argc, argv);
+    }
+
+    std::cerr << "未知的测试项: " << command << std::endl;
+    return 1;
+}
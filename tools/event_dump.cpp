@@ -0,0 +1,119 @@
+// 驾驶行为监测系统事件存储读取工具
+//
+// 用法:
+//   dms_event_dump [--dir 事件目录] [--since 时间] [--format text|json]
+//
+// 把分段二进制事件存储转换为文本或JSON（每行一个事件）输出到标准输出。
+// --since 接受本地时间 "YYYY-MM-DD HH:MM:SS" 或自1970年起的纳秒数，只输出不早于该时刻的事件；
+// 读取时利用段起始时间和稀疏索引跳过更早的记录，不会扫描全部历史
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <ctime>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include "../include/event_store.hpp"
+#include "../include/driver_monitor.hpp"
+
+namespace {
+
+// 与原文本日志相同的时间格式
+std::string formatTimestamp(int64_t timestamp_ns) {
+    std::time_t seconds = static_cast<std::time_t>(timestamp_ns / 1000000000LL);
+    int ms = static_cast<int>((timestamp_ns / 1000000LL) % 1000);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&seconds), "%Y-%m-%d %H:%M:%S")
+       << '.' << std::setfill('0') << std::setw(3) << ms;
+    return ss.str();
+}
+
+// 解析--since参数
+bool parseSince(const std::string& text, int64_t& since_ns) {
+    if (!text.empty() && text.find_first_not_of("0123456789") == std::string::npos) {
+        since_ns = std::stoll(text);
+        return true;
+    }
+
+    std::tm tm = {};
+    std::istringstream ss(text);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail()) {
+        return false;
+    }
+    tm.tm_isdst = -1;
+    std::time_t seconds = std::mktime(&tm);
+    if (seconds == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    since_ns = static_cast<int64_t>(seconds) * 1000000000LL;
+    return true;
+}
+
+void printUsage() {
+    std::cerr << "用法: dms_event_dump [--dir 事件目录] [--since 时间] [--format text|json]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string dir = "events";
+    std::string format = "text";
+    int64_t since_ns = std::numeric_limits<int64_t>::min();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--since" && i + 1 < argc) {
+            if (!parseSince(argv[++i], since_ns)) {
+                std::cerr << "无法解析时间: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (format != "text" && format != "json") {
+        printUsage();
+        return 1;
+    }
+
+    EventStoreReader reader(dir);
+    bool found = reader.readSince(since_ns, [&format](const BehaviorEvent& event) {
+        std::string timestamp = formatTimestamp(event.timestamp_ns);
+        std::string behavior = DriverMonitor::behaviorToString(event.behavior);
+        if (format == "json") {
+            nlohmann::json line = {
+                {"id", event.id},
+                {"timestamp", timestamp},
+                {"timestamp_ns", event.timestamp_ns},
+                {"behavior", behavior},
+                {"message", event.message},
+                {"image_path", event.image_path},
+                {"clip_path", event.clip_path}
+            };
+            // 截断的字符串可能不是完整的UTF-8，替换而不是抛异常
+            std::cout << line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << "\n";
+        } else {
+            std::cout << timestamp << " | " << behavior << " | " << event.message << " | " << event.image_path;
+            if (!event.clip_path.empty()) {
+                std::cout << " | " << event.clip_path;
+            }
+            std::cout << "\n";
+        }
+        return static_cast<bool>(std::cout);
+    });
+
+    if (!found) {
+        std::cerr << "事件目录中没有事件段文件: " << dir << std::endl;
+        return 1;
+    }
+    return 0;
+}
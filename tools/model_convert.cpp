@@ -0,0 +1,140 @@
+// 驾驶行为监测系统面部特征点模型转换工具
+//
+// 用法:
+//   dms_model_convert 模型文件 [缓存文件] [--verify]
+//
+// 把dlib的 .dat 模型一次性转换为展开的二进制缓存（默认为模型文件名加 .flat），之后启动时
+// 只读映射缓存，不再逐项解析。--verify 分别用dlib直接加载的模型和由缓存构建的模型在同一组
+// 随机图像和人脸框上定位特征点，输出两种加载方式的耗时和特征点的最大差异
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <dlib/opencv.h>
+#include "../include/shape_model.hpp"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "用法: dms_model_convert 模型文件 [缓存文件] [--verify]" << std::endl;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 比较dlib直接加载的模型和由缓存构建的模型
+bool verify(const std::string& dat_path, const std::string& flat_path) {
+    auto start = std::chrono::steady_clock::now();
+    dlib::shape_predictor reference;
+    try {
+        dlib::deserialize(dat_path) >> reference;
+    } catch (const std::exception& e) {
+        std::cerr << "无法加载面部特征点预测模型: " << e.what() << std::endl;
+        return false;
+    }
+    double dlib_ms = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::string error;
+    std::shared_ptr<const FlatShapeModel> model = FlatShapeModel::map(flat_path, error);
+    if (!model) {
+        std::cerr << "无法映射模型缓存: " << error << std::endl;
+        return false;
+    }
+    dlib::shape_predictor flat;
+    model->toPredictor(flat);
+    double flat_ms = millisecondsSince(start);
+
+    // 随机灰度纹理上的随机人脸框
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> position(0, 320);
+    std::uniform_int_distribution<int> size(80, 220);
+    cv::Mat image(480, 640, CV_8UC3);
+    double max_diff = 0.0;
+    const int trials = 200;
+    for (int i = 0; i < trials; ++i) {
+        cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+        cv::GaussianBlur(image, image, cv::Size(7, 7), 2.0);
+        dlib::cv_image<dlib::bgr_pixel> view(image);
+        long left = position(rng);
+        long top = position(rng) / 2;
+        long side = size(rng);
+        dlib::rectangle box(left, top, left + side, top + side);
+        dlib::full_object_detection a = reference(view, box);
+        dlib::full_object_detection b = flat(view, box);
+        for (unsigned long k = 0; k < a.num_parts(); ++k) {
+            double dx = static_cast<double>(a.part(k).x() - b.part(k).x());
+            double dy = static_cast<double>(a.part(k).y() - b.part(k).y());
+            max_diff = std::max(max_diff, std::sqrt(dx * dx + dy * dy));
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "dlib加载: " << dlib_ms << " ms  缓存加载: " << flat_ms << " ms" << std::endl;
+    std::cout << "特征点最大差异: " << max_diff << " 像素（" << trials << " 个人脸框）" << std::endl;
+    return max_diff <= 1.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string dat_path;
+    std::string flat_path;
+    bool check = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--verify") {
+            check = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            printUsage();
+            return 1;
+        } else if (dat_path.empty()) {
+            dat_path = arg;
+        } else if (flat_path.empty()) {
+            flat_path = arg;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (dat_path.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (flat_path.empty()) {
+        ShapeModelConfig config;
+        config.path = dat_path;
+        flat_path = config.cachePath();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!FlatShapeModel::convert(dat_path, flat_path, error)) {
+        std::cerr << "转换失败: " << error << std::endl;
+        return 1;
+    }
+    std::shared_ptr<const FlatShapeModel> model = FlatShapeModel::map(flat_path, error);
+    if (!model) {
+        std::cerr << "转换结果无效: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "已写出 " << flat_path << "（" << model->mappedBytes() / 1024 << " KB，用时 "
+              << std::fixed << std::setprecision(1) << millisecondsSince(start) << " ms）" << std::endl;
+    std::cout << "特征点: " << model->numLandmarks()
+              << " 级联层数: " << model->numCascades()
+              << " 每层回归树: " << model->treesPerCascade()
+              << " 树深度: " << model->treeDepth()
+              << " 每层采样像素: " << model->pixelsPerCascade() << std::endl;
+
+    if (check && !verify(dat_path, flat_path)) {
+        std::cerr << "缓存构建的模型与dlib模型结果不一致" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+// 驾驶行为监测系统离线阈值扫描工具
+//
+// 用法:
+//   dms_threshold_sweep <特征文件或目录...> [选项]
+//
+// 选项:
+//   --labels <文件>        标注文件，每行 "开始,结束,行为"（时间为毫秒数或 "YYYY-MM-DD HH:MM:SS"，
+//                          行为为 eyes_closed / yawning）。不指定时以记录时系统判定的行为作为对照
+//   --ear <起,止,步长>      EAR阈值范围（默认 0.15,0.35,0.0025）
+//   --eye-frames <起,止>    连续闭眼帧数范围（默认 1,30）
+//   --mar <起,止,步长>      MAR阈值范围（默认 0.3,1.0,0.005）
+//   --yawn-frames <起,止>   连续哈欠帧数范围（默认 1,30）
+//   --threads <N>          线程数（默认使用全部核心）
+//   --top <N>              每种行为输出F1最高的N组（默认10）
+//   --csv <文件>           把全部组合的结果写入CSV
+//
+// 在特征记录器保存的每帧EAR/MAR上重放闭眼和哈欠的连续帧计数逻辑，不需要重新跑视觉流水线
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <cmath>
+#include "../include/feature_recorder.hpp"
+#include "../include/threshold_sweep.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 标注的行为区间
+struct LabelRange {
+    int64_t begin_ms = 0;
+    int64_t end_ms = 0;
+    DriverBehavior behavior = DriverBehavior::NORMAL;
+};
+
+// 解析时间：毫秒数或本地时间 "YYYY-MM-DD HH:MM:SS"
+bool parseTime(const std::string& text, int64_t& ms) {
+    if (!text.empty() && text.find_first_not_of("0123456789") == std::string::npos) {
+        ms = std::stoll(text);
+        return true;
+    }
+    std::tm tm = {};
+    std::istringstream ss(text);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail()) {
+        return false;
+    }
+    tm.tm_isdst = -1;
+    ms = static_cast<int64_t>(std::mktime(&tm)) * 1000;
+    return true;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    size_t end = s.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? std::string() : s.substr(begin, end - begin + 1);
+}
+
+bool loadLabels(const std::string& path, std::vector<LabelRange>& labels) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "无法打开标注文件: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(trim(field));
+        }
+
+        LabelRange label;
+        if (fields.size() != 3 || !parseTime(fields[0], label.begin_ms) || !parseTime(fields[1], label.end_ms)) {
+            std::cerr << "标注文件第 " << line_no << " 行格式错误: " << line << std::endl;
+            return false;
+        }
+        if (fields[2] == "eyes_closed") {
+            label.behavior = DriverBehavior::EYES_CLOSED;
+        } else if (fields[2] == "yawning") {
+            label.behavior = DriverBehavior::YAWNING;
+        } else {
+            continue;   // 其他行为不参与扫描
+        }
+        labels.push_back(label);
+    }
+    return true;
+}
+
+// 解析 "起,止[,步长]"
+bool parseRange(const std::string& text, double& from, double& to, double& step) {
+    char sep1 = 0, sep2 = 0;
+    std::istringstream ss(text);
+    ss >> from >> sep1 >> to;
+    if (ss.fail() || sep1 != ',') {
+        return false;
+    }
+    step = 1.0;
+    if (ss >> sep2) {
+        if (sep2 != ',' || !(ss >> step)) {
+            return false;
+        }
+    }
+    return from <= to && step > 0;
+}
+
+// 收集特征文件（目录中的所有 .dfc 文件）
+std::vector<std::string> collectFiles(const std::vector<std::string>& inputs) {
+    std::vector<std::string> files;
+    for (const auto& input : inputs) {
+        if (fs::is_directory(input)) {
+            std::vector<std::string> found;
+            for (const auto& entry : fs::directory_iterator(input)) {
+                if (entry.path().extension() == ".dfc") {
+                    found.push_back(entry.path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(input);
+        }
+    }
+    return files;
+}
+
+// 把一个特征文件转换为某种行为的扫描序列
+SweepSeries makeSeries(const FeatureColumns& columns, DriverBehavior behavior,
+                       const std::vector<LabelRange>& labels, bool use_labels) {
+    SweepSeries series;
+    series.value = behavior == DriverBehavior::EYES_CLOSED ? columns.ear : columns.mar;
+    series.has_face = columns.has_face;
+    series.label.resize(columns.size(), 0);
+    if (!use_labels) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            series.label[i] = columns.behavior[i] == static_cast<uint8_t>(behavior);
+        }
+        return series;
+    }
+
+    // 帧时间递增，每个标注区间二分查找对应的帧范围
+    const std::vector<int64_t>& times = columns.timestamp_ms;
+    for (const auto& label : labels) {
+        if (label.behavior != behavior) {
+            continue;
+        }
+        auto begin = std::lower_bound(times.begin(), times.end(), label.begin_ms);
+        auto end = std::upper_bound(begin, times.end(), label.end_ms);
+        std::fill(series.label.begin() + (begin - times.begin()), series.label.begin() + (end - times.begin()), 1);
+    }
+    return series;
+}
+
+void printTop(const std::string& title, const std::string& threshold_name,
+              std::vector<SweepResult> results, size_t top) {
+    std::sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        if (a.f1() != b.f1()) {
+            return a.f1() > b.f1();
+        }
+        return a.alerts < b.alerts;
+    });
+
+    std::cout << title << " (F1最高的 " << std::min(top, results.size()) << " 组)" << std::endl;
+    std::cout << std::left
+              << std::setw(10) << threshold_name
+              << std::setw(8) << "frames"
+              << std::setw(10) << "alerts"
+              << std::setw(12) << "precision"
+              << std::setw(10) << "recall"
+              << std::setw(10) << "f1"
+              << std::setw(12) << "event_recall" << std::endl;
+    for (size_t i = 0; i < results.size() && i < top; ++i) {
+        const SweepResult& r = results[i];
+        std::cout << std::left << std::fixed
+                  << std::setw(10) << std::setprecision(4) << r.threshold
+                  << std::setw(8) << r.frames
+                  << std::setw(10) << r.alerts
+                  << std::setw(12) << std::setprecision(3) << r.precision()
+                  << std::setw(10) << r.recall()
+                  << std::setw(10) << r.f1()
+                  << std::setw(12) << r.eventRecall() << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void writeCsv(std::ofstream& out, const std::string& behavior, const std::vector<SweepResult>& results) {
+    for (const auto& r : results) {
+        out << behavior << "," << r.threshold << "," << r.frames << "," << r.alerts << ","
+            << r.flagged_frames << "," << r.true_positive << "," << r.false_positive << ","
+            << r.false_negative << "," << r.precision() << "," << r.recall() << "," << r.f1() << ","
+            << r.labelled_events << "," << r.detected_events << "\n";
+    }
+}
+
+void printUsage() {
+    std::cerr << "用法: dms_threshold_sweep <特征文件或目录...> [--labels 文件] [--ear 起,止,步长] "
+                 "[--eye-frames 起,止] [--mar 起,止,步长] [--yawn-frames 起,止] [--threads N] "
+                 "[--top N] [--csv 文件]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string labels_path;
+    std::string csv_path;
+    double ear_from = 0.15, ear_to = 0.35, ear_step = 0.0025;
+    double eye_from = 1, eye_to = 30, eye_step = 1;
+    double mar_from = 0.3, mar_to = 1.0, mar_step = 0.005;
+    double yawn_from = 1, yawn_to = 30, yawn_step = 1;
+    int threads = 0;
+    size_t top = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        bool ok = true;
+        if (arg == "--labels" && has_value) {
+            labels_path = argv[++i];
+        } else if (arg == "--csv" && has_value) {
+            csv_path = argv[++i];
+        } else if (arg == "--ear" && has_value) {
+            ok = parseRange(argv[++i], ear_from, ear_to, ear_step);
+        } else if (arg == "--eye-frames" && has_value) {
+            ok = parseRange(argv[++i], eye_from, eye_to, eye_step);
+        } else if (arg == "--mar" && has_value) {
+            ok = parseRange(argv[++i], mar_from, mar_to, mar_step);
+        } else if (arg == "--yawn-frames" && has_value) {
+            ok = parseRange(argv[++i], yawn_from, yawn_to, yawn_step);
+        } else if (arg == "--threads" && has_value) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--top" && has_value) {
+            top = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+        } else if (arg.rfind("--", 0) == 0) {
+            ok = false;
+        } else {
+            inputs.push_back(arg);
+        }
+        if (!ok) {
+            printUsage();
+            return 1;
+        }
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<LabelRange> labels;
+    bool use_labels = !labels_path.empty();
+    if (use_labels && !loadLabels(labels_path, labels)) {
+        return 1;
+    }
+
+    // 读取特征文件，每个文件是一段独立的序列
+    std::vector<SweepSeries> eye_series;
+    std::vector<SweepSeries> yawn_series;
+    size_t total_frames = 0;
+    for (const auto& file : collectFiles(inputs)) {
+        FeatureColumns columns;
+        if (!FeatureLogReader::read(file, columns) || columns.size() == 0) {
+            continue;
+        }
+        total_frames += columns.size();
+        eye_series.push_back(makeSeries(columns, DriverBehavior::EYES_CLOSED, labels, use_labels));
+        yawn_series.push_back(makeSeries(columns, DriverBehavior::YAWNING, labels, use_labels));
+    }
+    if (total_frames == 0) {
+        std::cerr << "没有可用的特征数据" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> ear_values = ThresholdSweep::range(ear_from, ear_to, ear_step);
+    std::vector<double> mar_values = ThresholdSweep::range(mar_from, mar_to, mar_step);
+    std::vector<int> eye_frames;
+    for (double v : ThresholdSweep::range(eye_from, eye_to, eye_step)) {
+        eye_frames.push_back(static_cast<int>(std::lround(v)));
+    }
+    std::vector<int> yawn_frames;
+    for (double v : ThresholdSweep::range(yawn_from, yawn_to, yawn_step)) {
+        yawn_frames.push_back(static_cast<int>(std::lround(v)));
+    }
+
+    WorkStealingPool pool(threads);
+    std::cout << "特征文件: " << eye_series.size() << " 个，帧数: " << total_frames
+              << "，对照: " << (use_labels ? "标注文件" : "记录时的判定结果")
+              << "，线程数: " << pool.size() << std::endl;
+
+    auto start = Clock::now();
+    std::vector<SweepResult> eye_results =
+        ThresholdSweep::run(SweepDetector::EYES_CLOSED, eye_series, ear_values, eye_frames, pool);
+    std::vector<SweepResult> yawn_results =
+        ThresholdSweep::run(SweepDetector::YAWNING, yawn_series, mar_values, yawn_frames, pool);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    size_t combinations = eye_results.size() + yawn_results.size();
+    std::cout << "评估组合数: " << combinations << "，用时: " << std::fixed << std::setprecision(3)
+              << seconds << " 秒";
+    if (seconds > 0) {
+        std::cout << "（" << std::setprecision(1) << combinations * static_cast<double>(total_frames) / seconds / 1e6
+                  << " 百万组合帧/秒）";
+    }
+    std::cout << std::endl << std::endl;
+
+    printTop("闭眼", "ear", eye_results, top);
+    printTop("打哈欠", "mar", yawn_results, top);
+
+    if (!csv_path.empty()) {
+        std::ofstream out(csv_path);
+        if (!out.is_open()) {
+            std::cerr << "无法写入结果文件: " << csv_path << std::endl;
+            return 1;
+        }
+        out << "behavior,threshold,frames,alerts,flagged_frames,true_positive,false_positive,"
+               "false_negative,precision,recall,f1,labelled_events,detected_events\n";
+        writeCsv(out, "eyes_closed", eye_results);
+        writeCsv(out, "yawning", yawn_results);
+        std::cout << "全部结果已写入: " << csv_path << std::endl;
+    }
+    return 0;
+}